@@ -15,6 +15,16 @@
 #include "SpotLight.h"
 #include "SpotLightTracker.h"
 #include "Texture.h"
+#include "ModelCache.h"
+#include "MeshRegistry.h"
+#include "JobSystem.h"
+#include "MeshUploadQueue.h"
+#include "TextureCache.h"
+#include "TextureUploadQueue.h"
+#include "ShaderVariantCache.h"
+#include <algorithm>
+#include <cmath>
+#include <thread>
 
 Application* Application::s_instance = nullptr;
 
@@ -22,7 +32,12 @@ Application::Application(int width, int height, const char* title)
     : windowManager(std::make_unique<WindowManager>(width, height, title, this)),
     inputManager(nullptr),
     isRunning(true),
-    lastFrameTime(0.0)
+    lastFrameTime(0.0),
+    fixedDeltaTime(1.0f / 60.0f),
+    accumulator(0.0),
+    maxStepsPerFrame(5),
+    simulationTime(0.0),
+    simulatedFrames(0)
 {
     s_instance = this;
 }
@@ -36,21 +51,33 @@ void Application::setupScenes()
 {
     std::cout << "Setting up scenes..." << std::endl;
 
-    float aspectRatio = (float)windowManager->getWidth() / (float)windowManager->getHeight();
-
-    Scene* scene1 = sceneFactory.createScene(1, aspectRatio);
-    sceneManager.addScene(1, scene1);
+    // Builders reach these from job threads later on; getInstance() is not
+    // safe to race, so they are all created here first.
+    JobSystem::getInstance();
+    ModelCache::getInstance();
+    MeshRegistry::getInstance();
+    MeshUploadQueue::getInstance();
+    TextureCache::getInstance();
+    TextureUploadQueue::getInstance();
+    ShaderVariantCache::getInstance();
 
-    Scene* scene2 = sceneFactory.createScene(2, aspectRatio);
-    sceneManager.addScene(2, scene2);
+    // Scenes touch GL while they are built and destroyed, so both go
+    // through the renderer; until it starts, that runs inline.
+    sceneManager.setTaskRunner([this](std::function<void()> task) { renderer->enqueue(std::move(task)); });
 
-    Scene* scene3 = sceneFactory.createScene(3, aspectRatio);
-    sceneManager.addScene(3, scene3);
-
-    Scene* scene4 = sceneFactory.createScene(4, aspectRatio);
-    sceneManager.addScene(4, scene4);
+    for (int sceneID = 1; sceneID <= 5; sceneID++) {
+        sceneManager.registerScene(sceneID, [this, sceneID] {
+            float aspectRatio = (float)windowManager->getWidth() / (float)windowManager->getHeight();
+            return sceneFactory.createScene(sceneID, aspectRatio);
+        });
+    }
 
+    // Only the first scene is built before the first frame.
     sceneManager.switchScene(4);
+
+    ModelCache::getInstance().printStats();
+    MeshRegistry::getInstance().printStats();
+    TextureCache::getInstance().printStats();
 }
 
 bool Application::initialize()
@@ -60,45 +87,203 @@ bool Application::initialize()
         return false;
     }
 
+    renderer = std::make_unique<Renderer>(windowManager->getWindow());
+    renderer->setViewport(windowManager->getWidth(), windowManager->getHeight());
+
     inputManager = std::make_unique<InputManager>(windowManager->getWindow(), this);
     inputManager->initialize();
 
     setupScenes();
 
+    // Scenes are built with the context on this thread; from here on the
+    // render thread owns it.
+    renderer->start();
+    sceneManager.setInvoker([this](const std::function<void()>& task) { renderer->invoke(task); });
+    sceneManager.setAutoPrefetch(true);
+
     return true;
 }
 
+void Application::setTickRate(float ticksPerSecond)
+{
+    if (ticksPerSecond <= 0.0f)
+    {
+        std::cerr << "Application::setTickRate() - tick rate must be positive" << std::endl;
+        return;
+    }
+
+    fixedDeltaTime = 1.0f / ticksPerSecond;
+}
+
 void Application::run()
 {
     std::cout << "Application::run() started" << std::endl;
 
+    // Long frames (loading, dragging the window) are clamped so they cannot
+    // queue up a burst of simulation steps.
+    const double maxFrameTime = 0.25;
+
+    lastFrameTime = glfwGetTime();
+    accumulator = 0.0;
+    Scene* simulatedScene = nullptr;
+
     while (isRunning && !windowManager->shouldClose())
     {
         double currentTime = glfwGetTime();
-        float deltaTime = static_cast<float>(currentTime - lastFrameTime);
+        double frameTime = std::min(currentTime - lastFrameTime, maxFrameTime);
         lastFrameTime = currentTime;
 
-        inputManager->processInput(deltaTime);
+        // Camera movement follows the display rate.
+        inputManager->processInput(static_cast<float>(frameTime));
 
         Scene* currentScene = sceneManager.getCurrentScene();
-        if (currentScene) {
-            currentScene->update(deltaTime);
+        if (currentScene != simulatedScene) {
+            if (currentScene) {
+                currentScene->resetInterpolation();
+            }
+            simulatedScene = currentScene;
         }
 
-        inputManager->processInput(deltaTime);
+        double simulationStart = glfwGetTime();
+        accumulator += frameTime;
+        int steps = 0;
+        while (accumulator >= fixedDeltaTime && steps < maxStepsPerFrame)
+        {
+            if (currentScene) {
+                currentScene->update(fixedDeltaTime);
+            }
+            accumulator -= fixedDeltaTime;
+            steps++;
+        }
 
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+        if (steps == maxStepsPerFrame)
+        {
+            accumulator = std::fmod(accumulator, static_cast<double>(fixedDeltaTime));
+        }
 
+        simulationTime += glfwGetTime() - simulationStart;
+
+        // While the render thread draws the previous frame, this one is
+        // built into the other snapshot.
+        FrameSnapshot& frame = renderer->beginFrame();
+
+        simulationStart = glfwGetTime();
         if (currentScene) {
-            currentScene->render();
+            currentScene->setInterpolation(static_cast<float>(accumulator / fixedDeltaTime));
+            currentScene->buildFrame(frame);
         }
+        simulationTime += glfwGetTime() - simulationStart;
+        simulatedFrames++;
+        renderer->submitFrame();
+        sceneManager.update();
 
-        windowManager->swapBuffers();
         glfwPollEvents();
     }
 }
 
+void Application::runUpdateBenchmark()
+{
+    const size_t objectCount = 10000;
+    const int warmupFrames = 10;
+    const int frames = 200;
+    const float deltaTime = 1.0f / 60.0f;
+
+    float aspectRatio = (float)windowManager->getWidth() / (float)windowManager->getHeight();
+    std::unique_ptr<Scene> scene;
+    renderer->invoke([&] { scene.reset(sceneFactory.createStressScene(objectCount, aspectRatio)); });
+
+    JobSystem& jobs = JobSystem::getInstance();
+    size_t originalThreads = jobs.getThreadCount();
+    size_t maxThreads = std::max(1u, std::thread::hardware_concurrency());
+    double baseline = 0.0;
+
+    std::cout << "\nUpdate benchmark: " << scene->getObjectCount() << " objects, "
+        << scene->getDynamicObjectCount() << " dynamic" << std::endl;
+
+    for (size_t threads = 1; threads <= maxThreads; threads++) {
+        jobs.setThreadCount(threads);
+
+        for (int i = 0; i < warmupFrames; i++) {
+            scene->update(deltaTime);
+        }
+
+        double start = glfwGetTime();
+        for (int i = 0; i < frames; i++) {
+            scene->update(deltaTime);
+        }
+        double ms = (glfwGetTime() - start) * 1000.0 / frames;
+
+        if (threads == 1) {
+            baseline = ms;
+        }
+        std::cout << "  " << threads << " threads: " << ms << " ms/update, "
+            << baseline / ms << "x" << std::endl;
+    }
+
+    jobs.setThreadCount(originalThreads);
+
+    renderer->invoke([&] { scene.reset(); });
+}
+
+void Application::setThreadedRendering(bool enabled)
+{
+    if (enabled) {
+        renderer->start();
+        sceneManager.setInvoker([this](const std::function<void()>& task) { renderer->invoke(task); });
+    }
+    else {
+        // Builds waiting on the render thread finish before it stops.
+        sceneManager.setInvoker(nullptr);
+        renderer->stop();
+    }
+
+    // Prefetching only pays off when builds do not block this thread.
+    sceneManager.setAutoPrefetch(enabled);
+}
+
+void Application::printFrameStats()
+{
+    RenderStats stats = renderer->getStats();
+    if (simulatedFrames == 0 || stats.frames == 0) {
+        return;
+    }
+
+    std::cout << "Frames: " << stats.frames << (renderer->isThreaded() ? " (render thread)" : " (inline)")
+        << ", simulation " << simulationTime * 1000.0 / simulatedFrames << " ms"
+        << ", render " << stats.renderTime * 1000.0 / stats.frames << " ms"
+        << ", waiting for render " << stats.waitTime * 1000.0 / simulatedFrames << " ms per frame" << std::endl;
+
+    size_t pendingUploads = MeshUploadQueue::getInstance().getPendingCount();
+    if (pendingUploads > 0) {
+        std::cout << "Models still streaming in: " << pendingUploads << std::endl;
+    }
+    size_t pendingTextures = TextureUploadQueue::getInstance().getPendingCount();
+    if (pendingTextures > 0) {
+        std::cout << "Textures still streaming in: " << pendingTextures << std::endl;
+    }
+    size_t pendingVariants = ShaderVariantCache::getInstance().getPendingCount();
+    if (pendingVariants > 0) {
+        std::cout << "Shader variants still compiling: " << pendingVariants << std::endl;
+    }
+
+    simulationTime = 0.0;
+    simulatedFrames = 0;
+}
+
 void Application::shutdown()
 {
+    // GL objects owned by scenes and the renderer must go before the context.
+    if (renderer) {
+        sceneManager.setInvoker(nullptr);
+        renderer->stop();
+    }
+    sceneManager.clear();
+    MeshUploadQueue::destroy();
+    TextureUploadQueue::destroy();
+    ShaderVariantCache::destroy();
+    TextureCache::destroy();
+    renderer.reset();
+    inputManager.reset();
     windowManager.reset();
+    JobSystem::destroy();
 }
\ No newline at end of file
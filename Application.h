@@ -10,6 +10,7 @@
 #include "WindowManager.h"
 #include "InputManager.h"
 #include "SceneFactory.h"
+#include "Renderer.h"
 
 class Application
 {
@@ -19,6 +20,18 @@ private:
     bool isRunning;
     double lastFrameTime;
 
+    // The simulation advances in fixed steps; rendering interpolates between
+    // the last two steps. At most maxStepsPerFrame steps run per frame, so a
+    // slow frame drops simulation time instead of spiralling.
+    float fixedDeltaTime;
+    double accumulator;
+    int maxStepsPerFrame;
+
+    // Time the simulation thread spends per frame on update and buildFrame,
+    // accumulated until the next printFrameStats().
+    double simulationTime;
+    size_t simulatedFrames;
+
     void setupScenes();
 
     void createScene1();
@@ -31,6 +44,7 @@ private:
     static Application* s_instance;
     std::unique_ptr<WindowManager> windowManager;
     std::unique_ptr<InputManager> inputManager;
+    std::unique_ptr<Renderer> renderer;
     SceneFactory sceneFactory;
 
 public:
@@ -41,8 +55,20 @@ public:
     void run();
     void shutdown();
 
+    // Times Scene::update on a stress scene for 1..N worker threads.
+    void runUpdateBenchmark();
+
+    void setTickRate(float ticksPerSecond);
+    float getTickRate() const { return 1.0f / fixedDeltaTime; }
+    void setMaxStepsPerFrame(int steps) { maxStepsPerFrame = steps > 0 ? steps : 1; }
+
+    // Switches between the render thread and drawing inline.
+    void setThreadedRendering(bool enabled);
+    void printFrameStats();
+
     GLFWwindow* getWindow() const { return windowManager->getWindow(); }
     SceneManager& getSceneManager() { return sceneManager; }
+    Renderer& getRenderer() { return *renderer; }
     bool isOpen() const { return !windowManager->shouldClose(); }
 
     int getWindowWidth() const { return windowManager->getWidth(); }
@@ -0,0 +1,80 @@
+#pragma once
+#include <glm/vec3.hpp>
+#include <glm/mat4x4.hpp>
+#include <glm/common.hpp>
+
+struct BoundingBox
+{
+    glm::vec3 min;
+    glm::vec3 max;
+
+    BoundingBox() : min(0.0f), max(0.0f) {}
+    BoundingBox(const glm::vec3& minCorner, const glm::vec3& maxCorner) : min(minCorner), max(maxCorner) {}
+
+    glm::vec3 getCenter() const { return (min + max) * 0.5f; }
+    glm::vec3 getExtents() const { return (max - min) * 0.5f; }
+
+    float getSurfaceArea() const
+    {
+        glm::vec3 size = max - min;
+        return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+    }
+
+    bool contains(const BoundingBox& other) const
+    {
+        return min.x <= other.min.x && min.y <= other.min.y && min.z <= other.min.z &&
+            other.max.x <= max.x && other.max.y <= max.y && other.max.z <= max.z;
+    }
+
+    bool overlaps(const BoundingBox& other) const
+    {
+        return min.x <= other.max.x && other.min.x <= max.x &&
+            min.y <= other.max.y && other.min.y <= max.y &&
+            min.z <= other.max.z && other.min.z <= max.z;
+    }
+
+    // Slab test; inverseDirection is 1 / ray direction. On a hit, distance
+    // holds the entry distance clamped to the ray origin.
+    bool intersectRay(const glm::vec3& origin, const glm::vec3& inverseDirection, float maxDistance, float& distance) const
+    {
+        glm::vec3 t1 = (min - origin) * inverseDirection;
+        glm::vec3 t2 = (max - origin) * inverseDirection;
+
+        glm::vec3 tNear = glm::min(t1, t2);
+        glm::vec3 tFar = glm::max(t1, t2);
+
+        float enter = glm::max(glm::max(tNear.x, tNear.y), glm::max(tNear.z, 0.0f));
+        float exit = glm::min(glm::min(tFar.x, tFar.y), glm::min(tFar.z, maxDistance));
+
+        distance = enter;
+        return enter <= exit;
+    }
+
+    static BoundingBox merge(const BoundingBox& a, const BoundingBox& b)
+    {
+        return BoundingBox(glm::min(a.min, b.min), glm::max(a.max, b.max));
+    }
+
+    // Smallest axis-aligned box enclosing this box after transformation.
+    BoundingBox transformed(const glm::mat4& matrix) const
+    {
+        glm::vec3 center = glm::vec3(matrix * glm::vec4(getCenter(), 1.0f));
+        glm::vec3 extents = getExtents();
+
+        glm::vec3 worldExtents(0.0f);
+        for (int axis = 0; axis < 3; axis++)
+        {
+            worldExtents += glm::abs(glm::vec3(matrix[axis])) * extents[axis];
+        }
+
+        return BoundingBox(center - worldExtents, center + worldExtents);
+    }
+};
+
+struct BoundingSphere
+{
+    glm::vec3 center;
+    float radius;
+
+    BoundingSphere() : center(0.0f), radius(0.0f) {}
+};
@@ -1,5 +1,9 @@
 #include "DrawableObject.h"
+#include "GLInvoker.h"
 #include "ModelCache.h"
+#include "TransformStore.h"
+#include <algorithm>
+#include <glm/matrix.hpp>
 
 DrawableObject::DrawableObject(bool isDynamic)
     : transform(isDynamic),
@@ -8,82 +12,228 @@ DrawableObject::DrawableObject(bool isDynamic)
     shininess(32.0f),
     texture(nullptr),
     objectID(0),
-    parent(nullptr)
+    parent(nullptr),
+    worldMatrix(1.0f),
+    normalMatrix(1.0f),
+    worldDirty(true),
+    normalDirty(true),
+    transformVersion(0),
+    parentVersion(0),
+    worldVersion(0),
+    previousWorldMatrix(1.0f),
+    transformStore(nullptr),
+    transformSlot(-1)
 {
 }
 
 DrawableObject::~DrawableObject()
 {
+    setParent(nullptr);
+
+    for (DrawableObject* child : children)
+    {
+        child->parent = nullptr;
+        child->markDirty();
+    }
 }
 
 void DrawableObject::update(float deltaTime)
 {
+    // The store integrates bound transforms in batches.
+    if (transformStore != nullptr)
+    {
+        return;
+    }
+
     transform.update(deltaTime);
+
+    if (transform.getVersion() != transformVersion)
+    {
+        markDirty();
+    }
+}
+
+void DrawableObject::markDirty()
+{
+    transformVersion = transform.getVersion();
+    worldVersion++;
+    worldDirty = true;
+    normalDirty = true;
+
+    // Children are told even when they are dirty already: their versions
+    // have to move with every change, or one that was read in between
+    // would look current.
+    for (DrawableObject* child : children)
+    {
+        child->markDirty();
+    }
 }
 
-void DrawableObject::draw()
+void DrawableObject::bindTransformSlot(TransformStore* store, int slot)
 {
-    if (!model.isModelLoaded()) {
-        std::cerr << "DrawableObject::draw() - Model not loaded!" << std::endl;
+    // Compaction moves slots within the same store without changing matrices.
+    if (store != nullptr && store == transformStore)
+    {
+        transformSlot = slot;
         return;
     }
 
-    if (shader == nullptr) {
-        std::cerr << "DrawableObject::draw() - No shader assigned!" << std::endl;
+    // Keep the version moving forward past anything reported while bound.
+    if (transformStore != nullptr)
+    {
+        worldVersion += transformStore->getSlotVersion(transformSlot);
+    }
+
+    transformStore = store;
+    transformSlot = slot;
+
+    // Force propagation so children re-read this object's matrix.
+    worldDirty = false;
+    normalDirty = false;
+    markDirty();
+}
+
+unsigned int DrawableObject::getCachedWorldVersion() const
+{
+    if (transformStore != nullptr)
+    {
+        return worldVersion + transformStore->getSlotVersion(transformSlot);
+    }
+    return worldVersion;
+}
+
+unsigned int DrawableObject::getWorldVersion() const
+{
+    // Picks up parent changes that have not been pulled into the cache yet.
+    if (transformStore == nullptr && parent != nullptr)
+    {
+        getModelMatrix();
+    }
+    return getCachedWorldVersion();
+}
+
+void DrawableObject::setParent(DrawableObject* p)
+{
+    if (parent == p)
+    {
         return;
     }
 
-    model.draw();
+    if (parent != nullptr)
+    {
+        auto& siblings = parent->children;
+        siblings.erase(std::remove(siblings.begin(), siblings.end(), this), siblings.end());
+    }
+
+    parent = p;
+
+    if (parent != nullptr)
+    {
+        parent->children.push_back(this);
+    }
+
+    if (transformStore != nullptr)
+    {
+        transformStore->invalidateOrder();
+    }
+
+    markDirty();
 }
 
 bool DrawableObject::loadModel(const std::string& filePath, const std::string& arrayName)
 {
-    std::shared_ptr<ModelData> modelData = ModelCache::getInstance().loadModel(filePath, arrayName);
+    std::shared_ptr<ModelData> data = ModelCache::getInstance().loadModel(filePath, arrayName);
 
-    if (!modelData || modelData->vertices.empty()) {
+    if (!data || data->vertexCount == 0) {
         std::cerr << "Failed to load model from cache: " << filePath << " (" << arrayName << ")" << std::endl;
         return false;
     }
 
-    model.loadWithStride(modelData->vertices.data(), modelData->vertices.size(), modelData->stride, shader);
+    GLInvoker::run([&] { model.setMesh(MeshRegistry::getInstance().acquire(*data)); });
+    modelData = data;
 
     return true;
 }
 
 bool DrawableObject::loadModelFromText(const std::string& filePath)
 {
-    std::shared_ptr<ModelData> modelData = ModelCache::getInstance().loadModelFromText(filePath);
+    std::shared_ptr<ModelData> data = ModelCache::getInstance().loadModelFromText(filePath);
 
-    if (!modelData || modelData->vertices.empty()) {
+    if (!data || data->vertexCount == 0) {
         std::cerr << "Failed to load model from text: " << filePath << std::endl;
         return false;
     }
 
-    model.loadWithStride(modelData->vertices.data(), modelData->vertices.size(), modelData->stride, shader);
+    GLInvoker::run([&] { model.setMesh(MeshRegistry::getInstance().acquire(*data)); });
+    modelData = data;
     return true;
 }
 
 bool DrawableObject::loadModelFromOBJ(const std::string& filePath)
 {
-    std::shared_ptr<ModelData> modelData = ModelCache::getInstance().loadModelFromOBJ(filePath);
+    std::shared_ptr<ModelData> data = ModelCache::getInstance().loadModelFromOBJ(filePath);
 
-    if (!modelData || modelData->vertices.empty()) {
+    if (!data || data->vertexCount == 0) {
         std::cerr << "Failed to load model from OBJ: " << filePath << std::endl;
         return false;
     }
 
-    model.loadWithStride(modelData->vertices.data(), modelData->vertices.size(), modelData->stride, shader);
+    GLInvoker::run([&] { model.setMesh(MeshRegistry::getInstance().acquire(*data)); });
+    modelData = data;
     return true;
 }
 
+MeshRequestHandle DrawableObject::loadModelAsync(const std::string& filePath, const std::string& arrayName)
+{
+    pendingModel = MeshUploadQueue::getInstance().request(ModelCache::getInstance().loadModelAsync(filePath, arrayName));
+    return pendingModel;
+}
+
+MeshRequestHandle DrawableObject::loadModelFromTextAsync(const std::string& filePath)
+{
+    pendingModel = MeshUploadQueue::getInstance().request(ModelCache::getInstance().loadModelFromTextAsync(filePath));
+    return pendingModel;
+}
+
+MeshRequestHandle DrawableObject::loadModelFromOBJAsync(const std::string& filePath)
+{
+    pendingModel = MeshUploadQueue::getInstance().request(ModelCache::getInstance().loadModelFromOBJAsync(filePath));
+    return pendingModel;
+}
+
+bool DrawableObject::updatePendingModel()
+{
+    if (!pendingModel) {
+        return false;
+    }
+
+    switch (pendingModel->getState()) {
+    case MeshRequest::RESIDENT:
+        model.setMesh(pendingModel->getMesh());
+        modelData = pendingModel->getModelData();
+        pendingModel.reset();
+        return true;
+
+    case MeshRequest::FAILED:
+        std::cerr << "Asynchronous model load failed for object " << objectID << std::endl;
+        pendingModel.reset();
+        return false;
+
+    default:
+        return false;
+    }
+}
+
 void DrawableObject::addStaticTransform(ITransformComponent* component)
 {
     transform.addStatic(component);
+    markDirty();
 }
 
 void DrawableObject::addDynamicTransform(ITransformComponent* component)
 {
     transform.addDynamic(component);
+    markDirty();
 }
 
 void DrawableObject::setShader(ShaderProgram* shaderProgram)
@@ -91,14 +241,74 @@ void DrawableObject::setShader(ShaderProgram* shaderProgram)
     shader = shaderProgram;
 }
 
-glm::mat4 DrawableObject::getModelMatrix() const
+ShaderProgram* DrawableObject::selectShader(ShaderVariantKey variant) const
+{
+    // A streamed texture is drawn with the untextured variant until it is in.
+    variant.textured = texture != nullptr && texture->isTextureLoaded();
+    return shader->getVariant(variant);
+}
+
+const glm::mat4& DrawableObject::getModelMatrix() const
+{
+    if (transformStore != nullptr)
+    {
+        return transformStore->getWorldMatrix(transformSlot);
+    }
+
+    // Catches changes made through getTransformation() outside update().
+    if (transform.getVersion() != transformVersion)
+    {
+        const_cast<DrawableObject*>(this)->markDirty();
+    }
+
+    if (parent == nullptr)
+    {
+        if (worldDirty)
+        {
+            worldMatrix = transform.getMatrix();
+            worldDirty = false;
+        }
+        return worldMatrix;
+    }
+
+    // The parent is evaluated once per level, after which its version can be
+    // read directly. A parent evaluated by a TransformStore never marks its
+    // children dirty, so the version is what tells.
+    const glm::mat4& parentMatrix = parent->getModelMatrix();
+    unsigned int version = parent->getCachedWorldVersion();
+    if (version != parentVersion)
+    {
+        // Children compare against this object's version in turn, so they
+        // need not be walked here.
+        const_cast<DrawableObject*>(this)->worldVersion++;
+        worldDirty = true;
+        normalDirty = true;
+        parentVersion = version;
+    }
+
+    if (worldDirty)
+    {
+        worldMatrix = parentMatrix * transform.getMatrix();
+        worldDirty = false;
+    }
+
+    return worldMatrix;
+}
+
+const glm::mat3& DrawableObject::getNormalMatrix() const
 {
-    glm::mat4 localMatrix = transform.getMatrix();
+    if (transformStore != nullptr)
+    {
+        return transformStore->getNormalMatrix(transformSlot);
+    }
 
-    if (parent != nullptr) {
-        glm::mat4 parentMatrix = parent->getModelMatrix();
-        return parentMatrix * localMatrix;
+    const glm::mat4& world = getModelMatrix();
+
+    if (normalDirty)
+    {
+        normalMatrix = glm::transpose(glm::inverse(glm::mat3(world)));
+        normalDirty = false;
     }
 
-    return localMatrix;
-}
\ No newline at end of file
+    return normalMatrix;
+}
@@ -4,12 +4,23 @@
 #include "ShaderProgram.h"
 #include "ModelLoader.h"
 #include "Texture.h"
+#include "MeshUploadQueue.h"
 #include <glm/vec3.hpp>
+#include <glm/mat3x3.hpp>
+#include <glm/mat4x4.hpp>
+#include <memory>
+#include <vector>
+
+struct ModelData;
+class TransformStore;
 
 class DrawableObject
 {
 protected:
     Model model;
+    std::shared_ptr<ModelData> modelData;
+    // Set while an asynchronous load is in flight.
+    MeshRequestHandle pendingModel;
     Transformation transform;
     ModelLoader modelLoader;
     ShaderProgram* shader;
@@ -19,23 +30,62 @@ protected:
     Texture* texture;
 
     DrawableObject* parent;
+    std::vector<DrawableObject*> children;
+
+    // World and normal matrices are cached and recomputed lazily. Marking an
+    // object dirty also dirties its children, since their world matrices
+    // include this one.
+    mutable glm::mat4 worldMatrix;
+    mutable glm::mat3 normalMatrix;
+    mutable bool worldDirty;
+    mutable bool normalDirty;
+    mutable unsigned int transformVersion;
+    mutable unsigned int parentVersion;
+    unsigned int worldVersion;
+
+    // World matrix before the last simulation step, for render interpolation.
+    glm::mat4 previousWorldMatrix;
+
+    // Set while a TransformStore evaluates this object's world matrix.
+    TransformStore* transformStore;
+    int transformSlot;
+
+    void markDirty();
+    // Version of the matrix as last evaluated, without evaluating it.
+    unsigned int getCachedWorldVersion() const;
 
 public:
     DrawableObject(bool isDynamic = false);
     virtual ~DrawableObject();
 
+    // Called from worker threads for objects outside a hierarchy; overrides
+    // must only modify the object itself.
     virtual void update(float deltaTime);
-    virtual void draw();
 
     bool loadModel(const std::string& filePath, const std::string& arrayName);
     bool loadModelFromText(const std::string& filePath);
     bool loadModelFromOBJ(const std::string& filePath);
 
+    // Parse on worker threads and upload on the GL thread over the next
+    // frames. Call before adding the object to a scene; the scene draws it
+    // once the mesh is resident.
+    MeshRequestHandle loadModelAsync(const std::string& filePath, const std::string& arrayName);
+    MeshRequestHandle loadModelFromTextAsync(const std::string& filePath);
+    MeshRequestHandle loadModelFromOBJAsync(const std::string& filePath);
+
+    bool isModelPending() const { return pendingModel != nullptr; }
+    // Adopts the mesh of a finished asynchronous load. Returns true when the
+    // model changed.
+    bool updatePendingModel();
+
     void addStaticTransform(ITransformComponent* component);
     void addDynamicTransform(ITransformComponent* component);
 
     void setShader(ShaderProgram* shaderProgram);
     ShaderProgram* getShader() const { return shader; }
+    // Variant of the shader for the object's material; the scene fills in
+    // the lighting part of the key. Simulation thread only.
+    ShaderProgram* selectShader(ShaderVariantKey variant) const;
 
     void setObjectColor(const glm::vec3& color) { objectColor = color; }
     glm::vec3 getObjectColor() const { return objectColor; }
@@ -48,8 +98,20 @@ public:
 
     Model& getModel() { return model; }
     const Model& getModel() const { return model; }
+    const ModelData* getModelData() const { return modelData.get(); }
+
+    const glm::mat4& getModelMatrix() const;
+    const glm::mat3& getNormalMatrix() const;
+
+    void savePreviousModelMatrix() { previousWorldMatrix = getModelMatrix(); }
+    const glm::mat4& getPreviousModelMatrix() const { return previousWorldMatrix; }
 
-    glm::mat4 getModelMatrix() const;
+    // Changes whenever the world matrix changes, including through a parent.
+    unsigned int getWorldVersion() const;
+
+    void bindTransformSlot(TransformStore* store, int slot);
+    TransformStore* getTransformStore() const { return transformStore; }
+    int getTransformSlot() const { return transformSlot; }
 
     void setTexture(Texture* tex) { texture = tex; }
     Texture* getTexture() const { return texture; }
@@ -57,7 +119,11 @@ public:
     void setID(int id) { objectID = id; }
     int getID() const { return objectID; }
 
-    void setParent(DrawableObject* p) { parent = p; }
+    void setParent(DrawableObject* p);
     DrawableObject* getParent() const { return parent; }
+    const std::vector<DrawableObject*>& getChildren() const { return children; }
     bool hasParent() const { return parent != nullptr; }
+
+    // True when the world matrix can change after the object is added to a scene.
+    bool isMovable() const { return transform.isDynamic() || (parent != nullptr && parent->isMovable()); }
 };
\ No newline at end of file
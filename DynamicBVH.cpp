@@ -0,0 +1,567 @@
+#include "DynamicBVH.h"
+#include <glm/common.hpp>
+#include <glm/geometric.hpp>
+#include <algorithm>
+
+namespace
+{
+    // One per thread, so const queries may run concurrently and still reuse
+    // their storage.
+    std::vector<int>& getTraversalStack()
+    {
+        thread_local std::vector<int> stack;
+        return stack;
+    }
+}
+
+DynamicBVH::DynamicBVH(float margin)
+    : root(NULL_NODE), freeList(NULL_NODE), proxyCount(0), margin(margin)
+{
+}
+
+DynamicBVH::~DynamicBVH()
+{
+}
+
+int DynamicBVH::allocateNode()
+{
+    int nodeID;
+    if (freeList != NULL_NODE)
+    {
+        nodeID = freeList;
+        freeList = nodes[nodeID].parent;
+    }
+    else
+    {
+        nodeID = static_cast<int>(nodes.size());
+        nodes.push_back(Node());
+    }
+
+    Node& node = nodes[nodeID];
+    node.box = BoundingBox();
+    node.object = nullptr;
+    node.parent = NULL_NODE;
+    node.child1 = NULL_NODE;
+    node.child2 = NULL_NODE;
+    node.height = 0;
+    return nodeID;
+}
+
+void DynamicBVH::freeNode(int nodeID)
+{
+    nodes[nodeID].parent = freeList;
+    nodes[nodeID].object = nullptr;
+    nodes[nodeID].height = -1;
+    freeList = nodeID;
+}
+
+int DynamicBVH::createProxy(const BoundingBox& box, DrawableObject* object)
+{
+    int proxyID = allocateNode();
+
+    glm::vec3 fat(margin);
+    nodes[proxyID].box = BoundingBox(box.min - fat, box.max + fat);
+    nodes[proxyID].object = object;
+
+    insertLeaf(proxyID);
+    proxyCount++;
+
+    return proxyID;
+}
+
+void DynamicBVH::destroyProxy(int proxyID)
+{
+    if (proxyID < 0 || proxyID >= static_cast<int>(nodes.size()) || !nodes[proxyID].isLeaf())
+    {
+        return;
+    }
+
+    removeLeaf(proxyID);
+    freeNode(proxyID);
+    proxyCount--;
+}
+
+bool DynamicBVH::moveProxy(int proxyID, const BoundingBox& box)
+{
+    if (nodes[proxyID].box.contains(box))
+    {
+        return false;
+    }
+
+    removeLeaf(proxyID);
+
+    glm::vec3 fat(margin);
+    nodes[proxyID].box = BoundingBox(box.min - fat, box.max + fat);
+
+    insertLeaf(proxyID);
+    return true;
+}
+
+void DynamicBVH::clear()
+{
+    nodes.clear();
+    root = NULL_NODE;
+    freeList = NULL_NODE;
+    proxyCount = 0;
+}
+
+void DynamicBVH::insertLeaf(int leaf)
+{
+    if (root == NULL_NODE)
+    {
+        root = leaf;
+        nodes[root].parent = NULL_NODE;
+        return;
+    }
+
+    // Walk down towards the sibling that increases total surface area least.
+    BoundingBox leafBox = nodes[leaf].box;
+    int index = root;
+    while (!nodes[index].isLeaf())
+    {
+        int child1 = nodes[index].child1;
+        int child2 = nodes[index].child2;
+
+        float area = nodes[index].box.getSurfaceArea();
+        float combinedArea = BoundingBox::merge(nodes[index].box, leafBox).getSurfaceArea();
+
+        float cost = 2.0f * combinedArea;
+        float inheritanceCost = 2.0f * (combinedArea - area);
+
+        float cost1 = BoundingBox::merge(leafBox, nodes[child1].box).getSurfaceArea() + inheritanceCost;
+        if (!nodes[child1].isLeaf())
+        {
+            cost1 -= nodes[child1].box.getSurfaceArea();
+        }
+
+        float cost2 = BoundingBox::merge(leafBox, nodes[child2].box).getSurfaceArea() + inheritanceCost;
+        if (!nodes[child2].isLeaf())
+        {
+            cost2 -= nodes[child2].box.getSurfaceArea();
+        }
+
+        if (cost < cost1 && cost < cost2)
+        {
+            break;
+        }
+
+        index = cost1 < cost2 ? child1 : child2;
+    }
+
+    int sibling = index;
+    int oldParent = nodes[sibling].parent;
+    int newParent = allocateNode();
+
+    nodes[newParent].parent = oldParent;
+    nodes[newParent].box = BoundingBox::merge(leafBox, nodes[sibling].box);
+    nodes[newParent].height = nodes[sibling].height + 1;
+    nodes[newParent].child1 = sibling;
+    nodes[newParent].child2 = leaf;
+    nodes[sibling].parent = newParent;
+    nodes[leaf].parent = newParent;
+
+    if (oldParent != NULL_NODE)
+    {
+        if (nodes[oldParent].child1 == sibling)
+            nodes[oldParent].child1 = newParent;
+        else
+            nodes[oldParent].child2 = newParent;
+    }
+    else
+    {
+        root = newParent;
+    }
+
+    refitAncestors(nodes[leaf].parent);
+}
+
+void DynamicBVH::removeLeaf(int leaf)
+{
+    if (leaf == root)
+    {
+        root = NULL_NODE;
+        return;
+    }
+
+    int parent = nodes[leaf].parent;
+    int grandParent = nodes[parent].parent;
+    int sibling = nodes[parent].child1 == leaf ? nodes[parent].child2 : nodes[parent].child1;
+
+    if (grandParent != NULL_NODE)
+    {
+        if (nodes[grandParent].child1 == parent)
+            nodes[grandParent].child1 = sibling;
+        else
+            nodes[grandParent].child2 = sibling;
+
+        nodes[sibling].parent = grandParent;
+        freeNode(parent);
+        refitAncestors(grandParent);
+    }
+    else
+    {
+        root = sibling;
+        nodes[sibling].parent = NULL_NODE;
+        freeNode(parent);
+    }
+
+    nodes[leaf].parent = NULL_NODE;
+}
+
+void DynamicBVH::refitAncestors(int nodeID)
+{
+    int index = nodeID;
+    while (index != NULL_NODE)
+    {
+        index = balance(index);
+
+        Node& node = nodes[index];
+        const Node& child1 = nodes[node.child1];
+        const Node& child2 = nodes[node.child2];
+
+        node.height = 1 + std::max(child1.height, child2.height);
+        node.box = BoundingBox::merge(child1.box, child2.box);
+
+        index = node.parent;
+    }
+}
+
+// Rotates the taller grandchild up when the subtree at iA is unbalanced.
+// Returns the new subtree root.
+int DynamicBVH::balance(int iA)
+{
+    Node& A = nodes[iA];
+    if (A.isLeaf() || A.height < 2)
+    {
+        return iA;
+    }
+
+    int iB = A.child1;
+    int iC = A.child2;
+    Node& B = nodes[iB];
+    Node& C = nodes[iC];
+
+    int heightDifference = C.height - B.height;
+
+    if (heightDifference > 1)
+    {
+        int iF = C.child1;
+        int iG = C.child2;
+        Node& F = nodes[iF];
+        Node& G = nodes[iG];
+
+        C.child1 = iA;
+        C.parent = A.parent;
+        A.parent = iC;
+
+        if (C.parent != NULL_NODE)
+        {
+            if (nodes[C.parent].child1 == iA)
+                nodes[C.parent].child1 = iC;
+            else
+                nodes[C.parent].child2 = iC;
+        }
+        else
+        {
+            root = iC;
+        }
+
+        if (F.height > G.height)
+        {
+            C.child2 = iF;
+            A.child2 = iG;
+            G.parent = iA;
+            A.box = BoundingBox::merge(B.box, G.box);
+            C.box = BoundingBox::merge(A.box, F.box);
+            A.height = 1 + std::max(B.height, G.height);
+            C.height = 1 + std::max(A.height, F.height);
+        }
+        else
+        {
+            C.child2 = iG;
+            A.child2 = iF;
+            F.parent = iA;
+            A.box = BoundingBox::merge(B.box, F.box);
+            C.box = BoundingBox::merge(A.box, G.box);
+            A.height = 1 + std::max(B.height, F.height);
+            C.height = 1 + std::max(A.height, G.height);
+        }
+
+        return iC;
+    }
+
+    if (heightDifference < -1)
+    {
+        int iD = B.child1;
+        int iE = B.child2;
+        Node& D = nodes[iD];
+        Node& E = nodes[iE];
+
+        B.child1 = iA;
+        B.parent = A.parent;
+        A.parent = iB;
+
+        if (B.parent != NULL_NODE)
+        {
+            if (nodes[B.parent].child1 == iA)
+                nodes[B.parent].child1 = iB;
+            else
+                nodes[B.parent].child2 = iB;
+        }
+        else
+        {
+            root = iB;
+        }
+
+        if (D.height > E.height)
+        {
+            B.child2 = iD;
+            A.child1 = iE;
+            E.parent = iA;
+            A.box = BoundingBox::merge(C.box, E.box);
+            B.box = BoundingBox::merge(A.box, D.box);
+            A.height = 1 + std::max(C.height, E.height);
+            B.height = 1 + std::max(A.height, D.height);
+        }
+        else
+        {
+            B.child2 = iE;
+            A.child1 = iD;
+            D.parent = iA;
+            A.box = BoundingBox::merge(C.box, D.box);
+            B.box = BoundingBox::merge(A.box, E.box);
+            A.height = 1 + std::max(C.height, D.height);
+            B.height = 1 + std::max(A.height, E.height);
+        }
+
+        return iB;
+    }
+
+    return iA;
+}
+
+int DynamicBVH::getHeight() const
+{
+    return root == NULL_NODE ? 0 : nodes[root].height;
+}
+
+void DynamicBVH::collectLeaves(int nodeID, std::vector<DrawableObject*>& results) const
+{
+    const Node& node = nodes[nodeID];
+    if (node.isLeaf())
+    {
+        results.push_back(node.object);
+        return;
+    }
+
+    collectLeaves(node.child1, results);
+    collectLeaves(node.child2, results);
+}
+
+size_t DynamicBVH::queryFrustum(const Frustum& frustum, std::vector<DrawableObject*>& results) const
+{
+    size_t visited = 0;
+    if (root == NULL_NODE)
+    {
+        return visited;
+    }
+
+    std::vector<int>& stack = getTraversalStack();
+    stack.clear();
+    stack.push_back(root);
+
+    while (!stack.empty())
+    {
+        int index = stack.back();
+        stack.pop_back();
+        visited++;
+
+        const Node& node = nodes[index];
+        Frustum::Containment containment = frustum.classifyBox(node.box);
+
+        if (containment == Frustum::OUTSIDE)
+        {
+            continue;
+        }
+
+        if (containment == Frustum::INSIDE || node.isLeaf())
+        {
+            collectLeaves(index, results);
+            continue;
+        }
+
+        stack.push_back(node.child1);
+        stack.push_back(node.child2);
+    }
+
+    return visited;
+}
+
+size_t DynamicBVH::queryBox(const BoundingBox& box, std::vector<DrawableObject*>& results) const
+{
+    size_t visited = 0;
+    if (root == NULL_NODE)
+    {
+        return visited;
+    }
+
+    std::vector<int>& stack = getTraversalStack();
+    stack.clear();
+    stack.push_back(root);
+
+    while (!stack.empty())
+    {
+        int index = stack.back();
+        stack.pop_back();
+        visited++;
+
+        const Node& node = nodes[index];
+        if (!node.box.overlaps(box))
+        {
+            continue;
+        }
+
+        if (node.isLeaf())
+        {
+            results.push_back(node.object);
+        }
+        else
+        {
+            stack.push_back(node.child1);
+            stack.push_back(node.child2);
+        }
+    }
+
+    return visited;
+}
+
+size_t DynamicBVH::querySphere(const glm::vec3& center, float radius, std::vector<DrawableObject*>& results) const
+{
+    size_t visited = 0;
+    if (root == NULL_NODE)
+    {
+        return visited;
+    }
+
+    const float radiusSquared = radius * radius;
+
+    std::vector<int>& stack = getTraversalStack();
+    stack.clear();
+    stack.push_back(root);
+
+    while (!stack.empty())
+    {
+        int index = stack.back();
+        stack.pop_back();
+        visited++;
+
+        const Node& node = nodes[index];
+        glm::vec3 offset = glm::clamp(center, node.box.min, node.box.max) - center;
+        if (glm::dot(offset, offset) > radiusSquared)
+        {
+            continue;
+        }
+
+        if (node.isLeaf())
+        {
+            results.push_back(node.object);
+        }
+        else
+        {
+            stack.push_back(node.child1);
+            stack.push_back(node.child2);
+        }
+    }
+
+    return visited;
+}
+
+size_t DynamicBVH::queryRay(const glm::vec3& origin, const glm::vec3& direction, float maxDistance,
+    std::vector<DrawableObject*>& results) const
+{
+    size_t visited = 0;
+    if (root == NULL_NODE)
+    {
+        return visited;
+    }
+
+    const glm::vec3 inverseDirection = 1.0f / direction;
+
+    std::vector<int>& stack = getTraversalStack();
+    stack.clear();
+    stack.push_back(root);
+
+    while (!stack.empty())
+    {
+        int index = stack.back();
+        stack.pop_back();
+        visited++;
+
+        const Node& node = nodes[index];
+        float tMin;
+        if (!node.box.intersectRay(origin, inverseDirection, maxDistance, tMin))
+        {
+            continue;
+        }
+
+        if (node.isLeaf())
+        {
+            results.push_back(node.object);
+        }
+        else
+        {
+            stack.push_back(node.child1);
+            stack.push_back(node.child2);
+        }
+    }
+
+    return visited;
+}
+
+DrawableObject* DynamicBVH::raycast(const glm::vec3& origin, const glm::vec3& direction, float maxDistance,
+    float* hitDistance) const
+{
+    if (root == NULL_NODE)
+    {
+        return nullptr;
+    }
+
+    const glm::vec3 inverseDirection = 1.0f / direction;
+    DrawableObject* closest = nullptr;
+    float closestDistance = maxDistance;
+
+    std::vector<int>& stack = getTraversalStack();
+    stack.clear();
+    stack.push_back(root);
+
+    while (!stack.empty())
+    {
+        int index = stack.back();
+        stack.pop_back();
+
+        const Node& node = nodes[index];
+        float tMin;
+        if (!node.box.intersectRay(origin, inverseDirection, closestDistance, tMin))
+        {
+            continue;
+        }
+
+        if (node.isLeaf())
+        {
+            closest = node.object;
+            closestDistance = tMin;
+        }
+        else
+        {
+            stack.push_back(node.child1);
+            stack.push_back(node.child2);
+        }
+    }
+
+    if (closest != nullptr && hitDistance != nullptr)
+    {
+        *hitDistance = closestDistance;
+    }
+
+    return closest;
+}
@@ -0,0 +1,76 @@
+#pragma once
+#include <vector>
+#include <glm/vec3.hpp>
+#include "BoundingVolume.h"
+#include "Frustum.h"
+
+class DrawableObject;
+
+// Incrementally updated bounding volume hierarchy over world-space object
+// bounds. Leaves store a slightly enlarged ("fat") box so that small moves
+// do not touch the tree; a leaf is only reinserted once its object leaves
+// the fat box. Inserts pick the sibling with the lowest surface area cost
+// and the tree is kept balanced with AVL-style rotations.
+class DynamicBVH
+{
+public:
+    static const int NULL_NODE = -1;
+
+    DynamicBVH(float margin = 0.2f);
+    ~DynamicBVH();
+
+    int createProxy(const BoundingBox& box, DrawableObject* object);
+    void destroyProxy(int proxyID);
+
+    // Returns true if the leaf had to be reinserted.
+    bool moveProxy(int proxyID, const BoundingBox& box);
+
+    DrawableObject* getObject(int proxyID) const { return nodes[proxyID].object; }
+    const BoundingBox& getFatBox(int proxyID) const { return nodes[proxyID].box; }
+
+    void clear();
+
+    // Queries append matching objects to results and return the number of
+    // nodes visited.
+    size_t queryFrustum(const Frustum& frustum, std::vector<DrawableObject*>& results) const;
+    size_t queryBox(const BoundingBox& box, std::vector<DrawableObject*>& results) const;
+    size_t querySphere(const glm::vec3& center, float radius, std::vector<DrawableObject*>& results) const;
+    size_t queryRay(const glm::vec3& origin, const glm::vec3& direction, float maxDistance,
+        std::vector<DrawableObject*>& results) const;
+
+    // Closest leaf box hit along the ray, or nullptr.
+    DrawableObject* raycast(const glm::vec3& origin, const glm::vec3& direction, float maxDistance,
+        float* hitDistance = nullptr) const;
+
+    int getHeight() const;
+    size_t getProxyCount() const { return proxyCount; }
+
+private:
+    struct Node
+    {
+        BoundingBox box;
+        DrawableObject* object;
+        int parent;
+        int child1;
+        int child2;
+        int height;
+
+        bool isLeaf() const { return child1 == NULL_NODE; }
+    };
+
+    std::vector<Node> nodes;
+    int root;
+    int freeList;
+    size_t proxyCount;
+    float margin;
+
+    int allocateNode();
+    void freeNode(int nodeID);
+
+    void insertLeaf(int leaf);
+    void removeLeaf(int leaf);
+    int balance(int nodeID);
+    void refitAncestors(int nodeID);
+
+    void collectLeaves(int nodeID, std::vector<DrawableObject*>& results) const;
+};
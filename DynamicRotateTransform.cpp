@@ -1,9 +1,10 @@
 #include "DynamicRotateTransform.h"
+#include "TransformStore.h"
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/common.hpp>
 
 DynamicRotateTransform::DynamicRotateTransform(const glm::vec3& rotAxis, float speed)
-    : axis(glm::normalize(rotAxis)), currentAngle(0.0f), rotationSpeed(speed)
+    : axis(glm::normalize(rotAxis)), currentAngle(0.0f), rotationSpeed(speed), store(nullptr), record(-1)
 {
 }
 
@@ -13,17 +14,57 @@ DynamicRotateTransform::~DynamicRotateTransform()
 
 glm::mat4 DynamicRotateTransform::getMatrix() const
 {
+    if (store != nullptr)
+    {
+        return store->getRecordMatrix(record);
+    }
+
     return glm::rotate(glm::mat4(1.0f), glm::radians(currentAngle), axis);
 }
 
 void DynamicRotateTransform::update(float deltaTime)
 {
+    if (store != nullptr)
+    {
+        return;
+    }
+
     currentAngle += rotationSpeed * deltaTime;
     if (currentAngle >= 360.0f)
         currentAngle -= 360.0f;
 }
 
+bool DynamicRotateTransform::toRecord(TransformRecord& out) const
+{
+    out.axis = axis;
+    out.angle = currentAngle;
+    out.angularSpeed = rotationSpeed;
+    return true;
+}
+
+void DynamicRotateTransform::bindRecord(TransformStore* newStore, int newRecord)
+{
+    if (store != nullptr && newStore == nullptr)
+    {
+        currentAngle = store->getAngle(record);
+        rotationSpeed = store->getAngularSpeed(record);
+    }
+
+    store = newStore;
+    record = newRecord;
+}
+
 void DynamicRotateTransform::setRotationSpeed(float speed)
 {
     rotationSpeed = speed;
+
+    if (store != nullptr)
+    {
+        store->setAngularSpeed(record, speed);
+    }
+}
+
+float DynamicRotateTransform::getCurrentAngle() const
+{
+    return store != nullptr ? store->getAngle(record) : currentAngle;
 }
\ No newline at end of file
@@ -9,11 +9,16 @@ private:
     float currentAngle;
     float rotationSpeed;
 
+    TransformStore* store;
+    int record;
+
 public:
     DynamicRotateTransform(const glm::vec3& rotAxis, float speed);
     ~DynamicRotateTransform();
     glm::mat4 getMatrix() const override;
     void update(float deltaTime) override;
+    bool toRecord(TransformRecord& record) const override;
+    void bindRecord(TransformStore* store, int record) override;
     void setRotationSpeed(float speed);
-    float getCurrentAngle() const { return currentAngle; }
+    float getCurrentAngle() const;
 };
\ No newline at end of file
@@ -32,4 +32,14 @@ void DynamicTransformComponent::update(float deltaTime)
     {
         component->update(deltaTime);
     }
+}
+
+unsigned int DynamicTransformComponent::getVersion() const
+{
+    unsigned int version = 0;
+    for (const auto& component : components)
+    {
+        version += component->getVersion();
+    }
+    return version;
 }
\ No newline at end of file
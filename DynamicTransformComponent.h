@@ -14,4 +14,7 @@ public:
     void add(ITransformComponent* component);
     glm::mat4 getMatrix() const override;
     void update(float deltaTime) override;
+    unsigned int getVersion() const override;
+
+    const std::vector<std::unique_ptr<ITransformComponent>>& getComponents() const { return components; }
 };
\ No newline at end of file
@@ -1,9 +1,12 @@
 #include "DynamicTranslateTransform.h"
+#include "TransformStore.h"
 #include <glm/gtc/matrix_transform.hpp>
 
 DynamicTranslateTransform::DynamicTranslateTransform(const glm::vec3& pos, const glm::vec3& vel)
     : position(pos)
     , velocity(vel)
+    , store(nullptr)
+    , record(-1)
 {
 }
 
@@ -13,22 +16,62 @@ DynamicTranslateTransform::~DynamicTranslateTransform()
 
 glm::mat4 DynamicTranslateTransform::getMatrix() const
 {
-    return glm::translate(glm::mat4(1.0f), position);
+    return glm::translate(glm::mat4(1.0f), getPosition());
 }
 
 void DynamicTranslateTransform::update(float deltaTime)
 {
+    if (store != nullptr) {
+        return;
+    }
+
     if (glm::length(velocity) > 0.0001f) {
         position += velocity * deltaTime;
     }
 }
 
+bool DynamicTranslateTransform::toRecord(TransformRecord& out) const
+{
+    out.position = position;
+    out.velocity = velocity;
+    return true;
+}
+
+void DynamicTranslateTransform::bindRecord(TransformStore* newStore, int newRecord)
+{
+    if (store != nullptr && newStore == nullptr) {
+        position = store->getPosition(record);
+        velocity = store->getVelocity(record);
+    }
+
+    store = newStore;
+    record = newRecord;
+}
+
 void DynamicTranslateTransform::setVelocity(const glm::vec3& vel)
 {
     velocity = vel;
+
+    if (store != nullptr) {
+        store->setVelocity(record, vel);
+    }
+}
+
+glm::vec3 DynamicTranslateTransform::getVelocity() const
+{
+    return store != nullptr ? store->getVelocity(record) : velocity;
 }
 
 void DynamicTranslateTransform::setPosition(const glm::vec3& pos)
 {
     position = pos;
+
+    if (store != nullptr) {
+        store->setPosition(record, pos);
+    }
+}
+
+glm::vec3 DynamicTranslateTransform::getPosition() const
+{
+    return store != nullptr ? store->getPosition(record) : position;
 }
\ No newline at end of file
@@ -8,16 +8,21 @@ private:
     glm::vec3 position;
     glm::vec3 velocity;
 
+    TransformStore* store;
+    int record;
+
 public:
     DynamicTranslateTransform(const glm::vec3& pos, const glm::vec3& vel);
     ~DynamicTranslateTransform();
 
     glm::mat4 getMatrix() const override;
     void update(float deltaTime) override;
+    bool toRecord(TransformRecord& record) const override;
+    void bindRecord(TransformStore* store, int record) override;
 
     void setVelocity(const glm::vec3& vel);
-    glm::vec3 getVelocity() const { return velocity; }
+    glm::vec3 getVelocity() const;
 
     void setPosition(const glm::vec3& pos);
-    glm::vec3 getPosition() const { return position; }
+    glm::vec3 getPosition() const;
 };
\ No newline at end of file
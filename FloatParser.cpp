@@ -0,0 +1,194 @@
+#include "FloatParser.h"
+#include <charconv>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define FLOAT_PARSER_SSE 1
+#include <emmintrin.h>
+#else
+#define FLOAT_PARSER_SSE 0
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace
+{
+    // Characters a number (or a comment, which has to be skipped) starts with.
+    bool isTokenStart(char c)
+    {
+        return (c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' || c == '/';
+    }
+
+    unsigned int countTrailingZeros(unsigned int mask)
+    {
+#if defined(_MSC_VER)
+        unsigned long index;
+        _BitScanForward(&index, mask);
+        return static_cast<unsigned int>(index);
+#else
+        return static_cast<unsigned int>(__builtin_ctz(mask));
+#endif
+    }
+
+    unsigned int countBits(unsigned int mask)
+    {
+        unsigned int count = 0;
+        for (; mask != 0; mask &= mask - 1)
+        {
+            count++;
+        }
+        return count;
+    }
+
+#if FLOAT_PARSER_SSE
+    // Bit i is set when p[i] is a token character.
+    unsigned int tokenMask(const char* p)
+    {
+        const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+
+        // Bytes above 0x7F compare as negative, so they never count as digits.
+        __m128i digits = _mm_and_si128(
+            _mm_cmpgt_epi8(bytes, _mm_set1_epi8('0' - 1)),
+            _mm_cmplt_epi8(bytes, _mm_set1_epi8('9' + 1)));
+        __m128i signs = _mm_or_si128(
+            _mm_cmpeq_epi8(bytes, _mm_set1_epi8('-')),
+            _mm_cmpeq_epi8(bytes, _mm_set1_epi8('+')));
+        __m128i other = _mm_or_si128(
+            _mm_cmpeq_epi8(bytes, _mm_set1_epi8('.')),
+            _mm_cmpeq_epi8(bytes, _mm_set1_epi8('/')));
+
+        return static_cast<unsigned int>(_mm_movemask_epi8(_mm_or_si128(digits, _mm_or_si128(signs, other))));
+    }
+#endif
+}
+
+size_t FloatParser::countNumbers(std::string_view text)
+{
+    const char* p = text.data();
+    const char* end = p + text.size();
+
+    // Counts runs of token characters, i.e. positions where one starts
+    // right after a separator.
+    size_t count = 0;
+    unsigned int previous = 0;
+
+#if FLOAT_PARSER_SSE
+    for (; end - p >= 16; p += 16)
+    {
+        unsigned int mask = tokenMask(p);
+        unsigned int starts = mask & ~((mask << 1) | previous) & 0xFFFF;
+        count += countBits(starts);
+        previous = mask >> 15;
+    }
+#endif
+
+    for (; p < end; p++)
+    {
+        unsigned int current = isTokenStart(*p) ? 1 : 0;
+        count += current & ~previous;
+        previous = current;
+    }
+
+    return count;
+}
+
+const char* FloatParser::skipToToken(const char* p, const char* end)
+{
+#if FLOAT_PARSER_SSE
+    for (; end - p >= 16; p += 16)
+    {
+        unsigned int mask = tokenMask(p);
+        if (mask != 0)
+        {
+            return p + countTrailingZeros(mask);
+        }
+    }
+#endif
+
+    while (p < end && !isTokenStart(*p))
+    {
+        p++;
+    }
+    return p;
+}
+
+bool FloatParser::next(const char*& p, const char* end, float& value, size_t& rejected)
+{
+    while (true)
+    {
+        p = skipToToken(p, end);
+        if (p == end)
+        {
+            return false;
+        }
+
+        if (*p == '/')
+        {
+            if (end - p >= 2 && p[1] == '/')
+            {
+                const void* newline = std::memchr(p, '\n', end - p);
+                p = newline ? static_cast<const char*>(newline) + 1 : end;
+                continue;
+            }
+
+            if (end - p >= 2 && p[1] == '*')
+            {
+                std::string_view rest(p + 2, end - p - 2);
+                size_t close = rest.find("*/");
+                p = close == std::string_view::npos ? end : p + 2 + close + 2;
+                continue;
+            }
+
+            rejected++;
+            p++;
+            continue;
+        }
+
+        // from_chars does not accept an explicit plus sign.
+        const char* start = (*p == '+') ? p + 1 : p;
+
+        std::from_chars_result result = std::from_chars(start, end, value);
+        if (result.ec == std::errc())
+        {
+            p = result.ptr;
+            return true;
+        }
+
+        rejected++;
+        p = (result.ec == std::errc::result_out_of_range) ? result.ptr : p + 1;
+    }
+}
+
+size_t FloatParser::parseAll(std::string_view text, std::vector<float>& out)
+{
+    out.reserve(out.size() + countNumbers(text));
+
+    const char* p = text.data();
+    const char* end = p + text.size();
+    size_t rejected = 0;
+    float value;
+
+    while (next(p, end, value, rejected))
+    {
+        out.push_back(value);
+    }
+
+    return rejected;
+}
+
+size_t FloatParser::parse(std::string_view text, float* out, size_t maxCount)
+{
+    const char* p = text.data();
+    const char* end = p + text.size();
+    size_t rejected = 0;
+    size_t count = 0;
+
+    while (count < maxCount && next(p, end, out[count], rejected))
+    {
+        count++;
+    }
+
+    return count;
+}
@@ -0,0 +1,26 @@
+#pragma once
+#include <string_view>
+#include <vector>
+#include <cstddef>
+
+// Pulls decimal floats out of C-style text (",", "f" suffixes, whitespace
+// and comments are skipped) without copying it. Separators are skipped 16
+// bytes at a time with SSE2 when available; numbers are converted with
+// std::from_chars, which rounds exactly like std::stof.
+class FloatParser
+{
+public:
+    // Quick upper bound on how many numbers the text holds, for reserving output.
+    static size_t countNumbers(std::string_view text);
+
+    // Appends every number in text to out. Returns how many tokens looked
+    // like a number but did not parse.
+    static size_t parseAll(std::string_view text, std::vector<float>& out);
+
+    // Parses at most maxCount numbers into out and returns how many were read.
+    static size_t parse(std::string_view text, float* out, size_t maxCount);
+
+private:
+    static const char* skipToToken(const char* p, const char* end);
+    static bool next(const char*& p, const char* end, float& value, size_t& rejected);
+};
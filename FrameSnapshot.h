@@ -0,0 +1,59 @@
+#pragma once
+#include <GL/glew.h>
+#include <cstdint>
+#include <vector>
+#include <glm/vec2.hpp>
+#include "Model.h"
+#include "InstanceBuffer.h"
+#include "UniformBlocks.h"
+
+class Scene;
+class ShaderProgram;
+
+// One instanced draw: every instance shares program, texture and mesh.
+struct DrawCommand
+{
+    ShaderProgram* shader;
+    GLuint texture;
+    // Holds a reference so the mesh outlives objects removed mid-frame.
+    Model model;
+    size_t firstInstance;
+    GLsizei instanceCount;
+    GLint stencilValue;
+};
+
+// Everything the render thread needs for one frame, copied out of the scene
+// by the simulation thread. The render thread only reads it.
+struct FrameSnapshot
+{
+    const Scene* scene;
+
+    FrameBlock frameBlock;
+    unsigned int cameraVersion;
+
+    LightBlock lightBlock;
+    unsigned int lightVersion;
+    // Point lights and their clusters; only copied when lightVersion changes.
+    std::vector<LightData> lights;
+    std::vector<glm::uvec2> lightClusters;
+    std::vector<uint32_t> lightIndices;
+
+    std::vector<DrawCommand> draws;
+    std::vector<InstanceData> instances;
+    // Stencil value of every instance. Batches of several instances write
+    // 0 and are only told apart when picking.
+    std::vector<GLint> stencilValues;
+    // Lights of the instances that do not use the clustered lists.
+    std::vector<uint32_t> objectLightIndices;
+
+    FrameSnapshot() : scene(nullptr), frameBlock(), cameraVersion(0), lightBlock(), lightVersion(0) {}
+
+    void clear()
+    {
+        scene = nullptr;
+        draws.clear();
+        instances.clear();
+        stencilValues.clear();
+        objectLightIndices.clear();
+    }
+};
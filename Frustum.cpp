@@ -0,0 +1,102 @@
+#include "Frustum.h"
+#include <glm/geometric.hpp>
+#include <cmath>
+
+Frustum::Frustum()
+{
+    for (int i = 0; i < PLANE_COUNT; i++)
+    {
+        planes[i] = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+    }
+}
+
+void Frustum::extract(const glm::mat4& viewProjection)
+{
+    // Gribb/Hartmann: glm is column-major, so row i is (m[0][i], m[1][i], m[2][i], m[3][i]).
+    glm::vec4 rows[4];
+    for (int i = 0; i < 4; i++)
+    {
+        rows[i] = glm::vec4(viewProjection[0][i], viewProjection[1][i], viewProjection[2][i], viewProjection[3][i]);
+    }
+
+    planes[LEFT] = rows[3] + rows[0];
+    planes[RIGHT] = rows[3] - rows[0];
+    planes[BOTTOM] = rows[3] + rows[1];
+    planes[TOP] = rows[3] - rows[1];
+    planes[NEAR_PLANE] = rows[3] + rows[2];
+    planes[FAR_PLANE] = rows[3] - rows[2];
+
+    for (int i = 0; i < PLANE_COUNT; i++)
+    {
+        float length = glm::length(glm::vec3(planes[i]));
+        if (length > 0.0f)
+        {
+            planes[i] /= length;
+        }
+    }
+}
+
+bool Frustum::intersectsSphere(const glm::vec3& center, float radius) const
+{
+    for (int i = 0; i < PLANE_COUNT; i++)
+    {
+        if (glm::dot(glm::vec3(planes[i]), center) + planes[i].w < -radius)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool Frustum::intersectsBox(const glm::vec3& min, const glm::vec3& max) const
+{
+    for (int i = 0; i < PLANE_COUNT; i++)
+    {
+        // Test the box corner furthest along the plane normal.
+        glm::vec3 positive(
+            planes[i].x >= 0.0f ? max.x : min.x,
+            planes[i].y >= 0.0f ? max.y : min.y,
+            planes[i].z >= 0.0f ? max.z : min.z);
+
+        if (glm::dot(glm::vec3(planes[i]), positive) + planes[i].w < 0.0f)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool Frustum::intersectsBox(const BoundingBox& box, const glm::mat4& modelMatrix) const
+{
+    return intersectsBox(box.transformed(modelMatrix));
+}
+
+Frustum::Containment Frustum::classifyBox(const BoundingBox& box) const
+{
+    Containment result = INSIDE;
+
+    for (int i = 0; i < PLANE_COUNT; i++)
+    {
+        glm::vec3 normal(planes[i]);
+        glm::vec3 positive(
+            normal.x >= 0.0f ? box.max.x : box.min.x,
+            normal.y >= 0.0f ? box.max.y : box.min.y,
+            normal.z >= 0.0f ? box.max.z : box.min.z);
+        glm::vec3 negative(
+            normal.x >= 0.0f ? box.min.x : box.max.x,
+            normal.y >= 0.0f ? box.min.y : box.max.y,
+            normal.z >= 0.0f ? box.min.z : box.max.z);
+
+        if (glm::dot(normal, positive) + planes[i].w < 0.0f)
+        {
+            return OUTSIDE;
+        }
+
+        if (glm::dot(normal, negative) + planes[i].w < 0.0f)
+        {
+            result = INTERSECTS;
+        }
+    }
+
+    return result;
+}
@@ -0,0 +1,34 @@
+#pragma once
+#include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+#include "BoundingVolume.h"
+
+// Six clip planes extracted from a view-projection matrix. Plane normals
+// point inwards, so a point is inside when every signed distance is >= 0.
+class Frustum
+{
+private:
+    enum Plane { LEFT = 0, RIGHT, BOTTOM, TOP, NEAR_PLANE, FAR_PLANE, PLANE_COUNT };
+
+    glm::vec4 planes[PLANE_COUNT];
+
+public:
+    enum Containment { OUTSIDE = 0, INTERSECTS, INSIDE };
+
+    Frustum();
+
+    void extract(const glm::mat4& viewProjection);
+
+    bool intersectsSphere(const glm::vec3& center, float radius) const;
+    bool intersectsBox(const glm::vec3& min, const glm::vec3& max) const;
+    bool intersectsBox(const BoundingBox& box) const { return intersectsBox(box.min, box.max); }
+
+    // Transforms a local bounding box by modelMatrix and tests the enclosing
+    // world-space box.
+    bool intersectsBox(const BoundingBox& box, const glm::mat4& modelMatrix) const;
+
+    // Like intersectsBox, but also reports boxes lying entirely inside, so
+    // hierarchy traversal can accept whole subtrees without further tests.
+    Containment classifyBox(const BoundingBox& box) const;
+};
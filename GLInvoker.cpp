@@ -0,0 +1,29 @@
+#include "GLInvoker.h"
+
+namespace
+{
+    thread_local const GLInvoker::Function* currentInvoker = nullptr;
+}
+
+GLInvoker::Scope::Scope(const Function& invoker)
+    : previous(currentInvoker)
+{
+    currentInvoker = &invoker;
+}
+
+GLInvoker::Scope::~Scope()
+{
+    currentInvoker = previous;
+}
+
+void GLInvoker::run(const std::function<void()>& task)
+{
+    if (currentInvoker != nullptr && *currentInvoker)
+    {
+        (*currentInvoker)(task);
+    }
+    else
+    {
+        task();
+    }
+}
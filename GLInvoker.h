@@ -0,0 +1,27 @@
+#pragma once
+#include <functional>
+
+// Runs the GL calls of code that may execute off the context thread, such
+// as scene builders on the job system. A Scope installs an invoker for the
+// calling thread; run() hands tasks to it and returns once they have run.
+// Threads without one run tasks inline.
+class GLInvoker
+{
+public:
+    typedef std::function<void(const std::function<void()>&)> Function;
+
+    class Scope
+    {
+    private:
+        const Function* previous;
+
+    public:
+        explicit Scope(const Function& invoker);
+        ~Scope();
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+    };
+
+    static void run(const std::function<void()>& task);
+};
@@ -1,10 +1,26 @@
 #pragma once
 #include <glm/mat4x4.hpp>
 
+struct TransformRecord;
+class TransformStore;
+
 class ITransformComponent
 {
 public:
     virtual ~ITransformComponent() = default;
     virtual glm::mat4 getMatrix() const = 0;
     virtual void update(float deltaTime) {}
+
+    // Describes the component as a TransformStore record. Components that
+    // cannot be expressed as translate * rotate * uniform scale return false
+    // and keep being evaluated through getMatrix().
+    virtual bool toRecord(TransformRecord&) const { return false; }
+
+    // Called when the store takes over (or, with nullptr, gives back) the
+    // component's animated state.
+    virtual void bindRecord(TransformStore*, int) {}
+
+    // Incremented by setters that change getMatrix(). Composites report the
+    // sum over their components, so cached products can tell they are stale.
+    virtual unsigned int getVersion() const { return 0; }
 };
\ No newline at end of file
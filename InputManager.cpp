@@ -6,6 +6,7 @@
 #include "Scene.h"
 #include "Camera.h"
 #include "DrawableObject.h"
+#include "ShaderVariantCache.h"
 #include <iostream>
 
 InputManager* InputManager::s_instance = nullptr;
@@ -108,6 +109,38 @@ void InputManager::handleKeyPress(int key, int action, int mods)
         app->getSceneManager().switchScene(4);
         std::cout << "Switched to Scene 4" << std::endl;
     }
+    else if (key == GLFW_KEY_5)
+    {
+        app->getSceneManager().switchScene(5);
+        std::cout << "Switched to Scene 5" << std::endl;
+    }
+    else if (key == GLFW_KEY_C)
+    {
+        Scene* currentScene = app->getSceneManager().getCurrentScene();
+        if (currentScene)
+        {
+            const CullingStats& stats = currentScene->getCullingStats();
+            std::cout << "\nCulling: " << stats.tested << " tested, " << stats.culled << " culled, "
+                << stats.drawn << " drawn in " << stats.drawCalls << " draw calls, "
+                << currentScene->getDynamicObjectCount() << " of " << currentScene->getObjectCount()
+                << " objects updated per frame" << std::endl;
+            const LightClusters& clusters = currentScene->getLightClusters();
+            std::cout << "Lights: " << currentScene->getLightCount() << " in "
+                << LightClusters::CLUSTER_COUNT << " clusters, " << clusters.getLightIndices().size()
+                << " cluster entries, at most " << clusters.getMaxLightsPerCluster() << " per cluster" << std::endl;
+            app->printFrameStats();
+            app->getSceneManager().printStats();
+            ShaderVariantCache::getInstance().printStats();
+        }
+    }
+    else if (key == GLFW_KEY_T)
+    {
+        app->setThreadedRendering(!app->getRenderer().isThreaded());
+    }
+    else if (key == GLFW_KEY_B)
+    {
+        app->runUpdateBenchmark();
+    }
     else if (key == GLFW_KEY_F)
     {
         Scene* currentScene = app->getSceneManager().getCurrentScene();
@@ -152,8 +185,7 @@ void InputManager::handleMouseButton(int button, int action, int mods, double xp
 
         GLfloat depth;
         GLuint index;
-        glReadPixels(x, newY, 1, 1, GL_DEPTH_COMPONENT, GL_FLOAT, &depth);
-        glReadPixels(x, newY, 1, 1, GL_STENCIL_INDEX, GL_UNSIGNED_INT, &index);
+        app->getRenderer().invoke([&] { app->getRenderer().pick(x, newY, depth, index); });
 
         printf("\n-----------------------------\n");
         printf("|Screen position: (%d, %d)\n", x, y);
@@ -184,7 +216,8 @@ void InputManager::handleMouseButton(int button, int action, int mods, double xp
                 viewport
             );
 
-            scene->putTree(worldPos);
+            // Loading the model may create GL objects.
+            app->getRenderer().invoke([&] { scene->putTree(worldPos); });
 
             printf("\n-------- teren PLANTED --------\n");
             printf("World position: (%.2f, %.2f, %.2f)\n",
@@ -0,0 +1,83 @@
+#include "InstanceBuffer.h"
+#include "VertexAttributes.h"
+#include <cstddef>
+
+InstanceBuffer::InstanceBuffer()
+    : bufferID(0)
+    , capacity(0)
+{
+    glGenBuffers(1, &bufferID);
+}
+
+InstanceBuffer::~InstanceBuffer()
+{
+    if (bufferID != 0)
+    {
+        glDeleteBuffers(1, &bufferID);
+        bufferID = 0;
+    }
+}
+
+void InstanceBuffer::upload(const std::vector<InstanceData>& instances)
+{
+    if (instances.empty())
+    {
+        return;
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, bufferID);
+
+    if (instances.size() > capacity)
+    {
+        capacity = instances.size() + instances.size() / 2;
+    }
+
+    // Orphan the previous storage so the driver does not wait for last frame's draws.
+    glBufferData(GL_ARRAY_BUFFER, capacity * sizeof(InstanceData), nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, instances.size() * sizeof(InstanceData), instances.data());
+
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void InstanceBuffer::bindAttributes(size_t firstInstance) const
+{
+    const GLsizei stride = sizeof(InstanceData);
+    const size_t base = firstInstance * sizeof(InstanceData);
+
+    glBindBuffer(GL_ARRAY_BUFFER, bufferID);
+
+    for (GLuint column = 0; column < 4; column++)
+    {
+        GLuint location = ATTRIB_INSTANCE_MODEL + column;
+        glEnableVertexAttribArray(location);
+        glVertexAttribPointer(location, 4, GL_FLOAT, GL_FALSE, stride,
+            (void*)(base + offsetof(InstanceData, modelMatrix) + column * sizeof(glm::vec4)));
+        glVertexAttribDivisor(location, 1);
+    }
+
+    for (GLuint column = 0; column < 3; column++)
+    {
+        GLuint location = ATTRIB_INSTANCE_NORMAL + column;
+        glEnableVertexAttribArray(location);
+        glVertexAttribPointer(location, 3, GL_FLOAT, GL_FALSE, stride,
+            (void*)(base + offsetof(InstanceData, normalMatrix) + column * sizeof(glm::vec3)));
+        glVertexAttribDivisor(location, 1);
+    }
+
+    glEnableVertexAttribArray(ATTRIB_INSTANCE_COLOR);
+    glVertexAttribPointer(ATTRIB_INSTANCE_COLOR, 3, GL_FLOAT, GL_FALSE, stride,
+        (void*)(base + offsetof(InstanceData, color)));
+    glVertexAttribDivisor(ATTRIB_INSTANCE_COLOR, 1);
+
+    glEnableVertexAttribArray(ATTRIB_INSTANCE_SHININESS);
+    glVertexAttribPointer(ATTRIB_INSTANCE_SHININESS, 1, GL_FLOAT, GL_FALSE, stride,
+        (void*)(base + offsetof(InstanceData, shininess)));
+    glVertexAttribDivisor(ATTRIB_INSTANCE_SHININESS, 1);
+
+    glEnableVertexAttribArray(ATTRIB_INSTANCE_LIGHTS);
+    glVertexAttribIPointer(ATTRIB_INSTANCE_LIGHTS, 3, GL_UNSIGNED_INT, stride,
+        (void*)(base + offsetof(InstanceData, lightOffset)));
+    glVertexAttribDivisor(ATTRIB_INSTANCE_LIGHTS, 1);
+
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
\ No newline at end of file
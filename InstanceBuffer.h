@@ -0,0 +1,43 @@
+#pragma once
+#include <GL/glew.h>
+#include <cstdint>
+#include <vector>
+#include <glm/mat4x4.hpp>
+#include <glm/mat3x3.hpp>
+#include <glm/vec3.hpp>
+
+struct InstanceData
+{
+    glm::mat4 modelMatrix;
+    glm::mat3 normalMatrix;
+    glm::vec3 color;
+    float shininess;
+    // The instance's lights in the frame's object light indices, or
+    // CLUSTERED_LIGHTS as the count; spotLight is 1 inside the spotlight's cone.
+    uint32_t lightOffset;
+    uint32_t lightCount;
+    uint32_t spotLight;
+};
+
+// Per-instance vertex stream shared by every batch drawn in a frame.
+class InstanceBuffer
+{
+private:
+    GLuint bufferID;
+    size_t capacity;
+
+public:
+    InstanceBuffer();
+    ~InstanceBuffer();
+
+    void upload(const std::vector<InstanceData>& instances);
+
+    // Points the instance attributes of the currently bound VAO at the
+    // instances starting at firstInstance.
+    void bindAttributes(size_t firstInstance) const;
+
+    size_t getCapacity() const { return capacity; }
+
+    InstanceBuffer(const InstanceBuffer&) = delete;
+    InstanceBuffer& operator=(const InstanceBuffer&) = delete;
+};
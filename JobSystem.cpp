@@ -0,0 +1,313 @@
+#include "JobSystem.h"
+#include <algorithm>
+
+JobSystem* JobSystem::instance = nullptr;
+
+// Deque owned by the current thread. Threads that are not workers share
+// deque 0 with the thread that created the pool.
+static thread_local size_t currentQueue = 0;
+
+Job::Job(std::function<void()> task)
+    : task(std::move(task)), pendingDependencies(1), finished(false)
+{
+}
+
+JobSystem::JobSystem()
+    : activeCount(0), queuedJobs(0), stopping(false)
+{
+    size_t capacity = std::max(1u, std::thread::hardware_concurrency());
+    for (size_t i = 0; i < capacity; i++)
+    {
+        queues.push_back(std::make_unique<WorkQueue>());
+    }
+
+    startWorkers(0);
+}
+
+JobSystem::~JobSystem()
+{
+    stopWorkers();
+}
+
+JobSystem& JobSystem::getInstance()
+{
+    if (!instance)
+        instance = new JobSystem();
+    return *instance;
+}
+
+void JobSystem::destroy()
+{
+    if (instance)
+    {
+        delete instance;
+        instance = nullptr;
+    }
+}
+
+void JobSystem::startWorkers(size_t threadCount)
+{
+    if (threadCount == 0 || threadCount > queues.size())
+    {
+        threadCount = queues.size();
+    }
+
+    activeCount = threadCount;
+    for (size_t i = 1; i < threadCount; i++)
+    {
+        workers.emplace_back(&JobSystem::workerLoop, this, i);
+    }
+}
+
+void JobSystem::stopWorkers()
+{
+    stopping = true;
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+    }
+    wakeCondition.notify_all();
+
+    for (std::thread& worker : workers)
+    {
+        worker.join();
+    }
+    workers.clear();
+    stopping = false;
+}
+
+void JobSystem::setThreadCount(size_t threadCount)
+{
+    // Jobs left in the deques of stopped workers stay where they are; every
+    // deque is searched when stealing, so they still run.
+    stopWorkers();
+    startWorkers(threadCount);
+}
+
+void JobSystem::workerLoop(size_t index)
+{
+    currentQueue = index;
+
+    while (!stopping)
+    {
+        JobHandle job = findJob();
+        if (!job)
+        {
+            job = findBackgroundJob();
+        }
+
+        if (job)
+        {
+            execute(job);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        wakeCondition.wait(lock, [this] { return stopping || queuedJobs.load() > 0; });
+    }
+}
+
+void JobSystem::enqueue(const JobHandle& job)
+{
+    WorkQueue& queue = *queues[currentQueue < activeCount.load() ? currentQueue : 0];
+    queuedJobs++;
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.jobs.push_back(job);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+    }
+    wakeCondition.notify_one();
+}
+
+JobHandle JobSystem::findBackgroundJob()
+{
+    std::lock_guard<std::mutex> lock(backgroundQueue.mutex);
+    if (backgroundQueue.jobs.empty())
+    {
+        return nullptr;
+    }
+
+    JobHandle job = backgroundQueue.jobs.front();
+    backgroundQueue.jobs.pop_front();
+    queuedJobs--;
+    return job;
+}
+
+JobHandle JobSystem::findJob()
+{
+    const size_t count = queues.size();
+    const size_t own = currentQueue < activeCount.load() ? currentQueue : 0;
+
+    // Newest local job first: its data is most likely still in cache.
+    {
+        WorkQueue& queue = *queues[own];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (!queue.jobs.empty())
+        {
+            JobHandle job = queue.jobs.back();
+            queue.jobs.pop_back();
+            queuedJobs--;
+            return job;
+        }
+    }
+
+    // Oldest job of another thread: usually the largest piece of work left.
+    for (size_t i = 1; i < count; i++)
+    {
+        WorkQueue& victim = *queues[(own + i) % count];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.jobs.empty())
+        {
+            JobHandle job = victim.jobs.front();
+            victim.jobs.pop_front();
+            queuedJobs--;
+            return job;
+        }
+    }
+
+    return nullptr;
+}
+
+void JobSystem::execute(const JobHandle& job)
+{
+    if (job->task)
+    {
+        job->task();
+    }
+
+    std::vector<JobHandle> ready;
+    {
+        std::lock_guard<std::mutex> lock(job->mutex);
+        job->finished.store(true, std::memory_order_release);
+        ready.swap(job->continuations);
+    }
+
+    for (const JobHandle& continuation : ready)
+    {
+        if (continuation->pendingDependencies.fetch_sub(1) == 1)
+        {
+            enqueue(continuation);
+        }
+    }
+}
+
+JobHandle JobSystem::schedule(std::function<void()> task)
+{
+    return schedule(std::move(task), std::vector<JobHandle>());
+}
+
+JobHandle JobSystem::schedule(std::function<void()> task, const std::vector<JobHandle>& dependencies)
+{
+    JobHandle job = std::make_shared<Job>(std::move(task));
+
+    // pendingDependencies starts at 1 so that a dependency finishing while
+    // this loop runs cannot queue the job early.
+    for (const JobHandle& dependency : dependencies)
+    {
+        if (!dependency)
+        {
+            continue;
+        }
+
+        std::lock_guard<std::mutex> lock(dependency->mutex);
+        if (!dependency->isFinished())
+        {
+            job->pendingDependencies++;
+            dependency->continuations.push_back(job);
+        }
+    }
+
+    if (job->pendingDependencies.fetch_sub(1) == 1)
+    {
+        enqueue(job);
+    }
+
+    return job;
+}
+
+JobHandle JobSystem::scheduleBackground(std::function<void()> task)
+{
+    JobHandle job = std::make_shared<Job>(std::move(task));
+    job->pendingDependencies = 0;
+
+    queuedJobs++;
+    {
+        std::lock_guard<std::mutex> lock(backgroundQueue.mutex);
+        backgroundQueue.jobs.push_back(job);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+    }
+    wakeCondition.notify_one();
+
+    return job;
+}
+
+void JobSystem::wait(const JobHandle& job)
+{
+    if (!job)
+    {
+        return;
+    }
+
+    waitUntil([&job] { return job->isFinished(); });
+}
+
+void JobSystem::waitUntil(const std::function<bool()>& condition)
+{
+    while (!condition())
+    {
+        JobHandle next = findJob();
+        if (next)
+        {
+            execute(next);
+        }
+        else
+        {
+            std::this_thread::yield();
+        }
+    }
+}
+
+void JobSystem::parallelFor(size_t count, size_t grainSize, const std::function<void(size_t, size_t)>& body)
+{
+    if (count == 0)
+    {
+        return;
+    }
+
+    // A few chunks per thread leave room for stealing when chunks are uneven.
+    size_t chunkSize = std::max<size_t>(grainSize, 1);
+    const size_t threadCount = activeCount.load();
+    size_t maxChunks = threadCount * 4;
+    if ((count + chunkSize - 1) / chunkSize > maxChunks)
+    {
+        chunkSize = (count + maxChunks - 1) / maxChunks;
+    }
+
+    if (threadCount == 1 || chunkSize >= count)
+    {
+        body(0, count);
+        return;
+    }
+
+    std::vector<JobHandle> chunks;
+    chunks.reserve((count + chunkSize - 1) / chunkSize);
+
+    // The first chunk runs on the calling thread after the rest are queued.
+    for (size_t begin = chunkSize; begin < count; begin += chunkSize)
+    {
+        size_t end = std::min(begin + chunkSize, count);
+        chunks.push_back(schedule([&body, begin, end] { body(begin, end); }));
+    }
+
+    body(0, chunkSize);
+
+    for (const JobHandle& chunk : chunks)
+    {
+        wait(chunk);
+    }
+}
@@ -0,0 +1,108 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class JobSystem;
+
+// A unit of work. It becomes runnable once all of its dependencies have
+// finished; jobs that depend on it are queued when it finishes.
+class Job
+{
+private:
+    friend class JobSystem;
+
+    std::function<void()> task;
+    std::atomic<int> pendingDependencies;
+    std::atomic<bool> finished;
+
+    std::mutex mutex;
+    std::vector<std::shared_ptr<Job>> continuations;
+
+public:
+    explicit Job(std::function<void()> task);
+
+    bool isFinished() const { return finished.load(std::memory_order_acquire); }
+};
+
+typedef std::shared_ptr<Job> JobHandle;
+
+// Work-stealing thread pool. Every worker owns a deque: it pushes and pops
+// at the back, idle workers steal from the front of the others. The thread
+// that created the pool owns deque 0 and runs jobs while it waits, so
+// wait() and parallelFor() never block a core. Long-running work (file
+// loads, scene builds) is scheduled as background jobs instead, which only
+// idle workers take: a thread waiting on a short job never ends up running
+// one.
+class JobSystem
+{
+private:
+    static JobSystem* instance;
+
+    struct WorkQueue
+    {
+        std::mutex mutex;
+        std::deque<JobHandle> jobs;
+    };
+
+    // One deque per hardware thread, allocated once. Restarting the pool
+    // only changes how many of them have a worker, so threads that push or
+    // steal meanwhile never see the array change.
+    std::vector<std::unique_ptr<WorkQueue>> queues;
+    std::atomic<size_t> activeCount;
+    std::vector<std::thread> workers;
+    WorkQueue backgroundQueue;
+
+    std::atomic<size_t> queuedJobs;
+    std::atomic<bool> stopping;
+    std::mutex sleepMutex;
+    std::condition_variable wakeCondition;
+
+    JobSystem();
+
+    void startWorkers(size_t workerCount);
+    void stopWorkers();
+    void workerLoop(size_t index);
+
+    void enqueue(const JobHandle& job);
+    JobHandle findJob();
+    JobHandle findBackgroundJob();
+    void execute(const JobHandle& job);
+
+public:
+    ~JobSystem();
+
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    static JobSystem& getInstance();
+    static void destroy();
+
+    // Number of threads that execute jobs, including the calling thread.
+    size_t getThreadCount() const { return activeCount.load(); }
+    // Restarts the pool with the given thread count (0 = one per core, and
+    // at most that). Call from the thread that created the pool; other
+    // threads may keep scheduling and waiting while it runs.
+    void setThreadCount(size_t threadCount);
+
+    JobHandle schedule(std::function<void()> task);
+    JobHandle schedule(std::function<void()> task, const std::vector<JobHandle>& dependencies);
+    // Runs on a worker thread only; never from wait() or parallelFor().
+    // With a single thread nothing runs it until workers are started again.
+    JobHandle scheduleBackground(std::function<void()> task);
+
+    // Runs other jobs on the calling thread until the job has finished.
+    void wait(const JobHandle& job);
+    // Runs other jobs on the calling thread until condition() returns true.
+    void waitUntil(const std::function<bool()>& condition);
+
+    // Calls body(begin, end) over [0, count) in chunks of at least
+    // grainSize elements and returns once every chunk has run.
+    void parallelFor(size_t count, size_t grainSize, const std::function<void(size_t, size_t)>& body);
+};
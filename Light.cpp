@@ -1,7 +1,16 @@
 #include "Light.h"
-#include "ShaderProgram.h"
+#include "UniformBlocks.h"
 #include <iostream>
 #include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+namespace
+{
+    // Contributions below this are faded out, so a light only has to be
+    // shaded within its radius.
+    const float LIGHT_CUTOFF = 0.03f;
+}
 
 Light::Light(const glm::vec3& position,
     const glm::vec3& color,
@@ -90,14 +99,39 @@ void Light::setAttenuation(float c, float l, float q)
     notify();
 }
 
-void Light::applyToShader(ShaderProgram& shader, int lightIndex) const
+void Light::applyToBlock(LightData& data) const
+{
+    data.position = position;
+    data.intensity = intensity;
+    data.color = color;
+    data.constant = constant;
+    data.linear = linear;
+    data.quadratic = quadratic;
+    data.radius = getRadius();
+    data.padding = 0.0f;
+}
+
+float Light::getRadius() const
+{
+    return computeRadius(intensity * std::max(color.x, std::max(color.y, color.z)), constant, linear, quadratic);
+}
+
+float Light::computeRadius(float brightness, float constant, float linear, float quadratic)
 {
-    std::string base = "lights[" + std::to_string(lightIndex) + "].";
-
-    shader.setUniform(base + "position", position);
-    shader.setUniform(base + "color", color);
-    shader.setUniform(base + "intensity", intensity);
-    shader.setUniform(base + "constant", constant);
-    shader.setUniform(base + "linear", linear);
-    shader.setUniform(base + "quadratic", quadratic);
+    // Solves brightness / (constant + linear * d + quadratic * d^2) = LIGHT_CUTOFF.
+    float c = constant - brightness / LIGHT_CUTOFF;
+    if (c >= 0.0f)
+    {
+        return 0.0f;
+    }
+
+    if (quadratic > 0.0f)
+    {
+        return (-linear + std::sqrt(linear * linear - 4.0f * quadratic * c)) / (2.0f * quadratic);
+    }
+    if (linear > 0.0f)
+    {
+        return -c / linear;
+    }
+    return FLT_MAX;
 }
\ No newline at end of file
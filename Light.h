@@ -4,7 +4,7 @@
 #include <string>
 #include "LightObserver.h"
 
-class ShaderProgram;
+struct LightData;
 
 class Light
 {
@@ -46,5 +46,11 @@ public:
     float getLinear() const { return linear; }
     float getQuadratic() const { return quadratic; }
 
-    void applyToShader(ShaderProgram& shader, int lightIndex = 0) const;
+    // Distance beyond which the attenuated light falls below LIGHT_CUTOFF of
+    // full brightness. Without linear or quadratic falloff the light reaches
+    // everywhere and FLT_MAX is returned.
+    float getRadius() const;
+    static float computeRadius(float brightness, float constant, float linear, float quadratic);
+
+    void applyToBlock(LightData& data) const;
 };
\ No newline at end of file
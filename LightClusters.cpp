@@ -0,0 +1,206 @@
+#include "LightClusters.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <glm/common.hpp>
+#include <glm/geometric.hpp>
+#include <glm/matrix.hpp>
+
+namespace
+{
+    int getTile(float ndc, int count)
+    {
+        // Clamped as a float first: corners close to the eye project far off screen.
+        float tile = glm::clamp((ndc * 0.5f + 0.5f) * count, 0.0f, count - 1.0f);
+        return static_cast<int>(tile);
+    }
+}
+
+LightClusters::LightClusters()
+    : boundsProjection(1.0f),
+    nearPlane(0.0f),
+    farPlane(0.0f),
+    frustumRadius(0.0f),
+    depthScale(0.0f),
+    depthBias(0.0f),
+    maxLightsPerCluster(0)
+{
+}
+
+void LightClusters::buildBounds(const glm::mat4& projection, float near, float far)
+{
+    boundsProjection = projection;
+    nearPlane = near;
+    farPlane = far;
+    frustumRadius = 0.0f;
+
+    depthScale = CLUSTER_COUNT_Z / std::log(far / near);
+    depthBias = -std::log(near) * depthScale;
+
+    // Rays through the tile corners, scaled to unit depth.
+    glm::mat4 inverseProjection = glm::inverse(projection);
+    std::vector<glm::vec3> rays((CLUSTER_COUNT_X + 1) * (CLUSTER_COUNT_Y + 1));
+    for (int y = 0; y <= CLUSTER_COUNT_Y; y++)
+    {
+        for (int x = 0; x <= CLUSTER_COUNT_X; x++)
+        {
+            glm::vec4 point = inverseProjection * glm::vec4(
+                2.0f * x / CLUSTER_COUNT_X - 1.0f, 2.0f * y / CLUSTER_COUNT_Y - 1.0f, -1.0f, 1.0f);
+            glm::vec3 ray = glm::vec3(point) / point.w;
+            ray /= -ray.z;
+
+            rays[y * (CLUSTER_COUNT_X + 1) + x] = ray;
+            frustumRadius = std::max(frustumRadius, glm::length(ray * far));
+        }
+    }
+
+    bounds.resize(CLUSTER_COUNT);
+    for (int z = 0; z < CLUSTER_COUNT_Z; z++)
+    {
+        float sliceNear = near * std::pow(far / near, static_cast<float>(z) / CLUSTER_COUNT_Z);
+        float sliceFar = near * std::pow(far / near, static_cast<float>(z + 1) / CLUSTER_COUNT_Z);
+
+        for (int y = 0; y < CLUSTER_COUNT_Y; y++)
+        {
+            for (int x = 0; x < CLUSTER_COUNT_X; x++)
+            {
+                BoundingBox& box = bounds[x + CLUSTER_COUNT_X * (y + CLUSTER_COUNT_Y * z)];
+                box.min = glm::vec3(FLT_MAX);
+                box.max = glm::vec3(-FLT_MAX);
+
+                // A froxel is convex, so its corners bound it.
+                for (int corner = 0; corner < 4; corner++)
+                {
+                    const glm::vec3& ray = rays[(y + corner / 2) * (CLUSTER_COUNT_X + 1) + x + corner % 2];
+                    box.min = glm::min(box.min, glm::min(ray * sliceNear, ray * sliceFar));
+                    box.max = glm::max(box.max, glm::max(ray * sliceNear, ray * sliceFar));
+                }
+            }
+        }
+    }
+}
+
+int LightClusters::getSlice(float depth) const
+{
+    int slice = static_cast<int>(std::floor(std::log(depth) * depthScale + depthBias));
+    return std::min(std::max(slice, 0), CLUSTER_COUNT_Z - 1);
+}
+
+void LightClusters::binLight(const LightData& light, uint32_t lightIndex, const glm::mat4& view,
+    const glm::mat4& projection)
+{
+    glm::vec3 center = glm::vec3(view * glm::vec4(light.position, 1.0f));
+    float radius = light.radius;
+    float depth = -center.z;
+
+    if (radius <= 0.0f || depth + radius < nearPlane || depth - radius > farPlane)
+    {
+        return;
+    }
+
+    // Lights reaching past every corner of the frustum, e.g. a sun, light
+    // all clusters; this also keeps unbounded radii out of the math below.
+    if (glm::length(center) + frustumRadius <= radius)
+    {
+        for (uint32_t cluster = 0; cluster < CLUSTER_COUNT; cluster++)
+        {
+            references.push_back(glm::uvec2(cluster, lightIndex));
+        }
+        return;
+    }
+
+    // Screen rectangle of the sphere's bounding box, cut at the near and far
+    // planes. It lies in front of the eye, so its corners bound the projection.
+    float minDepth = std::max(depth - radius, nearPlane);
+    float maxDepth = std::min(depth + radius, farPlane);
+
+    glm::vec2 ndcMin(FLT_MAX);
+    glm::vec2 ndcMax(-FLT_MAX);
+    for (int corner = 0; corner < 8; corner++)
+    {
+        glm::vec4 point(
+            center.x + ((corner & 1) ? radius : -radius),
+            center.y + ((corner & 2) ? radius : -radius),
+            (corner & 4) ? -maxDepth : -minDepth,
+            1.0f);
+        glm::vec4 clip = projection * point;
+        glm::vec2 ndc = glm::vec2(clip.x, clip.y) / clip.w;
+        ndcMin = glm::min(ndcMin, ndc);
+        ndcMax = glm::max(ndcMax, ndc);
+    }
+
+    if (ndcMin.x > 1.0f || ndcMin.y > 1.0f || ndcMax.x < -1.0f || ndcMax.y < -1.0f)
+    {
+        return;
+    }
+
+    int minX = getTile(ndcMin.x, CLUSTER_COUNT_X);
+    int maxX = getTile(ndcMax.x, CLUSTER_COUNT_X);
+    int minY = getTile(ndcMin.y, CLUSTER_COUNT_Y);
+    int maxY = getTile(ndcMax.y, CLUSTER_COUNT_Y);
+    int minZ = getSlice(minDepth);
+    int maxZ = getSlice(maxDepth);
+
+    // The rectangle is loose around the sphere, so each cluster is tested.
+    float radiusSquared = radius * radius;
+    for (int z = minZ; z <= maxZ; z++)
+    {
+        for (int y = minY; y <= maxY; y++)
+        {
+            for (int x = minX; x <= maxX; x++)
+            {
+                uint32_t cluster = x + CLUSTER_COUNT_X * (y + CLUSTER_COUNT_Y * z);
+                const BoundingBox& box = bounds[cluster];
+
+                glm::vec3 offset = glm::clamp(center, box.min, box.max) - center;
+                if (glm::dot(offset, offset) <= radiusSquared)
+                {
+                    references.push_back(glm::uvec2(cluster, lightIndex));
+                }
+            }
+        }
+    }
+}
+
+void LightClusters::build(const std::vector<LightData>& lights, const glm::mat4& view, const glm::mat4& projection,
+    float near, float far)
+{
+    if (bounds.empty() || projection != boundsProjection || near != nearPlane || far != farPlane)
+    {
+        buildBounds(projection, near, far);
+    }
+
+    references.clear();
+    for (size_t i = 0; i < lights.size(); i++)
+    {
+        binLight(lights[i], static_cast<uint32_t>(i), view, projection);
+    }
+
+    // Counting sort by cluster; lights keep their order within a cluster.
+    clusters.assign(CLUSTER_COUNT, glm::uvec2(0));
+    for (const glm::uvec2& reference : references)
+    {
+        clusters[reference.x].y++;
+    }
+
+    uint32_t offset = 0;
+    maxLightsPerCluster = 0;
+    for (glm::uvec2& cluster : clusters)
+    {
+        cluster.x = offset;
+        offset += cluster.y;
+        maxLightsPerCluster = std::max<size_t>(maxLightsPerCluster, cluster.y);
+    }
+
+    lightIndices.resize(references.size());
+    for (const glm::uvec2& reference : references)
+    {
+        lightIndices[clusters[reference.x].x++] = reference.y;
+    }
+
+    // Filling moved every offset past its lights.
+    for (glm::uvec2& cluster : clusters)
+    {
+        cluster.x -= cluster.y;
+    }
+}
@@ -0,0 +1,61 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <glm/mat4x4.hpp>
+#include <glm/vec2.hpp>
+#include "BoundingVolume.h"
+#include "UniformBlocks.h"
+
+// Bins point lights into a froxel grid for clustered forward shading. The
+// view frustum is split into CLUSTER_COUNT_X x CLUSTER_COUNT_Y screen tiles
+// and CLUSTER_COUNT_Z depth slices, spaced exponentially so that far slices
+// are not much deeper, relative to their width, than near ones. Every
+// cluster gets the range of getLightIndices() holding the lights whose
+// sphere of influence touches it; a fragment finds its cluster from its
+// screen position and view depth and shades only those lights.
+class LightClusters
+{
+public:
+    static const int CLUSTER_COUNT_X = 16;
+    static const int CLUSTER_COUNT_Y = 9;
+    static const int CLUSTER_COUNT_Z = 24;
+    static const int CLUSTER_COUNT = CLUSTER_COUNT_X * CLUSTER_COUNT_Y * CLUSTER_COUNT_Z;
+
+private:
+    // View-space bounds of every cluster; they only depend on the projection.
+    std::vector<BoundingBox> bounds;
+    glm::mat4 boundsProjection;
+    float nearPlane;
+    float farPlane;
+    // Distance from the eye to the farthest corner of the frustum.
+    float frustumRadius;
+    float depthScale;
+    float depthBias;
+
+    // First index and number of lights per cluster.
+    std::vector<glm::uvec2> clusters;
+    std::vector<uint32_t> lightIndices;
+    // Cluster and light of every overlap found, before they are sorted by
+    // cluster.
+    std::vector<glm::uvec2> references;
+    size_t maxLightsPerCluster;
+
+    void buildBounds(const glm::mat4& projection, float near, float far);
+    int getSlice(float depth) const;
+    void binLight(const LightData& light, uint32_t lightIndex, const glm::mat4& view, const glm::mat4& projection);
+
+public:
+    LightClusters();
+
+    // Lights are in world space with their radius set. near and far must
+    // be the planes of the perspective projection.
+    void build(const std::vector<LightData>& lights, const glm::mat4& view, const glm::mat4& projection,
+        float near, float far);
+
+    float getDepthScale() const { return depthScale; }
+    float getDepthBias() const { return depthBias; }
+
+    const std::vector<glm::uvec2>& getClusters() const { return clusters; }
+    const std::vector<uint32_t>& getLightIndices() const { return lightIndices; }
+    size_t getMaxLightsPerCluster() const { return maxLightsPerCluster; }
+};
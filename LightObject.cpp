@@ -1,10 +1,23 @@
 #include "LightObject.h"
 #include <iostream>
 #include <cmath>
+#include <mutex>
 #include <random>
 
-static std::random_device rd;
-static std::mt19937 gen(rd());
+namespace
+{
+    // Seeds handed out in construction order. Each object draws from its
+    // own engine, so its path does not depend on which thread updates it.
+    // Scenes may be built on several threads at once.
+    unsigned int nextSeed()
+    {
+        static std::mutex mutex;
+        static std::mt19937 seedSource(std::random_device{}());
+
+        std::lock_guard<std::mutex> lock(mutex);
+        return seedSource();
+    }
+}
 
 LightObject::LightObject(glm::vec3 center,
     float radius,
@@ -23,6 +36,7 @@ LightObject::LightObject(glm::vec3 center,
     , speed(2.0f) 
     , dynamicTransform(nullptr)
     , attachedLight(nullptr)
+    , rng(nextSeed())
 {
 
     attachedLight = new Light(
@@ -143,5 +157,5 @@ glm::vec3 LightObject::getRandomStartPosition() const
 float LightObject::randomFloat(float min, float max) const
 {
     std::uniform_real_distribution<float> dis(min, max);
-    return dis(gen);
+    return dis(rng);
 }
\ No newline at end of file
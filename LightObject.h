@@ -3,6 +3,7 @@
 #include "Light.h"
 #include "DynamicTranslateTransform.h"
 #include <glm/vec3.hpp>
+#include <random>
 
 class LightObject : public DrawableObject
 {
@@ -19,6 +20,8 @@ private:
     glm::vec3 currentVelocity;
     float speed;
 
+    mutable std::mt19937 rng;
+
 public:
     LightObject(glm::vec3 center,
         float radius,
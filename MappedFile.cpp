@@ -0,0 +1,145 @@
+#include "MappedFile.h"
+#include <iostream>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile()
+    : mapped(nullptr), mappedSize(0),
+#ifdef _WIN32
+    fileHandle(INVALID_HANDLE_VALUE), mappingHandle(nullptr)
+#else
+    fileDescriptor(-1)
+#endif
+{
+}
+
+MappedFile::~MappedFile()
+{
+    close();
+}
+
+#ifdef _WIN32
+
+bool MappedFile::open(const std::string& filePath)
+{
+    close();
+
+    fileHandle = CreateFileA(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+        OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (fileHandle == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(fileHandle, &fileSize) || fileSize.QuadPart == 0)
+    {
+        close();
+        return false;
+    }
+
+    mappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mappingHandle == nullptr)
+    {
+        std::cerr << "MappedFile: CreateFileMapping failed for " << filePath << std::endl;
+        close();
+        return false;
+    }
+
+    mapped = static_cast<const unsigned char*>(MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0));
+    if (mapped == nullptr)
+    {
+        std::cerr << "MappedFile: MapViewOfFile failed for " << filePath << std::endl;
+        close();
+        return false;
+    }
+
+    mappedSize = static_cast<size_t>(fileSize.QuadPart);
+    return true;
+}
+
+void MappedFile::close()
+{
+    if (mapped != nullptr)
+    {
+        UnmapViewOfFile(mapped);
+        mapped = nullptr;
+    }
+
+    if (mappingHandle != nullptr)
+    {
+        CloseHandle(mappingHandle);
+        mappingHandle = nullptr;
+    }
+
+    if (fileHandle != INVALID_HANDLE_VALUE)
+    {
+        CloseHandle(fileHandle);
+        fileHandle = INVALID_HANDLE_VALUE;
+    }
+
+    mappedSize = 0;
+}
+
+#else
+
+bool MappedFile::open(const std::string& filePath)
+{
+    close();
+
+    fileDescriptor = ::open(filePath.c_str(), O_RDONLY);
+    if (fileDescriptor < 0)
+    {
+        return false;
+    }
+
+    struct stat fileStat;
+    if (fstat(fileDescriptor, &fileStat) != 0 || fileStat.st_size == 0)
+    {
+        close();
+        return false;
+    }
+
+    void* address = mmap(nullptr, static_cast<size_t>(fileStat.st_size), PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+    if (address == MAP_FAILED)
+    {
+        std::cerr << "MappedFile: mmap failed for " << filePath << std::endl;
+        close();
+        return false;
+    }
+
+    mapped = static_cast<const unsigned char*>(address);
+    mappedSize = static_cast<size_t>(fileStat.st_size);
+
+    // The whole file is uploaded right away, so start reading it in now.
+    madvise(address, mappedSize, MADV_WILLNEED);
+    return true;
+}
+
+void MappedFile::close()
+{
+    if (mapped != nullptr)
+    {
+        munmap(const_cast<unsigned char*>(mapped), mappedSize);
+        mapped = nullptr;
+    }
+
+    if (fileDescriptor >= 0)
+    {
+        ::close(fileDescriptor);
+        fileDescriptor = -1;
+    }
+
+    mappedSize = 0;
+}
+
+#endif
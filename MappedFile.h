@@ -0,0 +1,33 @@
+#pragma once
+#include <string>
+#include <cstddef>
+
+// Read-only memory mapping of a whole file. Pages are loaded by the OS on
+// first access, so opening a large file costs next to nothing.
+class MappedFile
+{
+private:
+    const unsigned char* mapped;
+    size_t mappedSize;
+
+#ifdef _WIN32
+    void* fileHandle;
+    void* mappingHandle;
+#else
+    int fileDescriptor;
+#endif
+
+public:
+    MappedFile();
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool open(const std::string& filePath);
+    void close();
+
+    bool isOpen() const { return mapped != nullptr; }
+    const unsigned char* data() const { return mapped; }
+    size_t size() const { return mappedSize; }
+};
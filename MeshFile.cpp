@@ -0,0 +1,200 @@
+#include "MeshFile.h"
+#include "ModelCache.h"
+#include "MappedFile.h"
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+static_assert(sizeof(MeshFileHeader) == 88, "MeshFileHeader layout changed");
+
+namespace
+{
+    const char MAGIC[4] = { 'M', 'E', 'S', 'H' };
+
+    uint64_t alignOffset(uint64_t offset)
+    {
+        const uint64_t alignment = MeshFile::SECTION_ALIGNMENT;
+        return (offset + alignment - 1) / alignment * alignment;
+    }
+
+    template <typename T>
+    uint32_t findMaxIndex(const void* indices, uint64_t count)
+    {
+        const T* values = static_cast<const T*>(indices);
+        T result = 0;
+        for (uint64_t i = 0; i < count; i++)
+        {
+            result = values[i] > result ? values[i] : result;
+        }
+        return result;
+    }
+
+    void writePadding(std::ofstream& file, uint64_t from, uint64_t to)
+    {
+        static const char zeros[MeshFile::SECTION_ALIGNMENT] = {};
+        file.write(zeros, static_cast<std::streamsize>(to - from));
+    }
+}
+
+std::string MeshFile::getCookedPath(const std::string& sourcePath, const std::string& arrayName)
+{
+    size_t slash = sourcePath.find_last_of("/\\");
+    size_t dot = sourcePath.find_last_of('.');
+    std::string stem = (dot != std::string::npos && (slash == std::string::npos || dot > slash))
+        ? sourcePath.substr(0, dot)
+        : sourcePath;
+
+    if (!arrayName.empty())
+    {
+        stem += "." + arrayName;
+    }
+    return stem + ".mesh";
+}
+
+bool MeshFile::write(const std::string& filePath, const ModelData& data)
+{
+    MeshFileHeader header = {};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.stride = data.stride;
+    header.vertexCount = data.vertexCount;
+    header.indexCount = static_cast<uint32_t>(data.getIndexCount());
+    header.indexSize = data.isIndexed() ? static_cast<uint32_t>(data.getIndexSize()) : 0;
+    header.sourceVertexCount = data.sourceVertexCount;
+
+    for (int i = 0; i < 3; i++)
+    {
+        header.boundsMin[i] = data.bounds.min[i];
+        header.boundsMax[i] = data.bounds.max[i];
+        header.sphereCenter[i] = data.sphere.center[i];
+    }
+    header.sphereRadius = data.sphere.radius;
+
+    const uint64_t vertexBytes = static_cast<uint64_t>(data.getFloatCount()) * sizeof(float);
+    header.vertexOffset = alignOffset(sizeof(MeshFileHeader));
+    header.indexOffset = header.indexCount > 0 ? alignOffset(header.vertexOffset + vertexBytes) : 0;
+
+    std::ofstream file(filePath, std::ios::binary | std::ios::trunc);
+    if (!file.is_open())
+    {
+        std::cerr << "MeshFile: cannot write " << filePath << std::endl;
+        return false;
+    }
+
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    writePadding(file, sizeof(header), header.vertexOffset);
+    file.write(reinterpret_cast<const char*>(data.getVertexData()), static_cast<std::streamsize>(vertexBytes));
+
+    if (header.indexCount > 0)
+    {
+        writePadding(file, header.vertexOffset + vertexBytes, header.indexOffset);
+
+        if (data.isMapped())
+        {
+            file.write(static_cast<const char*>(data.mappedIndices),
+                static_cast<std::streamsize>(header.indexCount) * header.indexSize);
+        }
+        else if (header.indexSize == sizeof(uint16_t))
+        {
+            std::vector<uint16_t> shortIndices(data.indices.begin(), data.indices.end());
+            file.write(reinterpret_cast<const char*>(shortIndices.data()),
+                static_cast<std::streamsize>(shortIndices.size() * sizeof(uint16_t)));
+        }
+        else
+        {
+            file.write(reinterpret_cast<const char*>(data.indices.data()),
+                static_cast<std::streamsize>(data.indices.size() * sizeof(uint32_t)));
+        }
+    }
+
+    if (!file.good())
+    {
+        std::cerr << "MeshFile: write failed for " << filePath << std::endl;
+        return false;
+    }
+    return true;
+}
+
+std::shared_ptr<ModelData> MeshFile::load(const std::string& filePath, unsigned int expectedStride)
+{
+    auto file = std::make_shared<MappedFile>();
+    if (!file->open(filePath))
+    {
+        return nullptr;
+    }
+
+    if (file->size() < sizeof(MeshFileHeader))
+    {
+        std::cerr << "MeshFile: " << filePath << " is truncated" << std::endl;
+        return nullptr;
+    }
+
+    MeshFileHeader header;
+    std::memcpy(&header, file->data(), sizeof(header));
+
+    if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != VERSION)
+    {
+        std::cerr << "MeshFile: " << filePath << " is not a version " << VERSION << " mesh file" << std::endl;
+        return nullptr;
+    }
+
+    if (header.stride != expectedStride)
+    {
+        std::cerr << "MeshFile: " << filePath << " has stride " << header.stride
+            << ", expected " << expectedStride << std::endl;
+        return nullptr;
+    }
+
+    const uint64_t vertexBytes = static_cast<uint64_t>(header.vertexCount) * header.stride * sizeof(float);
+    const uint64_t indexBytes = static_cast<uint64_t>(header.indexCount) * header.indexSize;
+    const uint32_t expectedIndexSize = header.vertexCount > 0xFFFF ? sizeof(uint32_t) : sizeof(uint16_t);
+
+    bool valid = header.vertexCount > 0
+        && header.vertexOffset % SECTION_ALIGNMENT == 0
+        && header.vertexOffset + vertexBytes <= file->size();
+
+    if (header.indexCount > 0)
+    {
+        valid = valid
+            && header.indexSize == expectedIndexSize
+            && header.indexOffset % SECTION_ALIGNMENT == 0
+            && header.indexOffset + indexBytes <= file->size();
+    }
+
+    if (!valid)
+    {
+        std::cerr << "MeshFile: " << filePath << " is corrupt" << std::endl;
+        return nullptr;
+    }
+
+    const unsigned char* base = file->data();
+    const float* vertices = reinterpret_cast<const float*>(base + header.vertexOffset);
+    const void* indices = header.indexCount > 0 ? base + header.indexOffset : nullptr;
+
+    // A stale or damaged file must not hand glDrawElements indices past the
+    // vertex buffer. The pages are touched for the upload anyway.
+    if (indices != nullptr)
+    {
+        uint32_t maxIndex = header.indexSize == sizeof(uint16_t)
+            ? findMaxIndex<uint16_t>(indices, header.indexCount)
+            : findMaxIndex<uint32_t>(indices, header.indexCount);
+
+        if (maxIndex >= header.vertexCount)
+        {
+            std::cerr << "MeshFile: " << filePath << " indexes vertex " << maxIndex << " of "
+                << header.vertexCount << "; re-cook it from the source" << std::endl;
+            return nullptr;
+        }
+    }
+
+    auto modelData = std::make_shared<ModelData>(file, vertices, header.vertexCount, header.stride,
+        indices, header.indexCount);
+    modelData->sourceVertexCount = header.sourceVertexCount;
+    modelData->bounds.min = glm::vec3(header.boundsMin[0], header.boundsMin[1], header.boundsMin[2]);
+    modelData->bounds.max = glm::vec3(header.boundsMax[0], header.boundsMax[1], header.boundsMax[2]);
+    modelData->sphere.center = glm::vec3(header.sphereCenter[0], header.sphereCenter[1], header.sphereCenter[2]);
+    modelData->sphere.radius = header.sphereRadius;
+
+    return modelData;
+}
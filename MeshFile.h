@@ -0,0 +1,45 @@
+#pragma once
+#include <string>
+#include <memory>
+#include <cstdint>
+
+struct ModelData;
+
+// On-disk layout of a cooked mesh (.mesh), little endian:
+//   MeshFileHeader
+//   vertex data   vertexCount * stride floats, at vertexOffset
+//   index data    indexCount indices of indexSize bytes, at indexOffset
+// Both sections start on a SECTION_ALIGNMENT boundary. The data is already
+// welded and optimized, so loading is a map plus an upload.
+struct MeshFileHeader
+{
+    char magic[4];
+    uint32_t version;
+    uint32_t stride;
+    uint32_t vertexCount;
+    uint32_t indexCount;
+    uint32_t indexSize;
+    uint32_t sourceVertexCount;
+    uint32_t reserved;
+    float boundsMin[3];
+    float boundsMax[3];
+    float sphereCenter[3];
+    float sphereRadius;
+    uint64_t vertexOffset;
+    uint64_t indexOffset;
+};
+
+class MeshFile
+{
+public:
+    static const uint32_t VERSION = 1;
+    static const uint32_t SECTION_ALIGNMENT = 16;
+
+    // models/sphere.txt -> models/sphere.mesh, models/tree.h + "tree" -> models/tree.tree.mesh
+    static std::string getCookedPath(const std::string& sourcePath, const std::string& arrayName = "");
+
+    static bool write(const std::string& filePath, const ModelData& data);
+
+    // Returns nullptr if the file is missing, malformed or has another stride.
+    static std::shared_ptr<ModelData> load(const std::string& filePath, unsigned int expectedStride);
+};
@@ -0,0 +1,424 @@
+#include "MeshOptimizer.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <glm/vec3.hpp>
+#include <glm/geometric.hpp>
+
+namespace
+{
+    const int kCacheSize = 32;
+    const float kCacheDecayPower = 1.5f;
+    const float kLastTriScore = 0.75f;
+    const float kValenceBoostScale = 2.0f;
+    const float kValenceBoostPower = 0.5f;
+
+    float vertexScore(int cachePosition, unsigned int remainingTriangles)
+    {
+        if (remainingTriangles == 0)
+        {
+            return -1.0f;
+        }
+
+        float score = 0.0f;
+        if (cachePosition >= 0)
+        {
+            if (cachePosition < 3)
+            {
+                score = kLastTriScore;
+            }
+            else
+            {
+                const float scaler = 1.0f / (kCacheSize - 3);
+                score = std::pow(1.0f - (cachePosition - 3) * scaler, kCacheDecayPower);
+            }
+        }
+
+        score += kValenceBoostScale * std::pow(static_cast<float>(remainingTriangles), -kValenceBoostPower);
+        return score;
+    }
+
+    uint32_t hashVertex(const float* vertex, unsigned int stride)
+    {
+        const unsigned char* bytes = reinterpret_cast<const unsigned char*>(vertex);
+        uint32_t hash = 2166136261u;
+        for (size_t i = 0; i < stride * sizeof(float); i++)
+        {
+            hash ^= bytes[i];
+            hash *= 16777619u;
+        }
+        return hash;
+    }
+
+    glm::vec3 positionOf(const std::vector<float>& vertices, unsigned int stride, uint32_t index)
+    {
+        const float* v = &vertices[static_cast<size_t>(index) * stride];
+        return glm::vec3(v[0], v[1], v[2]);
+    }
+}
+
+void MeshOptimizer::weld(const std::vector<float>& vertices, unsigned int stride,
+    std::vector<float>& outVertices, std::vector<uint32_t>& outIndices)
+{
+    outVertices.clear();
+    outIndices.clear();
+
+    if (stride == 0)
+    {
+        return;
+    }
+
+    const size_t vertexCount = vertices.size() / stride;
+
+    size_t tableSize = 1;
+    while (tableSize < vertexCount * 2)
+    {
+        tableSize <<= 1;
+    }
+
+    const uint32_t empty = ~0u;
+    std::vector<uint32_t> table(tableSize, empty);
+
+    outVertices.reserve(vertices.size());
+    outIndices.reserve(vertexCount);
+
+    for (size_t i = 0; i < vertexCount; i++)
+    {
+        const float* vertex = &vertices[i * stride];
+        size_t slot = hashVertex(vertex, stride) & (tableSize - 1);
+
+        while (table[slot] != empty)
+        {
+            const float* candidate = &outVertices[static_cast<size_t>(table[slot]) * stride];
+            if (std::memcmp(candidate, vertex, stride * sizeof(float)) == 0)
+            {
+                break;
+            }
+            slot = (slot + 1) & (tableSize - 1);
+        }
+
+        if (table[slot] == empty)
+        {
+            table[slot] = static_cast<uint32_t>(outVertices.size() / stride);
+            outVertices.insert(outVertices.end(), vertex, vertex + stride);
+        }
+
+        outIndices.push_back(table[slot]);
+    }
+}
+
+void MeshOptimizer::optimizeVertexCache(std::vector<uint32_t>& indices, size_t vertexCount)
+{
+    const size_t triangleCount = indices.size() / 3;
+    if (triangleCount == 0 || vertexCount == 0)
+    {
+        return;
+    }
+
+    // Vertex -> triangle adjacency in compressed form.
+    std::vector<unsigned int> remaining(vertexCount, 0);
+    for (uint32_t index : indices)
+    {
+        remaining[index]++;
+    }
+
+    std::vector<size_t> adjacencyOffset(vertexCount + 1, 0);
+    for (size_t v = 0; v < vertexCount; v++)
+    {
+        adjacencyOffset[v + 1] = adjacencyOffset[v] + remaining[v];
+    }
+
+    std::vector<uint32_t> adjacency(indices.size());
+    std::vector<size_t> fill(adjacencyOffset.begin(), adjacencyOffset.end() - 1);
+    for (size_t t = 0; t < triangleCount; t++)
+    {
+        for (int k = 0; k < 3; k++)
+        {
+            adjacency[fill[indices[t * 3 + k]]++] = static_cast<uint32_t>(t);
+        }
+    }
+
+    std::vector<int> cachePosition(vertexCount, -1);
+    std::vector<float> score(vertexCount);
+    for (size_t v = 0; v < vertexCount; v++)
+    {
+        score[v] = vertexScore(-1, remaining[v]);
+    }
+
+    std::vector<float> triangleScore(triangleCount);
+    for (size_t t = 0; t < triangleCount; t++)
+    {
+        triangleScore[t] = score[indices[t * 3]] + score[indices[t * 3 + 1]] + score[indices[t * 3 + 2]];
+    }
+
+    std::vector<bool> emitted(triangleCount, false);
+    std::vector<uint32_t> result;
+    result.reserve(indices.size());
+
+    std::vector<uint32_t> cache;
+    std::vector<uint32_t> nextCache;
+    cache.reserve(kCacheSize + 3);
+    nextCache.reserve(kCacheSize + 3);
+
+    size_t scanCursor = 0;
+    long bestTriangle = -1;
+
+    for (size_t emittedCount = 0; emittedCount < triangleCount; emittedCount++)
+    {
+        if (bestTriangle < 0)
+        {
+            // Cache exhausted: restart from the best remaining triangle.
+            float bestScore = -1.0f;
+            for (size_t t = scanCursor; t < triangleCount; t++)
+            {
+                if (!emitted[t] && triangleScore[t] > bestScore)
+                {
+                    bestScore = triangleScore[t];
+                    bestTriangle = static_cast<long>(t);
+                }
+            }
+            while (scanCursor < triangleCount && emitted[scanCursor])
+            {
+                scanCursor++;
+            }
+        }
+
+        const size_t tri = static_cast<size_t>(bestTriangle);
+        emitted[tri] = true;
+
+        nextCache.clear();
+        for (int k = 0; k < 3; k++)
+        {
+            uint32_t v = indices[tri * 3 + k];
+            result.push_back(v);
+            nextCache.push_back(v);
+
+            // Remove the emitted triangle from the vertex adjacency.
+            size_t begin = adjacencyOffset[v];
+            size_t end = begin + remaining[v];
+            for (size_t a = begin; a < end; a++)
+            {
+                if (adjacency[a] == tri)
+                {
+                    std::swap(adjacency[a], adjacency[end - 1]);
+                    break;
+                }
+            }
+            remaining[v]--;
+        }
+
+        for (uint32_t v : cache)
+        {
+            if (v != nextCache[0] && v != nextCache[1] && v != nextCache[2])
+            {
+                nextCache.push_back(v);
+            }
+        }
+
+        for (size_t i = kCacheSize; i < nextCache.size(); i++)
+        {
+            cachePosition[nextCache[i]] = -1;
+            score[nextCache[i]] = vertexScore(-1, remaining[nextCache[i]]);
+        }
+        if (nextCache.size() > static_cast<size_t>(kCacheSize))
+        {
+            nextCache.resize(kCacheSize);
+        }
+        cache.swap(nextCache);
+
+        for (size_t i = 0; i < cache.size(); i++)
+        {
+            cachePosition[cache[i]] = static_cast<int>(i);
+            score[cache[i]] = vertexScore(static_cast<int>(i), remaining[cache[i]]);
+        }
+
+        // Rescore triangles touching the cache and pick the best of them.
+        bestTriangle = -1;
+        float bestScore = -1.0f;
+        for (uint32_t v : cache)
+        {
+            size_t begin = adjacencyOffset[v];
+            size_t end = begin + remaining[v];
+            for (size_t a = begin; a < end; a++)
+            {
+                uint32_t t = adjacency[a];
+                float s = score[indices[t * 3]] + score[indices[t * 3 + 1]] + score[indices[t * 3 + 2]];
+                triangleScore[t] = s;
+                if (s > bestScore)
+                {
+                    bestScore = s;
+                    bestTriangle = static_cast<long>(t);
+                }
+            }
+        }
+    }
+
+    indices.swap(result);
+}
+
+void MeshOptimizer::optimizeOverdraw(std::vector<uint32_t>& indices,
+    const std::vector<float>& vertices, unsigned int stride)
+{
+    const size_t triangleCount = indices.size() / 3;
+    const size_t vertexCount = stride > 0 ? vertices.size() / stride : 0;
+    if (triangleCount < 2 || vertexCount == 0)
+    {
+        return;
+    }
+
+    // Split the cache-optimized stream into clusters at points where a
+    // triangle misses on all three vertices; reordering whole clusters keeps
+    // most of the cache locality.
+    const unsigned int cacheSize = 16;
+    const size_t minClusterTriangles = 16;
+
+    std::vector<size_t> clusterStart;
+    std::vector<unsigned int> timestamp(vertexCount, 0);
+    unsigned int clock = cacheSize + 1;
+    size_t currentClusterSize = 0;
+
+    for (size_t t = 0; t < triangleCount; t++)
+    {
+        int misses = 0;
+        for (int k = 0; k < 3; k++)
+        {
+            uint32_t v = indices[t * 3 + k];
+            if (clock - timestamp[v] > cacheSize)
+            {
+                timestamp[v] = clock++;
+                misses++;
+            }
+        }
+
+        if (t == 0 || (misses == 3 && currentClusterSize >= minClusterTriangles))
+        {
+            clusterStart.push_back(t);
+            currentClusterSize = 0;
+        }
+        currentClusterSize++;
+    }
+
+    glm::vec3 meshCenter(0.0f);
+    float meshArea = 0.0f;
+
+    struct Cluster
+    {
+        size_t first;
+        size_t count;
+        glm::vec3 centroid;
+        glm::vec3 normal;
+        float sortKey;
+    };
+
+    std::vector<Cluster> clusters(clusterStart.size());
+    for (size_t c = 0; c < clusterStart.size(); c++)
+    {
+        Cluster& cluster = clusters[c];
+        cluster.first = clusterStart[c];
+        cluster.count = (c + 1 < clusterStart.size() ? clusterStart[c + 1] : triangleCount) - cluster.first;
+        cluster.centroid = glm::vec3(0.0f);
+        cluster.normal = glm::vec3(0.0f);
+
+        float clusterArea = 0.0f;
+        for (size_t t = cluster.first; t < cluster.first + cluster.count; t++)
+        {
+            glm::vec3 a = positionOf(vertices, stride, indices[t * 3]);
+            glm::vec3 b = positionOf(vertices, stride, indices[t * 3 + 1]);
+            glm::vec3 d = positionOf(vertices, stride, indices[t * 3 + 2]);
+
+            glm::vec3 n = glm::cross(b - a, d - a);
+            float area = glm::length(n);
+
+            cluster.centroid += (a + b + d) * (area / 3.0f);
+            cluster.normal += n;
+            clusterArea += area;
+        }
+
+        meshCenter += cluster.centroid;
+        meshArea += clusterArea;
+
+        if (clusterArea > 0.0f)
+        {
+            cluster.centroid /= clusterArea;
+        }
+
+        float normalLength = glm::length(cluster.normal);
+        if (normalLength > 0.0f)
+        {
+            cluster.normal /= normalLength;
+        }
+    }
+
+    if (meshArea > 0.0f)
+    {
+        meshCenter /= meshArea;
+    }
+
+    for (Cluster& cluster : clusters)
+    {
+        cluster.sortKey = glm::dot(cluster.centroid - meshCenter, cluster.normal);
+    }
+
+    std::stable_sort(clusters.begin(), clusters.end(),
+        [](const Cluster& a, const Cluster& b) { return a.sortKey > b.sortKey; });
+
+    std::vector<uint32_t> result;
+    result.reserve(indices.size());
+    for (const Cluster& cluster : clusters)
+    {
+        result.insert(result.end(),
+            indices.begin() + cluster.first * 3,
+            indices.begin() + (cluster.first + cluster.count) * 3);
+    }
+
+    indices.swap(result);
+}
+
+void MeshOptimizer::optimizeVertexFetch(std::vector<float>& vertices, unsigned int stride,
+    std::vector<uint32_t>& indices)
+{
+    const size_t vertexCount = stride > 0 ? vertices.size() / stride : 0;
+    const uint32_t unused = ~0u;
+
+    std::vector<uint32_t> remap(vertexCount, unused);
+    std::vector<float> result;
+    result.reserve(vertices.size());
+
+    uint32_t next = 0;
+    for (uint32_t& index : indices)
+    {
+        if (remap[index] == unused)
+        {
+            remap[index] = next++;
+            const float* vertex = &vertices[static_cast<size_t>(index) * stride];
+            result.insert(result.end(), vertex, vertex + stride);
+        }
+        index = remap[index];
+    }
+
+    vertices.swap(result);
+}
+
+float MeshOptimizer::computeACMR(const std::vector<uint32_t>& indices, size_t vertexCount, unsigned int cacheSize)
+{
+    const size_t triangleCount = indices.size() / 3;
+    if (triangleCount == 0)
+    {
+        return 0.0f;
+    }
+
+    std::vector<unsigned int> timestamp(vertexCount, 0);
+    unsigned int clock = cacheSize + 1;
+    size_t misses = 0;
+
+    for (uint32_t v : indices)
+    {
+        if (clock - timestamp[v] > cacheSize)
+        {
+            timestamp[v] = clock++;
+            misses++;
+        }
+    }
+
+    return static_cast<float>(misses) / static_cast<float>(triangleCount);
+}
@@ -0,0 +1,31 @@
+#pragma once
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+// Offline-style triangle list processing applied to meshes at load time.
+// All functions operate on interleaved float vertices with a fixed stride
+// whose first three floats are the position.
+class MeshOptimizer
+{
+public:
+    // Merges bit-identical vertices and returns an index buffer referencing
+    // the unique ones.
+    static void weld(const std::vector<float>& vertices, unsigned int stride,
+        std::vector<float>& outVertices, std::vector<uint32_t>& outIndices);
+
+    // Reorders triangles for post-transform vertex cache hits (Forsyth).
+    static void optimizeVertexCache(std::vector<uint32_t>& indices, size_t vertexCount);
+
+    // Reorders cache-friendly clusters of triangles so that outward facing
+    // clusters are drawn first, reducing overdraw without hurting cache reuse.
+    static void optimizeOverdraw(std::vector<uint32_t>& indices,
+        const std::vector<float>& vertices, unsigned int stride);
+
+    // Renumbers vertices in order of first use so vertex fetch is sequential.
+    static void optimizeVertexFetch(std::vector<float>& vertices, unsigned int stride,
+        std::vector<uint32_t>& indices);
+
+    // Average cache miss ratio (transformed vertices per triangle) for a FIFO cache.
+    static float computeACMR(const std::vector<uint32_t>& indices, size_t vertexCount, unsigned int cacheSize = 16);
+};
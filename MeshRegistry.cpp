@@ -0,0 +1,198 @@
+#include "MeshRegistry.h"
+#include "ModelCache.h"
+#include "VertexAttributes.h"
+#include <iostream>
+#include <vector>
+
+MeshRegistry* MeshRegistry::instance = nullptr;
+
+GpuMesh::GpuMesh()
+    : VAO(0), VBO(0), EBO(0), vertexCount(0), indexCount(0), indexType(GL_UNSIGNED_INT), stride(0), sizeBytes(0)
+{
+}
+
+GpuMesh::~GpuMesh()
+{
+    if (EBO != 0)
+    {
+        glDeleteBuffers(1, &EBO);
+    }
+
+    if (VBO != 0)
+    {
+        glDeleteBuffers(1, &VBO);
+    }
+
+    if (VAO != 0)
+    {
+        glDeleteVertexArrays(1, &VAO);
+    }
+}
+
+MeshRegistry::MeshRegistry()
+    : uploadCount(0), hitCount(0), bytesUploaded(0), bytesSaved(0)
+{
+}
+
+MeshRegistry::~MeshRegistry()
+{
+}
+
+MeshRegistry& MeshRegistry::getInstance()
+{
+    if (!instance)
+        instance = new MeshRegistry();
+    return *instance;
+}
+
+void MeshRegistry::destroy()
+{
+    if (instance)
+    {
+        delete instance;
+        instance = nullptr;
+    }
+}
+
+std::shared_ptr<GpuMesh> MeshRegistry::createMesh(const float* vertices, size_t floatCount, GLuint stride,
+    const uint32_t* indices, size_t indexCount)
+{
+    if (indices != nullptr && indexCount > 0 && floatCount / stride <= 0xFFFF)
+    {
+        std::vector<uint16_t> shortIndices(indices, indices + indexCount);
+        return createMesh(vertices, floatCount, stride, shortIndices.data(), indexCount, GL_UNSIGNED_SHORT);
+    }
+
+    return createMesh(vertices, floatCount, stride, static_cast<const void*>(indices), indexCount, GL_UNSIGNED_INT);
+}
+
+std::shared_ptr<GpuMesh> MeshRegistry::createMesh(const float* vertices, size_t floatCount, GLuint stride,
+    const void* indices, size_t indexCount, GLenum indexType)
+{
+    if (vertices == nullptr || floatCount == 0 || stride < 3)
+    {
+        std::cerr << "MeshRegistry::createMesh() - Invalid vertex data!" << std::endl;
+        return nullptr;
+    }
+
+    auto mesh = std::make_shared<GpuMesh>();
+    mesh->vertexCount = static_cast<GLsizei>(floatCount / stride);
+    mesh->stride = stride;
+    mesh->sizeBytes = floatCount * sizeof(float);
+
+    glGenVertexArrays(1, &mesh->VAO);
+    glGenBuffers(1, &mesh->VBO);
+    glBindVertexArray(mesh->VAO);
+    glBindBuffer(GL_ARRAY_BUFFER, mesh->VBO);
+    glBufferData(GL_ARRAY_BUFFER, mesh->sizeBytes, vertices, GL_STATIC_DRAW);
+
+    const GLsizei strideBytes = stride * sizeof(float);
+
+    glEnableVertexAttribArray(ATTRIB_POSITION);
+    glVertexAttribPointer(ATTRIB_POSITION, 3, GL_FLOAT, GL_FALSE, strideBytes, (void*)0);
+
+    if (stride >= 6)
+    {
+        glEnableVertexAttribArray(ATTRIB_NORMAL);
+        glVertexAttribPointer(ATTRIB_NORMAL, 3, GL_FLOAT, GL_FALSE, strideBytes, (void*)(3 * sizeof(float)));
+    }
+
+    if (stride >= 8)
+    {
+        glEnableVertexAttribArray(ATTRIB_TEXCOORD);
+        glVertexAttribPointer(ATTRIB_TEXCOORD, 2, GL_FLOAT, GL_FALSE, strideBytes, (void*)(6 * sizeof(float)));
+    }
+
+    if (indices != nullptr && indexCount > 0)
+    {
+        const size_t indexBytes = indexCount * (indexType == GL_UNSIGNED_SHORT ? sizeof(uint16_t) : sizeof(uint32_t));
+
+        mesh->indexCount = static_cast<GLsizei>(indexCount);
+        mesh->indexType = indexType;
+        glGenBuffers(1, &mesh->EBO);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh->EBO);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexBytes, indices, GL_STATIC_DRAW);
+        mesh->sizeBytes += indexBytes;
+    }
+
+    // The element buffer binding is VAO state, so unbind the VAO first.
+    glBindVertexArray(0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+    return mesh;
+}
+
+std::shared_ptr<GpuMesh> MeshRegistry::acquire(const ModelData& modelData)
+{
+    auto it = meshes.find(modelData.key);
+    if (it != meshes.end())
+    {
+        if (std::shared_ptr<GpuMesh> mesh = it->second.lock())
+        {
+            hitCount++;
+            bytesSaved += mesh->sizeBytes;
+            return mesh;
+        }
+    }
+
+    std::shared_ptr<GpuMesh> mesh;
+    if (modelData.isMapped())
+    {
+        // Cooked indices are already 16-bit where possible; upload straight from the mapping.
+        GLenum indexType = modelData.getIndexSize() == sizeof(uint16_t) ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+        mesh = createMesh(modelData.getVertexData(), modelData.getFloatCount(), modelData.stride,
+            modelData.mappedIndices, modelData.mappedIndexCount, indexType);
+    }
+    else
+    {
+        mesh = createMesh(modelData.vertices.data(), modelData.vertices.size(), modelData.stride,
+            modelData.indices.data(), modelData.indices.size());
+    }
+
+    if (!mesh)
+    {
+        return nullptr;
+    }
+
+    meshes[modelData.key] = mesh;
+    uploadCount++;
+    bytesUploaded += mesh->sizeBytes;
+
+    return mesh;
+}
+
+size_t MeshRegistry::getResidentBytes() const
+{
+    size_t total = 0;
+    for (const auto& pair : meshes)
+    {
+        if (std::shared_ptr<GpuMesh> mesh = pair.second.lock())
+        {
+            total += mesh->sizeBytes;
+        }
+    }
+    return total;
+}
+
+void MeshRegistry::printStats() const
+{
+    size_t resident = 0;
+    long references = 0;
+
+    for (const auto& pair : meshes)
+    {
+        if (std::shared_ptr<GpuMesh> mesh = pair.second.lock())
+        {
+            resident++;
+            references += pair.second.use_count();
+        }
+    }
+
+    std::cout << "\n=== GPU Mesh Registry ===\n";
+    std::cout << "Resident meshes: " << resident << " (" << references << " references)\n";
+    std::cout << "Uploads: " << uploadCount << ", shared hits: " << hitCount << "\n";
+    std::cout << "GPU memory: " << getResidentBytes() / 1024 << " KB resident, "
+        << bytesUploaded / 1024 << " KB uploaded\n";
+    std::cout << "GPU memory saved by sharing: " << bytesSaved / 1024 << " KB\n";
+    std::cout << "========================\n";
+}
@@ -0,0 +1,61 @@
+#pragma once
+#include <GL/glew.h>
+#include <string>
+#include <map>
+#include <memory>
+#include <cstdint>
+
+struct ModelData;
+
+struct GpuMesh
+{
+    GLuint VAO;
+    GLuint VBO;
+    GLuint EBO;
+    GLsizei vertexCount;
+    GLsizei indexCount;
+    GLenum indexType;
+    GLuint stride;
+    size_t sizeBytes;
+
+    GpuMesh();
+    ~GpuMesh();
+
+    GpuMesh(const GpuMesh&) = delete;
+    GpuMesh& operator=(const GpuMesh&) = delete;
+};
+
+// Hands out one VAO/VBO per cached ModelData. Meshes are released when the
+// last Model referencing them goes away.
+class MeshRegistry
+{
+private:
+    static MeshRegistry* instance;
+    std::map<std::string, std::weak_ptr<GpuMesh>> meshes;
+
+    size_t uploadCount;
+    size_t hitCount;
+    size_t bytesUploaded;
+    size_t bytesSaved;
+
+    MeshRegistry();
+
+public:
+    ~MeshRegistry();
+
+    static MeshRegistry& getInstance();
+    static void destroy();
+
+    // Indices are stored as 16-bit when every vertex fits, 32-bit otherwise.
+    static std::shared_ptr<GpuMesh> createMesh(const float* vertices, size_t floatCount, GLuint stride,
+        const uint32_t* indices = nullptr, size_t indexCount = 0);
+    // Uploads indices as they are; indexType is GL_UNSIGNED_SHORT or GL_UNSIGNED_INT.
+    static std::shared_ptr<GpuMesh> createMesh(const float* vertices, size_t floatCount, GLuint stride,
+        const void* indices, size_t indexCount, GLenum indexType);
+
+    std::shared_ptr<GpuMesh> acquire(const ModelData& modelData);
+
+    size_t getResidentBytes() const;
+    size_t getBytesSaved() const { return bytesSaved; }
+    void printStats() const;
+};
@@ -0,0 +1,123 @@
+#include "MeshUploadQueue.h"
+#include <chrono>
+#include <iostream>
+
+MeshUploadQueue* MeshUploadQueue::instance = nullptr;
+
+MeshRequest::MeshRequest(ModelFuture future)
+    : modelFuture(std::move(future)), state(LOADING)
+{
+}
+
+MeshUploadQueue::MeshUploadQueue()
+    : residentCount(0), failedCount(0), uploadTime(0.0)
+{
+}
+
+MeshUploadQueue::~MeshUploadQueue()
+{
+}
+
+MeshUploadQueue& MeshUploadQueue::getInstance()
+{
+    if (!instance)
+        instance = new MeshUploadQueue();
+    return *instance;
+}
+
+void MeshUploadQueue::destroy()
+{
+    if (instance)
+    {
+        delete instance;
+        instance = nullptr;
+    }
+}
+
+MeshRequestHandle MeshUploadQueue::request(ModelFuture future)
+{
+    MeshRequestHandle handle = std::make_shared<MeshRequest>(std::move(future));
+
+    std::lock_guard<std::mutex> lock(mutex);
+    requests.push_back(handle);
+    return handle;
+}
+
+void MeshUploadQueue::process(double budgetSeconds)
+{
+    std::vector<MeshRequestHandle> pending;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (requests.empty())
+        {
+            return;
+        }
+        pending.swap(requests);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    auto elapsed = [&start] {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    };
+
+    std::vector<MeshRequestHandle> waiting;
+    bool uploaded = false;
+
+    for (MeshRequestHandle& request : pending)
+    {
+        // Nobody is waiting for it any more, e.g. the object was deleted.
+        if (request.use_count() == 1)
+        {
+            continue;
+        }
+
+        bool ready = request->modelFuture.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+        if (!ready || (uploaded && elapsed() >= budgetSeconds))
+        {
+            waiting.push_back(request);
+            continue;
+        }
+
+        std::shared_ptr<ModelData> modelData = request->modelFuture.get();
+        std::shared_ptr<GpuMesh> mesh = modelData ? MeshRegistry::getInstance().acquire(*modelData) : nullptr;
+
+        if (!mesh)
+        {
+            request->state.store(MeshRequest::FAILED, std::memory_order_release);
+            failedCount++;
+            continue;
+        }
+
+        request->modelData = modelData;
+        request->mesh = mesh;
+        request->state.store(MeshRequest::RESIDENT, std::memory_order_release);
+
+        residentCount++;
+        uploaded = true;
+    }
+
+    double time = elapsed();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    uploadTime += time;
+    // Requests made while this ran go after the ones that were already waiting.
+    waiting.insert(waiting.end(), requests.begin(), requests.end());
+    requests.swap(waiting);
+}
+
+size_t MeshUploadQueue::getPendingCount()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return requests.size();
+}
+
+void MeshUploadQueue::printStats()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    std::cout << "\n=== Mesh Upload Queue ===\n";
+    std::cout << "Pending: " << requests.size() << "\n";
+    std::cout << "Resident: " << residentCount << ", failed: " << failedCount << "\n";
+    std::cout << "Time on the GL thread: " << uploadTime * 1000.0 << " ms\n";
+    std::cout << "========================\n";
+}
@@ -0,0 +1,74 @@
+#pragma once
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "MeshRegistry.h"
+#include "ModelCache.h"
+
+// One asynchronously loaded model, from parsing on a worker thread to a
+// mesh resident on the GPU.
+class MeshRequest
+{
+public:
+    enum State { LOADING, RESIDENT, FAILED };
+
+private:
+    friend class MeshUploadQueue;
+
+    ModelFuture modelFuture;
+    // Written on the GL thread before the state becomes RESIDENT.
+    std::shared_ptr<ModelData> modelData;
+    std::shared_ptr<GpuMesh> mesh;
+    std::atomic<State> state;
+
+public:
+    explicit MeshRequest(ModelFuture future);
+
+    State getState() const { return state.load(std::memory_order_acquire); }
+    bool isResident() const { return getState() == RESIDENT; }
+    bool isFailed() const { return getState() == FAILED; }
+
+    // Only valid once the request is resident.
+    const std::shared_ptr<ModelData>& getModelData() const { return modelData; }
+    const std::shared_ptr<GpuMesh>& getMesh() const { return mesh; }
+};
+
+typedef std::shared_ptr<MeshRequest> MeshRequestHandle;
+
+// Creates GPU buffers for models loaded in the background. The renderer
+// drains it on the GL thread once per frame, within a time budget, so a
+// burst of finished loads cannot stall a frame.
+class MeshUploadQueue
+{
+private:
+    static MeshUploadQueue* instance;
+
+    std::mutex mutex;
+    std::vector<MeshRequestHandle> requests;
+
+    size_t residentCount;
+    size_t failedCount;
+    double uploadTime;
+
+    MeshUploadQueue();
+
+public:
+    ~MeshUploadQueue();
+
+    MeshUploadQueue(const MeshUploadQueue&) = delete;
+    MeshUploadQueue& operator=(const MeshUploadQueue&) = delete;
+
+    static MeshUploadQueue& getInstance();
+    // Releases the meshes of unclaimed requests; needs the GL context.
+    static void destroy();
+
+    MeshRequestHandle request(ModelFuture future);
+
+    // GL thread only. Uploads meshes whose data is ready until budgetSeconds
+    // have passed; at least one per call, so large meshes still get through.
+    void process(double budgetSeconds);
+
+    size_t getPendingCount();
+    void printStats();
+};
@@ -1,19 +1,15 @@
 #pragma once
 #include <GL/glew.h>
 #include <vector>
+#include <memory>
 #include <glm/vec3.hpp>
 #include <iostream>
-
-class ShaderProgram;
+#include "MeshRegistry.h"
 
 class Model
 {
 private:
-    GLuint VAO;
-    GLuint VBO;
-    GLuint vertexCount;
-    GLuint stride;
-    bool isLoaded;
+    std::shared_ptr<GpuMesh> mesh;
 
 public:
     Model();
@@ -23,14 +19,20 @@ public:
 
     //void load(const std::vector<glm::vec3>& vertices);
 
-    void loadWithStride(const float* vertices, unsigned int vertexCount, GLuint vertexSize, ShaderProgram* shader = nullptr);
+    void loadWithStride(const float* vertices, unsigned int floatCount, GLuint vertexSize);
+    void setMesh(std::shared_ptr<GpuMesh> sharedMesh);
 
     void draw() const;
+    void bind() const;
+    void drawBound() const;
+    void drawInstancedBound(GLsizei instanceCount) const;
 
-    GLuint getVAO() const { return VAO; }
-    GLuint getVBO() const { return VBO; }
-    unsigned int getVertexCount() const { return vertexCount; }
-    bool isModelLoaded() const { return isLoaded; }
+    GLuint getVAO() const { return mesh ? mesh->VAO : 0; }
+    GLuint getVBO() const { return mesh ? mesh->VBO : 0; }
+    unsigned int getVertexCount() const { return mesh ? mesh->vertexCount : 0; }
+    unsigned int getIndexCount() const { return mesh ? mesh->indexCount : 0; }
+    const GpuMesh* getMesh() const { return mesh.get(); }
+    bool isModelLoaded() const { return mesh != nullptr; }
 
     void cleanup();
-};
\ No newline at end of file
+};
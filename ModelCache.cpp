@@ -1,11 +1,67 @@
 #include "ModelCache.h"
+#include "MeshOptimizer.h"
+#include "MeshFile.h"
+#include "JobSystem.h"
+#include <chrono>
+#include <filesystem>
 #include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <algorithm>
+#include <cmath>
+#include <glm/common.hpp>
+#include <glm/geometric.hpp>
 
 ModelCache* ModelCache::instance = nullptr;
 
-ModelData::ModelData(const std::vector<float>& verts, unsigned int count, unsigned int str)
-    : vertices(verts), vertexCount(count), stride(str)
+ModelData::ModelData(std::vector<float> verts, unsigned int count, unsigned int str)
+    : vertices(std::move(verts)),
+    mappedVertices(nullptr), mappedIndices(nullptr), mappedIndexCount(0),
+    vertexCount(count), stride(str), sourceVertexCount(count)
 {
+    computeBounds();
+}
+
+ModelData::ModelData(std::shared_ptr<MappedFile> file, const float* verts, unsigned int count, unsigned int str,
+    const void* inds, size_t indexCount)
+    : mapping(std::move(file)),
+    mappedVertices(verts), mappedIndices(inds), mappedIndexCount(indexCount),
+    vertexCount(count), stride(str), sourceVertexCount(count)
+{
+}
+
+void ModelData::computeBounds()
+{
+    if (vertexCount == 0 || stride < 3)
+    {
+        bounds = BoundingBox();
+        sphere = BoundingSphere();
+        return;
+    }
+
+    const float* data = getVertexData();
+    bounds.min = glm::vec3(data[0], data[1], data[2]);
+    bounds.max = bounds.min;
+
+    for (unsigned int i = 1; i < vertexCount; i++)
+    {
+        const float* p = data + static_cast<size_t>(i) * stride;
+        glm::vec3 position(p[0], p[1], p[2]);
+        bounds.min = glm::min(bounds.min, position);
+        bounds.max = glm::max(bounds.max, position);
+    }
+
+    // Centered on the box; the radius is the furthest vertex, which is
+    // never larger than the box's half diagonal.
+    sphere.center = bounds.getCenter();
+    float radiusSquared = 0.0f;
+    for (unsigned int i = 0; i < vertexCount; i++)
+    {
+        const float* p = data + static_cast<size_t>(i) * stride;
+        glm::vec3 offset = glm::vec3(p[0], p[1], p[2]) - sphere.center;
+        radiusSquared = std::max(radiusSquared, glm::dot(offset, offset));
+    }
+    sphere.radius = std::sqrt(radiusSquared);
 }
 
 ModelCache::ModelCache()
@@ -21,6 +77,152 @@ std::string ModelCache::generateKey(const std::string& filePath, const std::stri
     return filePath + ":" + arrayName;
 }
 
+std::shared_ptr<ModelData> ModelCache::find(const std::string& key) const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = cache.find(key);
+    return it != cache.end() ? it->second : nullptr;
+}
+
+std::shared_ptr<ModelData> ModelCache::insert(const std::string& key, std::shared_ptr<ModelData> modelData)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    auto result = cache.emplace(key, std::move(modelData));
+    return result.first->second;
+}
+
+ModelFuture ModelCache::loadAsync(const std::string& key, std::function<std::shared_ptr<ModelData>()> load)
+{
+    auto promise = std::make_shared<std::promise<std::shared_ptr<ModelData>>>();
+    ModelFuture future = promise->get_future().share();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        auto cached = cache.find(key);
+        if (cached != cache.end())
+        {
+            promise->set_value(cached->second);
+            return future;
+        }
+
+        auto pending = loading.find(key);
+        if (pending != loading.end())
+        {
+            return pending->second;
+        }
+
+        loading[key] = future;
+    }
+
+    auto job = [this, key, load, promise] {
+        // A load that throws fails like one that returns null; the promise
+        // must be set either way, or the objects waiting on it never resolve.
+        std::shared_ptr<ModelData> modelData;
+        try
+        {
+            modelData = load();
+        }
+        catch (const std::exception& e)
+        {
+            std::cerr << "ERROR: Loading model " + key + " failed: " + e.what() + "\n";
+        }
+        catch (...)
+        {
+            std::cerr << "ERROR: Loading model " + key + " failed\n";
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            loading.erase(key);
+        }
+        promise->set_value(modelData);
+    };
+
+    // Without worker threads nothing would pick the job up.
+    JobSystem& jobs = JobSystem::getInstance();
+    if (jobs.getThreadCount() > 1)
+    {
+        jobs.scheduleBackground(job);
+    }
+    else
+    {
+        job();
+    }
+
+    return future;
+}
+
+std::shared_ptr<ModelData> ModelCache::loadCooked(const std::string& key, const std::string& sourcePath,
+    const std::string& arrayName, unsigned int stride)
+{
+    std::string cookedPath = MeshFile::getCookedPath(sourcePath, arrayName);
+
+    std::error_code error;
+    if (!std::filesystem::exists(cookedPath, error))
+    {
+        return nullptr;
+    }
+
+    // A missing source is fine (shipping only cooked files), a newer one is not.
+    if (std::filesystem::exists(sourcePath, error) &&
+        std::filesystem::last_write_time(sourcePath, error) > std::filesystem::last_write_time(cookedPath, error))
+    {
+        std::cout << "Cooked mesh is older than its source, ignoring: " << cookedPath << "\n";
+        return nullptr;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::shared_ptr<ModelData> modelData = MeshFile::load(cookedPath, stride);
+    if (!modelData)
+    {
+        return nullptr;
+    }
+    modelData->key = key;
+
+    double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    // Formatted separately: loads run on several threads and cout's flags are shared.
+    std::ostringstream message;
+    message << "Model mapped: " << cookedPath << " (" << modelData->vertexCount << " vertices, "
+        << std::fixed << std::setprecision(3) << milliseconds << " ms)\n";
+    std::cout << message.str();
+
+    return modelData;
+}
+
+std::shared_ptr<ModelData> ModelCache::createModelData(const std::string& key, std::vector<float>& vertices, unsigned int stride)
+{
+    // glDrawArrays ignored a trailing partial triangle, so drop it before indexing
+    unsigned int sourceVertexCount = static_cast<unsigned int>(vertices.size() / stride);
+    sourceVertexCount -= sourceVertexCount % 3;
+    vertices.resize(static_cast<size_t>(sourceVertexCount) * stride);
+
+    std::vector<float> welded;
+    std::vector<uint32_t> indices;
+    MeshOptimizer::weld(vertices, stride, welded, indices);
+
+    const size_t weldedCount = welded.size() / stride;
+    float acmrBefore = MeshOptimizer::computeACMR(indices, weldedCount);
+
+    MeshOptimizer::optimizeVertexCache(indices, weldedCount);
+    MeshOptimizer::optimizeOverdraw(indices, welded, stride);
+    MeshOptimizer::optimizeVertexFetch(welded, stride, indices);
+
+    float acmrAfter = MeshOptimizer::computeACMR(indices, welded.size() / stride);
+
+    auto modelData = std::make_shared<ModelData>(std::move(welded), static_cast<unsigned int>(weldedCount), stride);
+    modelData->key = key;
+    modelData->indices = std::move(indices);
+    modelData->sourceVertexCount = sourceVertexCount;
+
+    std::ostringstream message;
+    message << "Model indexed: " << key << " (" << sourceVertexCount << " -> "
+        << modelData->vertexCount << " vertices, ACMR " << std::fixed << std::setprecision(2)
+        << acmrBefore << " -> " << acmrAfter << ")\n";
+    std::cout << message.str();
+
+    return modelData;
+}
+
 ModelCache& ModelCache::getInstance()
 {
     if (!instance)
@@ -32,10 +234,17 @@ std::shared_ptr<ModelData> ModelCache::loadModel(const std::string& filePath, co
 {
     std::string key = generateKey(filePath, arrayName);
 
-    auto it = cache.find(key);
-    if (it != cache.end())
+    if (std::shared_ptr<ModelData> cached = find(key))
+    {
+        return cached;
+    }
+
+    unsigned int stride = 6;
+
+    std::shared_ptr<ModelData> cooked = loadCooked(key, filePath, arrayName, stride);
+    if (cooked)
     {
-        return it->second;
+        return insert(key, cooked);
     }
 
     std::vector<float> vertices = loader.loadFromHeader(filePath, arrayName);
@@ -45,33 +254,33 @@ std::shared_ptr<ModelData> ModelCache::loadModel(const std::string& filePath, co
         return nullptr;
     }
 
-    unsigned int stride = 6;
-    unsigned int vertexCount = vertices.size() / stride;
-
     if (vertices.size() % stride != 0)
     {
         std::cerr << "WARNING: Vertex data size not perfectly divisible by " << stride << "\n";
     }
 
-    auto modelData = std::make_shared<ModelData>(vertices, vertexCount, stride);
-    cache[key] = modelData;
-
-    return modelData;
+    auto modelData = createModelData(key, vertices, stride);
+    return insert(key, modelData);
 }
 
 std::shared_ptr<ModelData> ModelCache::loadModelFromText(const std::string& filePath)
 {
     std::string key = "text:" + filePath;
 
-    auto it = cache.find(key);
-    if (it != cache.end())
+    if (std::shared_ptr<ModelData> cached = find(key))
     {
         std::cout << "\nModel cache HIT: " << key << "\n";
-        return it->second;
+        return cached;
     }
 
     std::cout << "\nModel cache MISS: " << key << " - loading from text...\n";
 
+    std::shared_ptr<ModelData> cooked = loadCooked(key, filePath, "", 8);
+    if (cooked)
+    {
+        return insert(key, cooked);
+    }
+
     std::vector<float> vertices = loader.loadFromText(filePath);
 
     if (vertices.empty())
@@ -80,27 +289,33 @@ std::shared_ptr<ModelData> ModelCache::loadModelFromText(const std::string& file
         return nullptr;
     }
 
-    auto modelData = std::make_shared<ModelData>(vertices, vertices.size(), 8);
-    cache[key] = modelData;
+    auto modelData = createModelData(key, vertices, 8);
 
     std::cout << "Model cached: " << key << " (" << modelData->vertexCount << " vertices)" << std::endl;
 
-    return modelData;
+    return insert(key, modelData);
 }
 
 std::shared_ptr<ModelData> ModelCache::loadModelFromOBJ(const std::string& filePath)
 {
     std::string key = "obj:" + filePath;
 
-    auto it = cache.find(key);
-    if (it != cache.end())
+    if (std::shared_ptr<ModelData> cached = find(key))
     {
         std::cout << "\nModel cache HIT: " << key << "\n";
-        return it->second;
+        return cached;
     }
 
     std::cout << "\nModel cache MISS: " << key << " - loading from OBJ...\n";
 
+    unsigned int stride = 8;
+
+    std::shared_ptr<ModelData> cooked = loadCooked(key, filePath, "", stride);
+    if (cooked)
+    {
+        return insert(key, cooked);
+    }
+
     std::vector<float> vertices = loader.loadFromOBJ(filePath);
 
     if (vertices.empty())
@@ -109,41 +324,70 @@ std::shared_ptr<ModelData> ModelCache::loadModelFromOBJ(const std::string& fileP
         return nullptr;
     }
 
-    unsigned int stride = 8;
-    unsigned int vertexCount = vertices.size() / stride;
-
     if (vertices.size() % stride != 0)
     {
         std::cerr << "WARNING: Vertex data size not perfectly divisible by " << stride
             << " (size: " << vertices.size() << ")\n";
     }
 
-    auto modelData = std::make_shared<ModelData>(vertices, vertexCount, stride);
-    cache[key] = modelData;
+    auto modelData = createModelData(key, vertices, stride);
 
-    std::cout << "Model cached: " << key << " (" << vertexCount << " vertices)\n";
-    return modelData;
+    std::cout << "Model cached: " << key << " (" << modelData->vertexCount << " vertices)\n";
+    return insert(key, modelData);
+}
+
+ModelFuture ModelCache::loadModelAsync(const std::string& filePath, const std::string& arrayName)
+{
+    return loadAsync(generateKey(filePath, arrayName),
+        [this, filePath, arrayName] { return loadModel(filePath, arrayName); });
+}
+
+ModelFuture ModelCache::loadModelFromTextAsync(const std::string& filePath)
+{
+    return loadAsync("text:" + filePath, [this, filePath] { return loadModelFromText(filePath); });
+}
+
+ModelFuture ModelCache::loadModelFromOBJAsync(const std::string& filePath)
+{
+    return loadAsync("obj:" + filePath, [this, filePath] { return loadModelFromOBJ(filePath); });
 }
 
 void ModelCache::clear()
 {
+    std::lock_guard<std::mutex> lock(mutex);
     cache.clear();
     std::cout << "Model cache cleared\n";
 }
 
 void ModelCache::printStats() const
 {
+    size_t totalSourceVertices = 0;
     size_t totalVertices = 0;
+    size_t totalSourceBytes = 0;
     size_t totalBytes = 0;
 
+    std::lock_guard<std::mutex> lock(mutex);
+
+    std::cout << "\n=== Model Cache ===\n";
+
     for (const auto& pair : cache)
     {
-        totalVertices += pair.second->vertexCount;
-        totalBytes += pair.second->vertices.size() * sizeof(float);
+        const ModelData& data = *pair.second;
+
+        std::cout << pair.first << ": " << data.sourceVertexCount << " -> " << data.vertexCount
+            << " vertices, " << data.getIndexCount() << " indices ("
+            << data.getIndexSize() * 8 << "-bit), "
+            << data.getSourceBytes() / 1024 << " KB -> " << data.getBytes() / 1024 << " KB"
+            << (data.isMapped() ? " (mapped)" : "") << "\n";
+
+        totalSourceVertices += data.sourceVertexCount;
+        totalVertices += data.vertexCount;
+        totalSourceBytes += data.getSourceBytes();
+        totalBytes += data.getBytes();
     }
 
-    std::cout << "Total vertices: " << totalVertices << "\n";
-    std::cout << "Total memory: " << totalBytes / 1024 << " KB\n";
+    std::cout << "Total vertices: " << totalSourceVertices << " -> " << totalVertices << "\n";
+    std::cout << "Total memory: " << totalSourceBytes / 1024 << " KB -> " << totalBytes / 1024 << " KB\n";
     std::cout << "========================\n";
 }
 
@@ -3,35 +3,95 @@
 #include <vector>
 #include <map>
 #include <memory>
+#include <mutex>
+#include <future>
+#include <functional>
+#include <cstdint>
 #include "ModelLoader.h"
+#include "BoundingVolume.h"
+#include "MappedFile.h"
 
 struct ModelData
 {
+    std::string key;
     std::vector<float> vertices;
+    std::vector<uint32_t> indices;
+
+    // Set when the data comes from a cooked .mesh file. The vectors stay
+    // empty; vertices and indices (already at getIndexSize() width) are read
+    // straight from the mapping.
+    std::shared_ptr<MappedFile> mapping;
+    const float* mappedVertices;
+    const void* mappedIndices;
+    size_t mappedIndexCount;
+
     unsigned int vertexCount;
     unsigned int stride;
+    unsigned int sourceVertexCount;
+    BoundingBox bounds;
+    BoundingSphere sphere;
+
+    ModelData(std::vector<float> verts, unsigned int count, unsigned int str);
+    // Bounds are not computed here; the caller copies them from the file.
+    ModelData(std::shared_ptr<MappedFile> file, const float* verts, unsigned int count, unsigned int str,
+        const void* inds, size_t indexCount);
+
+    void computeBounds();
+
+    bool isMapped() const { return mapping != nullptr; }
+    const float* getVertexData() const { return isMapped() ? mappedVertices : vertices.data(); }
+    size_t getFloatCount() const { return static_cast<size_t>(vertexCount) * stride; }
+    size_t getIndexCount() const { return isMapped() ? mappedIndexCount : indices.size(); }
 
-    ModelData(const std::vector<float>& verts, unsigned int count, unsigned int str);
+    bool isIndexed() const { return getIndexCount() > 0; }
+    size_t getIndexSize() const { return vertexCount > 0xFFFF ? sizeof(uint32_t) : sizeof(uint16_t); }
+    size_t getSourceBytes() const { return static_cast<size_t>(sourceVertexCount) * stride * sizeof(float); }
+    size_t getBytes() const { return getFloatCount() * sizeof(float) + getIndexCount() * getIndexSize(); }
 };
 
+// Resolves to nullptr when the model could not be loaded.
+typedef std::shared_future<std::shared_ptr<ModelData>> ModelFuture;
+
+// Loads may run on several threads at once; the cache itself is guarded by
+// a mutex, parsing happens outside of it.
 class ModelCache
 {
 private:
     static ModelCache* instance;
     std::map<std::string, std::shared_ptr<ModelData>> cache;
+    std::map<std::string, ModelFuture> loading;
+    mutable std::mutex mutex;
     ModelLoader loader;
 
     ModelCache();
     std::string generateKey(const std::string& filePath, const std::string& arrayName) const;
+    std::shared_ptr<ModelData> find(const std::string& key) const;
+    // Returns the model already cached under key if another thread got there first.
+    std::shared_ptr<ModelData> insert(const std::string& key, std::shared_ptr<ModelData> modelData);
+    ModelFuture loadAsync(const std::string& key, std::function<std::shared_ptr<ModelData>()> load);
+    // Maps the cooked form of a source file if it exists and is not older
+    // than the source.
+    std::shared_ptr<ModelData> loadCooked(const std::string& key, const std::string& sourcePath,
+        const std::string& arrayName, unsigned int stride);
 
 public:
     ~ModelCache();
 
     static ModelCache& getInstance();
+    // Welds and optimizes a raw triangle list. Shared with the offline mesh
+    // converter so cooked files match what loading the source produces.
+    static std::shared_ptr<ModelData> createModelData(const std::string& key, std::vector<float>& vertices, unsigned int stride);
+
     std::shared_ptr<ModelData> loadModel(const std::string& filePath, const std::string& arrayName);
     std::shared_ptr<ModelData> loadModelFromText(const std::string& filePath);
     std::shared_ptr<ModelData> loadModelFromOBJ(const std::string& filePath);
+
+    // Same as above, but parsing and optimization run on the job system.
+    // Concurrent requests for one model share a single load.
+    ModelFuture loadModelAsync(const std::string& filePath, const std::string& arrayName);
+    ModelFuture loadModelFromTextAsync(const std::string& filePath);
+    ModelFuture loadModelFromOBJAsync(const std::string& filePath);
     void clear();
     void printStats() const;
     static void destroy();
-};
\ No newline at end of file
+};
@@ -1,12 +1,32 @@
 #include "ModelLoader.h"
-#include <fstream>
-#include <sstream>
+#include "FloatParser.h"
+#include "MappedFile.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iomanip>
 #include <iostream>
-#include <cctype>
+#include <sstream>
 #include <glm/ext/vector_float2.hpp>
 
 #include "tiny_obj_loader.h"
 
+namespace
+{
+    void reportThroughput(const std::string& filePath, size_t bytes, std::chrono::steady_clock::time_point start)
+    {
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        double megabytes = bytes / (1024.0 * 1024.0);
+
+        // Loads can run on several threads, so cout's format flags stay untouched.
+        std::ostringstream message;
+        message << "ModelLoader: Parsed " << filePath << " (" << std::fixed << std::setprecision(2)
+            << megabytes << " MB in " << seconds * 1000.0 << " ms, "
+            << (seconds > 0.0 ? megabytes / seconds : 0.0) << " MB/s)\n";
+        std::cout << message.str();
+    }
+}
+
 ModelLoader::ModelLoader()
 {
 }
@@ -17,84 +37,71 @@ ModelLoader::~ModelLoader()
 
 std::vector<float> ModelLoader::loadFromHeader(const std::string& filePath, const std::string& arrayName)
 {
-    std::string content = readFile(filePath);
-
-    if (content.empty())
+    MappedFile file;
+    if (!file.open(filePath))
     {
+        std::cerr << "ERROR: Could not open file: " << filePath << std::endl;
         return std::vector<float>();
     }
 
-    return parseFloatArray(content, arrayName);
+    auto start = std::chrono::steady_clock::now();
+
+    std::string_view content(reinterpret_cast<const char*>(file.data()), file.size());
+    std::vector<float> vertices = parseFloatArray(content, arrayName);
+
+    reportThroughput(filePath, file.size(), start);
+    return vertices;
 }
 
 std::vector<float> ModelLoader::loadFromText(const std::string& filePath)
 {
     std::cout << "ModelLoader: Loading from text file: " << filePath << std::endl;
 
-    std::ifstream file(filePath);
-    if (!file.is_open()) {
+    MappedFile file;
+    if (!file.open(filePath)) {
         std::cerr << "ERROR: Could not open file: " << filePath << std::endl;
         return std::vector<float>();
     }
 
+    auto start = std::chrono::steady_clock::now();
+
+    const char* p = reinterpret_cast<const char*>(file.data());
+    const char* end = p + file.size();
+
+    // One vertex per line; reserve for the worst case of every line being one.
     std::vector<float> vertices;
-    std::string line;
+    vertices.reserve((std::count(p, end, '\n') + 1) * 8);
+
     int lineNumber = 0;
 
-    while (std::getline(file, line)) {
+    while (p < end) {
+        const char* newline = static_cast<const char*>(std::memchr(p, '\n', end - p));
+        const char* lineEnd = newline ? newline : end;
+        std::string_view line(p, lineEnd - p);
+        p = newline ? newline + 1 : end;
         lineNumber++;
 
+        if (!line.empty() && line.back() == '\r') {
+            line.remove_suffix(1);
+        }
+
         if (line.empty() || line[0] == '#') {
             continue;
         }
 
-        std::string cleaned;
-        for (char c : line) {
-            if (c == 'f' || c == 'F') {
-                continue;
-            }
-            else if (c == ',') {
-                cleaned += ' ';
-            }
-            else {
-                cleaned += c;
-            }
-        }
+        // x y z nx ny nz [u v]; a missing texture coordinate becomes 0, 0.
+        float values[8] = {};
+        size_t count = FloatParser::parse(line, values, 8);
 
-        std::istringstream iss(cleaned);
-        float x, y, z, nx, ny, nz;
-        float u = 0.0f, v = 0.0f;
-
-        if (iss >> x >> y >> z >> nx >> ny >> nz >> u >> v) {
-            vertices.push_back(x);
-            vertices.push_back(y);
-            vertices.push_back(z);
-            vertices.push_back(nx);
-            vertices.push_back(ny);
-            vertices.push_back(nz);
-            vertices.push_back(u);
-            vertices.push_back(v);
+        if (count >= 6) {
+            vertices.insert(vertices.end(), values, values + 8);
         }
         else {
-            iss.clear();
-            iss.seekg(0);
-            if (iss >> x >> y >> z >> nx >> ny >> nz) {
-                vertices.push_back(x);
-                vertices.push_back(y);
-                vertices.push_back(z);
-                vertices.push_back(nx);
-                vertices.push_back(ny);
-                vertices.push_back(nz);
-                vertices.push_back(0.0f);
-                vertices.push_back(0.0f);
-            }
-            else {
-                std::cerr << "WARNING: Invalid format at line " << lineNumber << ": " << line << std::endl;
-            }
+            std::cerr << "WARNING: Invalid format at line " << lineNumber << ": " << line << std::endl;
         }
     }
 
-    file.close();
+    reportThroughput(filePath, file.size(), start);
 
     std::cout << "ModelLoader: Loaded " << (vertices.size() / 8) << " vertices from text file (stride: 8)" << std::endl;
 
@@ -179,69 +186,39 @@ std::vector<float> ModelLoader::loadFromOBJ(const std::string& filePath)
     return vertices;
 }
 
-std::string ModelLoader::readFile(const std::string& filePath)
-{
-    std::ifstream file(filePath);
-
-    if (!file.is_open()) {
-        std::cerr << "ERROR: Could not open file: " << filePath << std::endl;
-        return "";
-    }
-
-    std::stringstream buffer;
-    buffer << file.rdbuf();
-
-    file.close();
-
-    return buffer.str();
-}
-
-std::vector<float> ModelLoader::parseFloatArray(const std::string& content, const std::string& arrayName)
+std::vector<float> ModelLoader::parseFloatArray(std::string_view content, const std::string& arrayName)
 {
     std::vector<float> result;
 
     size_t arrayPos = content.find(arrayName);
-    if (arrayPos == std::string::npos)
+    if (arrayPos == std::string_view::npos)
     {
         std::cerr << "ERROR: Array '" << arrayName << "' not found in file\n";
         return result;
     }
 
     size_t openBrace = content.find('{', arrayPos);
-    if (openBrace == std::string::npos)
+    if (openBrace == std::string_view::npos)
     {
         std::cerr << "ERROR: Could not find opening brace\n";
         return result;
     }
 
     size_t closeBrace = content.find('}', openBrace);
-    if (closeBrace == std::string::npos)
+    if (closeBrace == std::string_view::npos)
     {
         std::cerr << "ERROR: Could not find closing brace\n";
         return result;
     }
 
-    std::string arrayContent = content.substr(openBrace + 1, closeBrace - openBrace - 1);
+    std::string_view arrayContent = content.substr(openBrace + 1, closeBrace - openBrace - 1);
 
-    std::stringstream ss(arrayContent);
-    std::string token;
-
-    while (ss >> token)
+    size_t rejected = FloatParser::parseAll(arrayContent, result);
+    if (rejected > 0)
     {
-        if (token.empty() || token == ",")
-            continue;
-
-        try
-        {
-            float value = std::stof(token);
-            result.push_back(value);
-        }
-        catch (const std::exception& e)
-        {
-            std::cerr << "WARNING: Could not parse '" << token << "' as float\n";
-        }
+        std::cerr << "WARNING: " << rejected << " tokens in '" << arrayName << "' could not be parsed as float\n";
     }
 
     std::cout << "\nLoaded array '" << arrayName << "': " << result.size() << " floats\n";
     return result;
-}
\ No newline at end of file
+}
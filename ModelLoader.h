@@ -1,5 +1,6 @@
 #pragma once
 #include <string>
+#include <string_view>
 #include <vector>
 #include <glm/vec3.hpp>
 
@@ -14,6 +15,5 @@ public:
     std::vector<float> loadFromOBJ(const std::string& filePath);
 
 private:
-    std::string readFile(const std::string& filePath);
-    std::vector<float> parseFloatArray(const std::string& content, const std::string& arrayName);
+    std::vector<float> parseFloatArray(std::string_view content, const std::string& arrayName);
 };
\ No newline at end of file
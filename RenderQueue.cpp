@@ -0,0 +1,40 @@
+#include "RenderQueue.h"
+#include <algorithm>
+
+uint64_t RenderQueue::makeKey(GLuint program, GLuint texture, GLuint mesh, float viewDepth, float farPlane)
+{
+    const uint64_t depthMax = (1u << 24) - 1;
+
+    float normalizedDepth = farPlane > 0.0f ? viewDepth / farPlane : 0.0f;
+    normalizedDepth = std::min(std::max(normalizedDepth, 0.0f), 1.0f);
+    uint64_t depth = static_cast<uint64_t>(normalizedDepth * static_cast<float>(depthMax));
+
+    return (static_cast<uint64_t>(program & 0xFFF) << 52) |
+        (static_cast<uint64_t>(texture & 0xFFF) << 40) |
+        (static_cast<uint64_t>(mesh & 0xFFFF) << 24) |
+        depth;
+}
+
+void RenderQueue::clear()
+{
+    items.clear();
+    order.clear();
+}
+
+void RenderQueue::reserve(size_t count)
+{
+    items.reserve(count);
+    order.reserve(count);
+}
+
+void RenderQueue::push(const RenderItem& item, uint64_t key)
+{
+    order.push_back({ key, static_cast<uint32_t>(items.size()) });
+    items.push_back(item);
+}
+
+void RenderQueue::sort()
+{
+    std::sort(order.begin(), order.end(),
+        [](const SortEntry& a, const SortEntry& b) { return a.key < b.key; });
+}
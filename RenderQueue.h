@@ -0,0 +1,50 @@
+#pragma once
+#include <GL/glew.h>
+#include <cstdint>
+#include <vector>
+#include <glm/mat3x3.hpp>
+#include <glm/mat4x4.hpp>
+
+class DrawableObject;
+class ShaderProgram;
+
+struct RenderItem
+{
+    DrawableObject* object;
+    glm::mat4 modelMatrix;
+    glm::mat3 normalMatrix;
+    // Variant of the object's shader drawn this frame.
+    ShaderProgram* shader;
+    // Whether the spotlight's cone reaches the object.
+    bool spotlight;
+};
+
+// Collects the visible objects of a frame and orders them by a 64-bit key:
+//   [63..52] program  [51..40] texture  [39..24] mesh  [23..0] view depth
+// so that objects sharing GL state are submitted together and, within the
+// same state, front to back.
+class RenderQueue
+{
+private:
+    struct SortEntry
+    {
+        uint64_t key;
+        uint32_t index;
+    };
+
+    std::vector<RenderItem> items;
+    std::vector<SortEntry> order;
+
+public:
+    static uint64_t makeKey(GLuint program, GLuint texture, GLuint mesh, float viewDepth, float farPlane);
+
+    void clear();
+    void reserve(size_t count);
+    void push(const RenderItem& item, uint64_t key);
+    void sort();
+
+    size_t size() const { return order.size(); }
+    bool empty() const { return order.empty(); }
+    const RenderItem& operator[](size_t i) const { return items[order[i].index]; }
+    uint64_t getKey(size_t i) const { return order[i].key; }
+};
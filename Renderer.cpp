@@ -0,0 +1,390 @@
+#include "Renderer.h"
+#include "ShaderProgram.h"
+#include "MeshUploadQueue.h"
+#include "TextureUploadQueue.h"
+#include "ShaderVariantCache.h"
+#include <cstddef>
+#include <iostream>
+
+namespace
+{
+    // About 1 ms of PCIe transfer on a slow system.
+    const size_t DEFAULT_TEXTURE_UPLOAD_BUDGET = 4 * 1024 * 1024;
+    // Objects draw with the generic program of their shader until their
+    // variant is in, so compiling can be spread over frames.
+    const double SHADER_COMPILE_BUDGET = 0.004;
+}
+
+Renderer::Renderer(GLFWwindow* window)
+    : window(window),
+    uploadedCameraVersion(0),
+    uploadedLightVersion(0),
+    writeIndex(0),
+    readIndex(0),
+    running(false),
+    stopping(false),
+    viewportDirty(false),
+    viewportWidth(0),
+    viewportHeight(0),
+    uploadBudget(0.002),
+    textureUploadBudget(DEFAULT_TEXTURE_UPLOAD_BUDGET)
+{
+    states[0] = SNAPSHOT_FREE;
+    states[1] = SNAPSHOT_FREE;
+
+    frameBuffer = std::make_unique<UniformBuffer>(FRAME_BLOCK_BINDING, sizeof(FrameBlock));
+    lightBuffer = std::make_unique<UniformBuffer>(LIGHT_BLOCK_BINDING, sizeof(LightBlock));
+    lightDataBuffer = std::make_unique<TextureBuffer>(LIGHT_DATA_TEXTURE_UNIT, GL_RGBA32F);
+    lightClusterBuffer = std::make_unique<TextureBuffer>(LIGHT_CLUSTER_TEXTURE_UNIT, GL_RG32UI);
+    lightIndexBuffer = std::make_unique<TextureBuffer>(LIGHT_INDEX_TEXTURE_UNIT, GL_R32UI);
+    objectLightIndexBuffer = std::make_unique<TextureBuffer>(OBJECT_LIGHT_INDEX_TEXTURE_UNIT, GL_R32UI);
+    instanceBuffer = std::make_unique<InstanceBuffer>();
+}
+
+Renderer::~Renderer()
+{
+    stop();
+}
+
+void Renderer::start()
+{
+    if (running)
+    {
+        return;
+    }
+
+    glfwMakeContextCurrent(nullptr);
+
+    stopping = false;
+    running = true;
+    renderThread = std::thread(&Renderer::renderLoop, this);
+    renderThreadID = renderThread.get_id();
+
+    std::cout << "Renderer: render thread started" << std::endl;
+}
+
+void Renderer::stop()
+{
+    if (!running)
+    {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    frameCondition.notify_all();
+
+    renderThread.join();
+    running = false;
+    renderThreadID = std::thread::id();
+
+    glfwMakeContextCurrent(window);
+
+    std::cout << "Renderer: render thread stopped" << std::endl;
+}
+
+void Renderer::renderLoop()
+{
+    glfwMakeContextCurrent(window);
+
+    while (true)
+    {
+        std::vector<std::function<void()>> pending;
+        FrameSnapshot* frame = nullptr;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            frameCondition.wait(lock, [this] {
+                return stopping || !tasks.empty() || states[readIndex] == SNAPSHOT_READY;
+            });
+
+            pending.swap(tasks);
+            if (states[readIndex] == SNAPSHOT_READY)
+            {
+                frame = &snapshots[readIndex];
+            }
+            else if (stopping && pending.empty())
+            {
+                break;
+            }
+        }
+
+        runTasks(pending);
+
+        if (frame != nullptr)
+        {
+            present(*frame);
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                states[readIndex] = SNAPSHOT_FREE;
+                readIndex ^= 1;
+            }
+            frameCondition.notify_all();
+        }
+    }
+
+    glfwMakeContextCurrent(nullptr);
+}
+
+void Renderer::runTasks(std::vector<std::function<void()>>& pending)
+{
+    for (auto& task : pending)
+    {
+        task();
+    }
+}
+
+void Renderer::present(FrameSnapshot& frame)
+{
+    double start = glfwGetTime();
+
+    // Meshes, textures and shader variants made ready now are picked up by
+    // the scene from the next frame on.
+    MeshUploadQueue::getInstance().process(uploadBudget);
+    TextureUploadQueue::getInstance().process(textureUploadBudget);
+    ShaderVariantCache::getInstance().process(SHADER_COMPILE_BUDGET);
+
+    render(frame);
+    glfwSwapBuffers(window);
+
+    // The previous frame's batches are dropped on the thread that may
+    // delete their meshes.
+    pickBatches.clear();
+    for (const DrawCommand& draw : frame.draws) {
+        if (draw.instanceCount > 1) {
+            pickBatches.push_back({ draw.shader->getID(), draw.model, draw.firstInstance, draw.instanceCount });
+        }
+    }
+    pickStencilValues.swap(frame.stencilValues);
+
+    // Drops the mesh references on the thread that may delete them.
+    frame.clear();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    stats.frames++;
+    stats.renderTime += glfwGetTime() - start;
+}
+
+FrameSnapshot& Renderer::beginFrame()
+{
+    if (!running)
+    {
+        snapshots[0].clear();
+        return snapshots[0];
+    }
+
+    double start = glfwGetTime();
+
+    std::unique_lock<std::mutex> lock(mutex);
+    frameCondition.wait(lock, [this] { return states[writeIndex] == SNAPSHOT_FREE; });
+    states[writeIndex] = SNAPSHOT_WRITING;
+    stats.waitTime += glfwGetTime() - start;
+
+    snapshots[writeIndex].clear();
+    return snapshots[writeIndex];
+}
+
+void Renderer::submitFrame()
+{
+    if (!running)
+    {
+        present(snapshots[0]);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        states[writeIndex] = SNAPSHOT_READY;
+        writeIndex ^= 1;
+    }
+    frameCondition.notify_all();
+}
+
+void Renderer::render(const FrameSnapshot& frame)
+{
+    if (viewportDirty.exchange(false))
+    {
+        glViewport(0, 0, viewportWidth, viewportHeight);
+    }
+
+    clear();
+
+    if (frame.scene == nullptr)
+    {
+        return;
+    }
+
+    // Versions are unique across scenes, so a scene switch forces a full upload.
+    if (frame.cameraVersion != uploadedCameraVersion)
+    {
+        frameBuffer->update(&frame.frameBlock, sizeof(FrameBlock));
+        uploadedCameraVersion = frame.cameraVersion;
+    }
+    else
+    {
+        frameBuffer->update(&frame.frameBlock.time, sizeof(float), offsetof(FrameBlock, time));
+    }
+    frameBuffer->bind();
+
+    if (frame.lightVersion != uploadedLightVersion)
+    {
+        lightBuffer->update(&frame.lightBlock, sizeof(LightBlock));
+        lightDataBuffer->update(frame.lights.data(), frame.lights.size() * sizeof(LightData));
+        lightClusterBuffer->update(frame.lightClusters.data(), frame.lightClusters.size() * sizeof(glm::uvec2));
+        lightIndexBuffer->update(frame.lightIndices.data(), frame.lightIndices.size() * sizeof(uint32_t));
+        uploadedLightVersion = frame.lightVersion;
+    }
+    lightBuffer->bind();
+    lightDataBuffer->bind();
+    lightClusterBuffer->bind();
+    lightIndexBuffer->bind();
+
+    // Object lists follow the objects as well as the lights, so they are
+    // sent every frame like the instances.
+    objectLightIndexBuffer->update(frame.objectLightIndices.data(),
+        frame.objectLightIndices.size() * sizeof(uint32_t));
+    objectLightIndexBuffer->bind();
+
+    instanceBuffer->upload(frame.instances);
+
+    glEnable(GL_STENCIL_TEST);
+    glStencilOp(GL_KEEP, GL_KEEP, GL_REPLACE);
+
+    ShaderProgram* currentShader = nullptr;
+    GLuint currentTexture = 0;
+
+    for (const DrawCommand& draw : frame.draws) {
+        if (draw.shader != currentShader) {
+            draw.shader->use();
+            currentShader = draw.shader;
+        }
+
+        bool hasTexture = draw.texture != 0;
+        if (hasTexture && draw.texture != currentTexture) {
+            glActiveTexture(GL_TEXTURE0);
+            glBindTexture(GL_TEXTURE_2D, draw.texture);
+            currentTexture = draw.texture;
+        }
+
+        draw.model.bind();
+        instanceBuffer->bindAttributes(draw.firstInstance);
+
+        glStencilFunc(GL_ALWAYS, draw.stencilValue, 0xFF);
+
+        // Variants are compiled for textured or untextured drawing.
+        if (draw.shader->hasUniform(UniformID::UseTexture)) {
+            draw.shader->setUniform(UniformID::UseTexture, hasTexture ? 1 : 0);
+        }
+        if (hasTexture) {
+            draw.shader->setUniform(UniformID::TextureUnit, 0);
+        }
+
+        draw.model.drawInstancedBound(draw.instanceCount);
+    }
+
+    glBindVertexArray(0);
+    if (currentTexture != 0) {
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+    if (currentShader != nullptr) {
+        currentShader->unuse();
+    }
+
+    glDisable(GL_STENCIL_TEST);
+}
+
+void Renderer::pick(GLint x, GLint y, GLfloat& depth, GLuint& stencilValue)
+{
+    // The instance buffer and depth buffer still hold the last frame. Only
+    // the fragments that ended up in front pass the depth test again.
+    glEnable(GL_SCISSOR_TEST);
+    glScissor(x, y, 1, 1);
+    glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+    glDepthMask(GL_FALSE);
+    glDepthFunc(GL_LEQUAL);
+    glEnable(GL_STENCIL_TEST);
+    glStencilOp(GL_KEEP, GL_KEEP, GL_REPLACE);
+
+    for (const PickBatch& batch : pickBatches) {
+        if (!glIsProgram(batch.program)) {
+            continue;
+        }
+
+        glUseProgram(batch.program);
+        batch.model.bind();
+        for (GLsizei i = 0; i < batch.instanceCount; i++) {
+            instanceBuffer->bindAttributes(batch.firstInstance + i);
+            glStencilFunc(GL_ALWAYS, pickStencilValues[batch.firstInstance + i], 0xFF);
+            batch.model.drawInstancedBound(1);
+        }
+    }
+
+    glBindVertexArray(0);
+    glUseProgram(0);
+    glDisable(GL_STENCIL_TEST);
+    glDepthFunc(GL_LESS);
+    glDepthMask(GL_TRUE);
+    glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+    glDisable(GL_SCISSOR_TEST);
+
+    glReadPixels(x, y, 1, 1, GL_DEPTH_COMPONENT, GL_FLOAT, &depth);
+    glReadPixels(x, y, 1, 1, GL_STENCIL_INDEX, GL_UNSIGNED_INT, &stencilValue);
+}
+
+void Renderer::clear()
+{
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+}
+
+void Renderer::setViewport(int width, int height)
+{
+    viewportWidth = width;
+    viewportHeight = height;
+    viewportDirty = true;
+}
+
+void Renderer::enqueue(std::function<void()> task)
+{
+    if (!running)
+    {
+        task();
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        tasks.push_back(std::move(task));
+    }
+    frameCondition.notify_all();
+}
+
+void Renderer::invoke(const std::function<void()>& task)
+{
+    if (!running || std::this_thread::get_id() == renderThreadID)
+    {
+        task();
+        return;
+    }
+
+    bool done = false;
+    enqueue([this, &task, &done] {
+        task();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            done = true;
+        }
+        frameCondition.notify_all();
+    });
+
+    std::unique_lock<std::mutex> lock(mutex);
+    frameCondition.wait(lock, [&done] { return done; });
+}
+
+RenderStats Renderer::getStats()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    RenderStats result = stats;
+    stats = RenderStats();
+    return result;
+}
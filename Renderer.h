@@ -1,16 +1,125 @@
 #pragma once
-#include "SceneManager.h"
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "FrameSnapshot.h"
+#include "UniformBuffer.h"
+#include "TextureBuffer.h"
+#include "InstanceBuffer.h"
 
+struct RenderStats
+{
+    size_t frames;
+    double renderTime;
+    double waitTime;
+
+    RenderStats() : frames(0), renderTime(0.0), waitTime(0.0) {}
+};
+
+// Submits frame snapshots to OpenGL. Once started, a render thread owns the
+// GL context and draws frame N while the simulation thread builds frame
+// N + 1 into the other snapshot. Any other GL work (loading, picking,
+// deleting GL objects) has to go through enqueue() or invoke().
+// When the thread is not running, submitted frames are drawn immediately
+// on the calling thread.
 class Renderer
 {
 private:
-    SceneManager* sceneManager;
+    GLFWwindow* window;
+
+    std::unique_ptr<UniformBuffer> frameBuffer;
+    std::unique_ptr<UniformBuffer> lightBuffer;
+    std::unique_ptr<TextureBuffer> lightDataBuffer;
+    std::unique_ptr<TextureBuffer> lightClusterBuffer;
+    std::unique_ptr<TextureBuffer> lightIndexBuffer;
+    std::unique_ptr<TextureBuffer> objectLightIndexBuffer;
+    std::unique_ptr<InstanceBuffer> instanceBuffer;
+    unsigned int uploadedCameraVersion;
+    unsigned int uploadedLightVersion;
+
+    enum SnapshotState { SNAPSHOT_FREE, SNAPSHOT_WRITING, SNAPSHOT_READY };
+
+    FrameSnapshot snapshots[2];
+    SnapshotState states[2];
+    int writeIndex;
+    int readIndex;
+
+    std::vector<std::function<void()>> tasks;
+
+    std::thread renderThread;
+    std::thread::id renderThreadID;
+    bool running;
+    bool stopping;
+    std::mutex mutex;
+    std::condition_variable frameCondition;
+
+    std::atomic<bool> viewportDirty;
+    std::atomic<int> viewportWidth;
+    std::atomic<int> viewportHeight;
+
+    // Seconds per frame spent creating buffers for streamed-in meshes.
+    std::atomic<double> uploadBudget;
+    // Bytes of texel data streamed into textures per frame.
+    std::atomic<size_t> textureUploadBudget;
+
+    RenderStats stats;
+
+    // Batches of the last presented frame, kept for picking. Their scene
+    // may be gone by then, so programs are held by name and checked first.
+    struct PickBatch
+    {
+        GLuint program;
+        Model model;
+        size_t firstInstance;
+        GLsizei instanceCount;
+    };
+    std::vector<PickBatch> pickBatches;
+    std::vector<GLint> pickStencilValues;
+
+    void renderLoop();
+    void runTasks(std::vector<std::function<void()>>& pending);
+    void present(FrameSnapshot& frame);
 
 public:
-    Renderer(SceneManager* sceneManager);
+    Renderer(GLFWwindow* window);
     ~Renderer();
 
-    void render();
+    Renderer(const Renderer&) = delete;
+    Renderer& operator=(const Renderer&) = delete;
+
+    // The calling thread must have the context current; start() hands it to
+    // the render thread and stop() gives it back.
+    void start();
+    void stop();
+    bool isThreaded() const { return running; }
+
+    // Simulation side: fill the returned snapshot, then submit it. Blocks
+    // while both snapshots are still owned by the render thread.
+    FrameSnapshot& beginFrame();
+    void submitFrame();
+
+    void render(const FrameSnapshot& frame);
     void clear();
     void setViewport(int width, int height);
-};
\ No newline at end of file
+    void setUploadBudget(double milliseconds) { uploadBudget = milliseconds / 1000.0; }
+    void setTextureUploadBudget(size_t bytes) { textureUploadBudget = bytes; }
+
+    // GL thread only, e.g. through invoke(). Reads the depth and stencil of
+    // the last presented frame at a window pixel, after giving each instance
+    // of a batch its own stencil value there.
+    void pick(GLint x, GLint y, GLfloat& depth, GLuint& stencilValue);
+
+    // Runs a task on the thread that owns the context before the next frame.
+    void enqueue(std::function<void()> task);
+    // Same, but waits for the task to finish.
+    void invoke(const std::function<void()>& task);
+
+    // Totals since the previous call.
+    RenderStats getStats();
+};
@@ -1,9 +1,10 @@
 #include "RotateTransform.h"
+#include "TransformStore.h"
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/common.hpp>
 
 RotateTransform::RotateTransform(const glm::vec3& rotAxis, float rotAngle)
-    : axis(glm::normalize(rotAxis)), angle(rotAngle)
+    : axis(glm::normalize(rotAxis)), angle(rotAngle), version(0), store(nullptr), record(-1)
 {
 }
 
@@ -16,13 +17,39 @@ glm::mat4 RotateTransform::getMatrix() const
     return glm::rotate(glm::mat4(1.0f), glm::radians(angle), axis);
 }
 
+bool RotateTransform::toRecord(TransformRecord& out) const
+{
+    out.axis = axis;
+    out.angle = angle;
+    return true;
+}
+
+void RotateTransform::bindRecord(TransformStore* newStore, int newRecord)
+{
+    store = newStore;
+    record = newRecord;
+}
+
 void RotateTransform::setRotation(const glm::vec3& rotAxis, float rotAngle)
 {
     axis = glm::normalize(rotAxis);
     angle = rotAngle;
+    version++;
+
+    if (store != nullptr)
+    {
+        store->setAxis(record, axis);
+        store->setAngle(record, angle);
+    }
 }
 
 void RotateTransform::setAngle(float rotAngle)
 {
     angle = rotAngle;
+    version++;
+
+    if (store != nullptr)
+    {
+        store->setAngle(record, angle);
+    }
 }
\ No newline at end of file
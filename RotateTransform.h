@@ -7,11 +7,18 @@ class RotateTransform : public ITransformComponent
 private:
     glm::vec3 axis;
     float angle;
+    unsigned int version;
+
+    TransformStore* store;
+    int record;
 
 public:
     RotateTransform(const glm::vec3& rotAxis, float rotAngle);
     ~RotateTransform();
     glm::mat4 getMatrix() const override;
+    bool toRecord(TransformRecord& record) const override;
+    void bindRecord(TransformStore* store, int record) override;
+    unsigned int getVersion() const override { return version; }
     void setRotation(const glm::vec3& rotAxis, float rotAngle);
     void setAngle(float rotAngle);
 };
\ No newline at end of file
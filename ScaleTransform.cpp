@@ -1,8 +1,9 @@
 #include "ScaleTransform.h"
+#include "TransformStore.h"
 #include <glm/gtc/matrix_transform.hpp>
 
 ScaleTransform::ScaleTransform(const glm::vec3& scale)
-    : scaleValue(scale)
+    : scaleValue(scale), version(0), store(nullptr), record(-1)
 {
 }
 
@@ -15,7 +16,43 @@ glm::mat4 ScaleTransform::getMatrix() const
     return glm::scale(glm::mat4(1.0f), scaleValue);
 }
 
+bool ScaleTransform::toRecord(TransformRecord& out) const
+{
+    // Records only carry uniform scale.
+    if (scaleValue.x != scaleValue.y || scaleValue.x != scaleValue.z)
+    {
+        return false;
+    }
+
+    out.scale = scaleValue.x;
+    return true;
+}
+
+void ScaleTransform::bindRecord(TransformStore* newStore, int newRecord)
+{
+    store = newStore;
+    record = newRecord;
+}
+
 void ScaleTransform::setScale(const glm::vec3& scale)
 {
     scaleValue = scale;
+    version++;
+
+    if (store == nullptr)
+    {
+        return;
+    }
+
+    TransformRecord out;
+    if (toRecord(out))
+    {
+        store->setScale(record, out.scale);
+    }
+    else
+    {
+        // A non-uniform scale cannot be a record; the object goes back to
+        // the component path.
+        store->release(record);
+    }
 }
\ No newline at end of file
@@ -6,11 +6,18 @@ class ScaleTransform : public ITransformComponent
 {
 private:
     glm::vec3 scaleValue;
+    unsigned int version;
+
+    TransformStore* store;
+    int record;
 
 public:
     ScaleTransform(const glm::vec3& scale);
     ~ScaleTransform();
     glm::mat4 getMatrix() const override;
+    bool toRecord(TransformRecord& record) const override;
+    void bindRecord(TransformStore* store, int record) override;
+    unsigned int getVersion() const override { return version; }
     void setScale(const glm::vec3& scale);
     glm::vec3 getScale() const { return scaleValue; }
 };
\ No newline at end of file
@@ -1,13 +1,73 @@
 #include "Scene.h"
 #include "LightObject.h"
 #include <algorithm>
+#include <cmath>
+#include <cstddef>
 #include <iostream>
+#include <unordered_set>
 #include "Texture.h"
+#include "TextureCache.h"
+#include "ModelCache.h"
+#include "JobSystem.h"
+#include "GLInvoker.h"
+#include <glm/common.hpp>
+#include <glm/geometric.hpp>
+#include <glm/matrix.hpp>
+#include <glm/trigonometric.hpp>
+
+namespace
+{
+    // Smallest number of objects worth handing to another thread.
+    const size_t UPDATE_GRAIN_SIZE = 64;
+    const size_t CULL_GRAIN_SIZE = 128;
+
+    // Objects reached by more point lights than this are shaded with the
+    // clustered lists instead of a list of their own.
+    const size_t MAX_OBJECT_LIGHTS = 8;
+    static_assert(MAX_OBJECT_LIGHTS <= ShaderVariantKey::MAX_LIST_LIGHTS, "object light lists must fit a variant");
+
+    // Block versions are unique across scenes, so the renderer can tell a
+    // changed block from a different scene's block by the version alone.
+    // Scenes may be built on the render thread while another one runs.
+    unsigned int nextBlockVersion()
+    {
+        static std::atomic<unsigned int> version(0);
+        return ++version;
+    }
+
+    // Sphere against a cone of half-angle acos(cosAngle) that ends at range.
+    bool intersectsCone(const glm::vec3& center, float radius, const glm::vec3& apex, const glm::vec3& direction,
+        float cosAngle, float sinAngle, float range)
+    {
+        glm::vec3 offset = center - apex;
+        float along = glm::dot(offset, direction);
+        float across = std::sqrt(std::max(glm::dot(offset, offset) - along * along, 0.0f));
+
+        // Behind the apex the closest point of the cone is the apex itself.
+        if (along * cosAngle + across * sinAngle < 0.0f) {
+            return glm::dot(offset, offset) <= radius * radius;
+        }
+        return across * cosAngle - along * sinAngle <= radius && along <= range + radius;
+    }
+}
 
 Scene::Scene()
-    : viewMatrix(glm::mat4(1.0f)),
+    : spotlight(nullptr),
+    lightBlock(),
+    lightVersion(0),
+    lightsDirty(true),
+    uploadedSpotLight(nullptr),
+    uploadedSpotLightVersion(0),
+    clusteredCameraVersion(0),
+    selectedLightVersion(0),
+    viewMatrix(glm::mat4(1.0f)),
     projectionMatrix(glm::mat4(1.0f)),
-    spotlight(nullptr),
+    frameBlock(),
+    cameraVersion(0),
+    cameraDirty(true),
+    elapsedTime(0.0f),
+    interpolation(1.0f),
+    frustumCulling(true),
     nextObjectID(1)
 {
 }
@@ -40,6 +100,7 @@ void Scene::addLight(Light* light)
 
     lights.push_back(light);
     light->attach(this);
+    lightsDirty = true;
 
     std::cout << "\nLight added to scene. Total lights: " << lights.size() << std::endl;
 }
@@ -51,13 +112,19 @@ void Scene::addLightObject(LightObject* lightObj)
         return;
     }
 
+    lightObj->setID(nextObjectID);
+    nextObjectID++;
+
     objects.push_back(std::unique_ptr<DrawableObject>(lightObj));
+    objectsByID[lightObj->getID()] = lightObj;
+    registerObject(lightObj);
 
     Light* light = lightObj->getLight();
     if (light != nullptr) {
         lights.push_back(light);
 
         light->attach(this);
+        lightsDirty = true;
     }
     else {
         std::cerr << "WARNING: LightObject has no attached light!" << std::endl;
@@ -74,6 +141,7 @@ void Scene::removeLight(Light* light)
     {
         (*it)->detach(this);
         lights.erase(it);
+        lightsDirty = true;
         std::cout << "Light removed from scene. Total lights: " << lights.size() << "\n";
     }
 }
@@ -91,6 +159,8 @@ void Scene::addObject(DrawableObject* obj)
     nextObjectID++;
 
     objects.push_back(std::unique_ptr<DrawableObject>(obj));
+    objectsByID[obj->getID()] = obj;
+    registerObject(obj);
 }
 
 void Scene::removeObject(DrawableObject* obj)
@@ -105,123 +175,617 @@ void Scene::removeObject(DrawableObject* obj)
 
     if (it != objects.end())
     {
+        unregisterObject(obj);
         objects.erase(it);
     }
 }
 
 void Scene::clear()
 {
+    transformStore.clear();
+    bvh.clear();
+    proxyIDs.clear();
+    objectsByID.clear();
+    movingObjects.clear();
+    dynamicObjects.clear();
+    dynamicObjectSet.clear();
+    unboundedObjects.clear();
+    pendingObjects.clear();
     objects.clear();
 }
 
+bool Scene::computeWorldBounds(const DrawableObject& obj, BoundingBox& bounds) const
+{
+    const ModelData* data = obj.getModelData();
+    if (data == nullptr) {
+        return false;
+    }
+
+    bounds = data->bounds.transformed(obj.getModelMatrix());
+    return true;
+}
+
+void Scene::registerObject(DrawableObject* obj)
+{
+    // Moving objects whose transform chain compiles to records are
+    // evaluated in batches; anything else stays on the component path.
+    if (obj->isMovable()) {
+        transformStore.add(obj);
+        dynamicObjects.push_back(obj);
+        dynamicObjectSet.insert(obj);
+        obj->savePreviousModelMatrix();
+    }
+    else {
+        obj->getNormalMatrix();
+    }
+
+    if (obj->isModelPending()) {
+        pendingObjects.push_back(obj);
+    }
+
+    insertProxy(obj);
+}
+
+void Scene::insertProxy(DrawableObject* obj)
+{
+    BoundingBox bounds;
+    if (!computeWorldBounds(*obj, bounds)) {
+        unboundedObjects.push_back(obj);
+        return;
+    }
+
+    int proxyID = bvh.createProxy(bounds, obj);
+    proxyIDs[obj] = proxyID;
+
+    if (obj->isMovable()) {
+        movingObjects.push_back({ obj, proxyID, obj->getWorldVersion() });
+    }
+}
+
+void Scene::unregisterObject(DrawableObject* obj)
+{
+    transformStore.remove(obj);
+
+    auto proxy = proxyIDs.find(obj);
+    if (proxy != proxyIDs.end()) {
+        bvh.destroyProxy(proxy->second);
+        proxyIDs.erase(proxy);
+    }
+
+    auto byID = objectsByID.find(obj->getID());
+    if (byID != objectsByID.end() && byID->second == obj) {
+        objectsByID.erase(byID);
+    }
+
+    movingObjects.erase(std::remove_if(movingObjects.begin(), movingObjects.end(),
+        [obj](const MovingProxy& proxy) { return proxy.object == obj; }), movingObjects.end());
+    if (dynamicObjectSet.erase(obj) != 0) {
+        dynamicObjects.erase(std::remove(dynamicObjects.begin(), dynamicObjects.end(), obj), dynamicObjects.end());
+    }
+    unboundedObjects.erase(std::remove(unboundedObjects.begin(), unboundedObjects.end(), obj), unboundedObjects.end());
+    pendingObjects.erase(std::remove(pendingObjects.begin(), pendingObjects.end(), obj), pendingObjects.end());
+    objectLights.erase(obj);
+}
+
+void Scene::updatePendingModels()
+{
+    for (size_t i = 0; i < pendingObjects.size();) {
+        DrawableObject* obj = pendingObjects[i];
+
+        if (obj->updatePendingModel() && proxyIDs.find(obj) == proxyIDs.end()) {
+            unboundedObjects.erase(std::remove(unboundedObjects.begin(), unboundedObjects.end(), obj), unboundedObjects.end());
+            insertProxy(obj);
+        }
+
+        if (obj->isModelPending()) {
+            i++;
+            continue;
+        }
+
+        pendingObjects[i] = pendingObjects.back();
+        pendingObjects.pop_back();
+    }
+}
+
+bool Scene::containsObject(const DrawableObject* obj) const
+{
+    auto it = objectsByID.find(obj->getID());
+    return it != objectsByID.end() && it->second == obj;
+}
+
+void Scene::setObjectDynamic(DrawableObject* obj, bool dynamic)
+{
+    if (obj == nullptr || !containsObject(obj)) {
+        std::cerr << "Scene::setObjectDynamic() - object is not in this scene" << std::endl;
+        return;
+    }
+
+    obj->getTransformation().setDynamic(dynamic);
+    updateMobility(obj);
+}
+
+void Scene::updateMobility(DrawableObject* obj)
+{
+    bool movable = obj->isMovable();
+    bool wasDynamic = dynamicObjectSet.count(obj) != 0;
+
+    if (movable && !wasDynamic) {
+        transformStore.add(obj);
+        dynamicObjects.push_back(obj);
+        dynamicObjectSet.insert(obj);
+        obj->savePreviousModelMatrix();
+
+        auto proxy = proxyIDs.find(obj);
+        if (proxy != proxyIDs.end()) {
+            movingObjects.push_back({ obj, proxy->second, obj->getWorldVersion() });
+        }
+    }
+    else if (!movable && wasDynamic) {
+        // Leaving the store copies the record state back into the
+        // components, so the object freezes where it is.
+        transformStore.remove(obj);
+        dynamicObjectSet.erase(obj);
+        dynamicObjects.erase(std::remove(dynamicObjects.begin(), dynamicObjects.end(), obj), dynamicObjects.end());
+        movingObjects.erase(std::remove_if(movingObjects.begin(), movingObjects.end(),
+            [obj](const MovingProxy& proxy) { return proxy.object == obj; }), movingObjects.end());
+
+        BoundingBox bounds;
+        auto proxy = proxyIDs.find(obj);
+        if (proxy != proxyIDs.end() && computeWorldBounds(*obj, bounds)) {
+            bvh.moveProxy(proxy->second, bounds);
+        }
+        obj->getNormalMatrix();
+    }
+
+    for (DrawableObject* child : obj->getChildren()) {
+        if (containsObject(child)) {
+            updateMobility(child);
+        }
+    }
+}
+
+void Scene::refitMovingObjects()
+{
+    for (MovingProxy& proxy : movingObjects) {
+        if (proxy.object->getWorldVersion() == proxy.worldVersion) {
+            continue;
+        }
+
+        BoundingBox bounds;
+        if (computeWorldBounds(*proxy.object, bounds)) {
+            bvh.moveProxy(proxy.proxyID, bounds);
+        }
+        proxy.worldVersion = proxy.object->getWorldVersion();
+    }
+}
+
 void Scene::update(float deltaTime)
 {
-    for (auto& obj : objects)
+    elapsedTime += deltaTime;
+
+    resetInterpolation();
+
+    // Objects outside a hierarchy only touch their own state and are updated
+    // in parallel. markDirty() reaches into children, so hierarchies are
+    // updated on this thread afterwards.
+    JobSystem::getInstance().parallelFor(dynamicObjects.size(), UPDATE_GRAIN_SIZE,
+        [this, deltaTime](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) {
+                DrawableObject* obj = dynamicObjects[i];
+                if (!obj->hasParent() && obj->getChildren().empty())
+                    obj->update(deltaTime);
+            }
+        });
+
+    for (DrawableObject* obj : dynamicObjects)
     {
-        if (obj)
+        if (obj->hasParent() || !obj->getChildren().empty())
             obj->update(deltaTime);
     }
+
+    transformStore.update(deltaTime);
+    refitMovingObjects();
+}
+
+void Scene::setInterpolation(float alpha)
+{
+    interpolation = glm::clamp(alpha, 0.0f, 1.0f);
+}
+
+void Scene::resetInterpolation()
+{
+    for (DrawableObject* obj : dynamicObjects)
+    {
+        obj->savePreviousModelMatrix();
+    }
 }
 
-void Scene::render()
+void Scene::updateLightBlock()
 {
+    if (spotlight != uploadedSpotLight ||
+        (spotlight && spotlight->getVersion() != uploadedSpotLightVersion))
+    {
+        lightsDirty = true;
+    }
 
-    glEnable(GL_STENCIL_TEST);
-    glStencilOp(GL_KEEP, GL_KEEP, GL_REPLACE);
+    if (!lightsDirty && cameraVersion == clusteredCameraVersion)
+    {
+        return;
+    }
 
-    for (auto& obj : objects) {
-        if (obj->getShader() == nullptr) {
-            std::cerr << "Scene::render() - Object has no shader!" << std::endl;
-            continue;
+    lightData.clear();
+    for (Light* light : lights)
+    {
+        if (light != nullptr)
+        {
+            LightData data;
+            light->applyToBlock(data);
+            lightData.push_back(data);
         }
+    }
+    lightBlock.numLights = static_cast<int>(lightData.size());
 
-        ShaderProgram* shader = obj->getShader();
-        shader->use();
+    if (spotlight)
+    {
+        spotlight->applyToBlock(lightBlock.spotlight);
+        uploadedSpotLightVersion = spotlight->getVersion();
+    }
+    else
+    {
+        lightBlock.spotlight.enabled = 0;
+    }
+    uploadedSpotLight = spotlight;
 
-        glStencilFunc(GL_ALWAYS, obj->getID(), 0xFF);
+    float nearPlane = camera ? camera->getNear() : 0.1f;
+    float farPlane = camera ? camera->getFar() : 100.0f;
+    lightClusters.build(lightData, viewMatrix, projectionMatrix, nearPlane, farPlane);
 
-        glm::mat4 modelMatrix = obj->getModelMatrix();
-        glm::mat3 normalMatrix = glm::transpose(glm::inverse(glm::mat3(modelMatrix)));
+    lightBlock.clusterCount = glm::ivec3(LightClusters::CLUSTER_COUNT_X, LightClusters::CLUSTER_COUNT_Y,
+        LightClusters::CLUSTER_COUNT_Z);
+    lightBlock.clusterDepthScale = lightClusters.getDepthScale();
+    lightBlock.clusterDepthBias = lightClusters.getDepthBias();
+    clusteredCameraVersion = cameraVersion;
 
-        shader->setUniform("modelMatrix", modelMatrix);
-        shader->setUniform("normalMatrix", normalMatrix);
-        shader->setUniform("viewMatrix", viewMatrix);
-        shader->setUniform("projectionMatrix", projectionMatrix);
+    lightVersion = nextBlockVersion();
+    lightsDirty = false;
+}
 
-        if (camera) {
-            GLint loc = shader->getUniformLocation("cameraPosition");
-            if (loc != -1) {
-                shader->setUniform("cameraPosition", camera->getEye());
-            }
+void Scene::updateFrameBlock()
+{
+    frameBlock.time = elapsedTime;
+
+    if (!cameraDirty)
+    {
+        return;
+    }
+
+    frameBlock.viewMatrix = viewMatrix;
+    frameBlock.projectionMatrix = projectionMatrix;
+    frameBlock.viewProjectionMatrix = projectionMatrix * viewMatrix;
+    frameBlock.cameraPosition = camera ? camera->getEye() : glm::vec3(0.0f);
+
+    cameraVersion = nextBlockVersion();
+    cameraDirty = false;
+}
+
+bool Scene::getWorldSphere(const DrawableObject& obj, const glm::mat4& modelMatrix, glm::vec3& center,
+    float& radius) const
+{
+    const ModelData* data = obj.getModelData();
+    if (data == nullptr) {
+        return false;
+    }
+
+    center = glm::vec3(modelMatrix * glm::vec4(data->sphere.center, 1.0f));
+    float scale = std::max(glm::length(glm::vec3(modelMatrix[0])),
+        std::max(glm::length(glm::vec3(modelMatrix[1])), glm::length(glm::vec3(modelMatrix[2]))));
+    radius = data->sphere.radius * scale;
+    return true;
+}
+
+bool Scene::isVisible(const DrawableObject& obj, const glm::mat4& modelMatrix) const
+{
+    glm::vec3 center;
+    float radius;
+    if (!getWorldSphere(obj, modelMatrix, center, radius)) {
+        return true;
+    }
+
+    if (!frustum.intersectsSphere(center, radius)) {
+        return false;
+    }
+
+    return frustum.intersectsBox(obj.getModelData()->bounds, modelMatrix);
+}
+
+void Scene::updateObjectLights()
+{
+    if (selectedLightVersion == lightVersion) {
+        return;
+    }
+    selectedLightVersion = lightVersion;
+
+    // Light indices have moved, so every list is chosen again.
+    if (selectedLights.size() != lightData.size()) {
+        objectLights.clear();
+        selectedLights = lightData;
+        return;
+    }
+
+    // Objects near where a light was may lose it, objects near where it is
+    // may gain it. Fat hierarchy boxes are good enough for that.
+    lightQueryResults.clear();
+    bool changed = false;
+    for (size_t i = 0; i < lightData.size(); i++) {
+        const LightData& previous = selectedLights[i];
+        const LightData& current = lightData[i];
+        if (previous.position == current.position && previous.radius == current.radius) {
+            continue;
+        }
+
+        bvh.querySphere(previous.position, previous.radius, lightQueryResults);
+        bvh.querySphere(current.position, current.radius, lightQueryResults);
+        changed = true;
+    }
+
+    if (changed) {
+        lightQueryResults.insert(lightQueryResults.end(), unboundedObjects.begin(), unboundedObjects.end());
+    }
+
+    for (DrawableObject* obj : lightQueryResults) {
+        auto selection = objectLights.find(obj);
+        if (selection != objectLights.end()) {
+            selection->second.dirty = true;
         }
+    }
+
+    selectedLights = lightData;
+}
+
+void Scene::selectLights(const DrawableObject& obj, ObjectLights& selection) const
+{
+    selection.lights.clear();
+    selection.clustered = false;
+    selection.dirty = false;
+    selection.worldVersion = obj.getWorldVersion();
+
+    glm::vec3 center;
+    float radius;
+    selection.bounded = getWorldSphere(obj, obj.getModelMatrix(), center, radius);
+    if (!selection.bounded) {
+        selection.clustered = true;
+        return;
+    }
 
-        int numLights = static_cast<int>(lights.size());
-        if (numLights > 20) {
-            numLights = 20;
+    for (size_t i = 0; i < lightData.size(); i++) {
+        float reach = lightData[i].radius + radius;
+        glm::vec3 offset = lightData[i].position - center;
+        if (glm::dot(offset, offset) > reach * reach) {
+            continue;
         }
 
-        GLint numLightsLoc = shader->getUniformLocation("numLights");
-        if (numLightsLoc != -1) {
-            shader->setUniform("numLights", numLights);
+        // Dropping the weaker lights would make them pop as things move.
+        if (selection.lights.size() == MAX_OBJECT_LIGHTS) {
+            selection.lights.clear();
+            selection.clustered = true;
+            return;
         }
+        selection.lights.push_back(static_cast<uint32_t>(i));
+    }
+}
 
-        for (int i = 0; i < numLights; i++) {
-            if (lights[i] != nullptr) {
-                lights[i]->applyToShader(*shader, i);
-            }
+void Scene::buildRenderQueue()
+{
+    renderQueue.clear();
+    renderQueue.reserve(objects.size());
+
+    float farPlane = camera ? camera->getFar() : 1.0f;
+
+    bool spotlightEnabled = spotlight != nullptr && spotlight->isEnabled();
+    glm::vec3 spotDirection;
+    float spotCos = 0.0f;
+    float spotSin = 0.0f;
+    float spotRange = 0.0f;
+    if (spotlightEnabled) {
+        spotDirection = glm::normalize(spotlight->getDirection());
+        spotCos = glm::cos(glm::radians(spotlight->getOuterCutOff()));
+        spotSin = glm::sin(glm::radians(spotlight->getOuterCutOff()));
+        spotRange = spotlight->getRadius();
+    }
+
+    frustum.extract(projectionMatrix * viewMatrix);
+    cullingStats = CullingStats();
+
+    // The hierarchy returns everything whose fat box touches the frustum;
+    // the exact per-object test below trims that list.
+    visibleObjects.clear();
+    if (frustumCulling) {
+        cullingStats.tested = objects.size();
+        cullingStats.nodesVisited = bvh.queryFrustum(frustum, visibleObjects);
+        visibleObjects.insert(visibleObjects.end(), unboundedObjects.begin(), unboundedObjects.end());
+    }
+    else {
+        for (auto& obj : objects) {
+            visibleObjects.push_back(obj.get());
         }
+    }
 
-        if (spotlight) {
-            spotlight->applyToShader(*shader, "spotlight");
+    // Matrices are cached lazily, so they are brought up to date here before
+    // the exact tests read them from several threads.
+    visibleFlags.assign(visibleObjects.size(), 1);
+    if (frustumCulling) {
+        for (DrawableObject* obj : visibleObjects) {
+            obj->getModelMatrix();
         }
-        else {
-            GLint spotlightEnabledLoc = shader->getUniformLocation("spotlight.enabled");
-            if (spotlightEnabledLoc != -1) {
-                shader->setUniform("spotlight.enabled", 0);
-            }
+
+        JobSystem::getInstance().parallelFor(visibleObjects.size(), CULL_GRAIN_SIZE,
+            [this](size_t begin, size_t end) {
+                for (size_t i = begin; i < end; i++) {
+                    const DrawableObject* obj = visibleObjects[i];
+                    visibleFlags[i] = isVisible(*obj, obj->getModelMatrix()) ? 1 : 0;
+                }
+            });
+    }
+
+    for (size_t i = 0; i < visibleObjects.size(); i++) {
+        if (!visibleFlags[i]) {
+            continue;
         }
 
-        GLint objectColorLoc = shader->getUniformLocation("objectColor");
-        if (objectColorLoc != -1) {
-            shader->setUniform("objectColor", obj->getObjectColor());
+        DrawableObject* obj = visibleObjects[i];
+        ShaderProgram* shader = obj->getShader();
+        if (shader == nullptr) {
+            std::cerr << "Scene::buildFrame() - Object has no shader!" << std::endl;
+            continue;
         }
 
-        GLint shininessLoc = shader->getUniformLocation("shininess");
-        if (shininessLoc != -1) {
-            shader->setUniform("shininess", obj->getShininess());
+        const Model& model = obj->getModel();
+        if (!model.isModelLoaded()) {
+            continue;
         }
 
         Texture* texture = obj->getTexture();
-        if (texture != nullptr && texture->isTextureLoaded()) {
-            texture->bind(0);
+        GLuint textureID = (texture != nullptr && texture->isTextureLoaded()) ? texture->getID() : 0;
 
-            GLint textureLoc = shader->getUniformLocation("textureUnitID");
-            if (textureLoc != -1) {
-                shader->setUniform("textureUnitID", 0);
-            }
+        glm::mat4 modelMatrix = obj->getModelMatrix();
+        glm::mat3 normalMatrix = obj->getNormalMatrix();
 
-            GLint useTextureLoc = shader->getUniformLocation("useTexture");
-            if (useTextureLoc != -1) {
-                shader->setUniform("useTexture", 1);
+        // Steps are short, so a component-wise blend stays close to rigid.
+        if (interpolation < 1.0f && obj->isMovable()) {
+            modelMatrix = obj->getPreviousModelMatrix() * (1.0f - interpolation) + modelMatrix * interpolation;
+            normalMatrix = glm::transpose(glm::inverse(glm::mat3(modelMatrix)));
+        }
+        float viewDepth = -(viewMatrix * modelMatrix[3]).z;
+
+        // The lights reaching the object pick the lighting part of its
+        // shader variant; the object adds its material.
+        ShaderVariantKey variant;
+        if (shader->usesLights()) {
+            ObjectLights& selection = objectLights[obj];
+            if (selection.dirty || selection.worldVersion != obj->getWorldVersion() ||
+                (!selection.bounded && obj->getModelData() != nullptr)) {
+                selectLights(*obj, selection);
+            }
+            variant.lightBucket = selection.clustered ? LIGHT_BUCKET_CLUSTERED :
+                ShaderVariantKey::getListBucket(selection.lights.size());
+
+            if (spotlightEnabled) {
+                glm::vec3 center;
+                float radius;
+                variant.spotlight = !getWorldSphere(*obj, modelMatrix, center, radius) ||
+                    intersectsCone(center, radius, spotlight->getPosition(), spotDirection, spotCos, spotSin, spotRange);
             }
         }
-        else {
-            GLint useTextureLoc = shader->getUniformLocation("useTexture");
-            if (useTextureLoc != -1) {
-                shader->setUniform("useTexture", 0);
+
+        RenderItem item;
+        item.object = obj;
+        item.modelMatrix = modelMatrix;
+        item.normalMatrix = normalMatrix;
+        item.shader = obj->selectShader(variant);
+        item.spotlight = variant.spotlight;
+
+        uint64_t key = RenderQueue::makeKey(item.shader->getID(), textureID, model.getVAO(), viewDepth, farPlane);
+        renderQueue.push(item, key);
+    }
+
+    renderQueue.sort();
+    cullingStats.drawn = renderQueue.size();
+    if (frustumCulling) {
+        cullingStats.culled = cullingStats.tested - cullingStats.drawn;
+    }
+}
+
+void Scene::buildBatches(FrameSnapshot& frame)
+{
+    frame.draws.clear();
+    frame.instances.clear();
+    frame.instances.reserve(renderQueue.size());
+    frame.stencilValues.clear();
+    frame.stencilValues.reserve(renderQueue.size());
+    frame.objectLightIndices.clear();
+
+    const RenderItem* batchItem = nullptr;
+
+    for (size_t i = 0; i < renderQueue.size(); i++) {
+        const RenderItem& item = renderQueue[i];
+        DrawableObject* obj = item.object;
+
+        InstanceData instance;
+        instance.modelMatrix = item.modelMatrix;
+        instance.normalMatrix = item.normalMatrix;
+        instance.color = obj->getObjectColor();
+        instance.shininess = obj->getShininess();
+        instance.lightOffset = 0;
+        instance.lightCount = 0;
+        instance.spotLight = item.spotlight ? 1 : 0;
+
+        // Lists were brought up to date while the queue was built.
+        if (obj->getShader()->usesLights()) {
+            const ObjectLights& selection = objectLights[obj];
+            if (selection.clustered) {
+                instance.lightCount = CLUSTERED_LIGHTS;
+            }
+            else {
+                instance.lightOffset = static_cast<uint32_t>(frame.objectLightIndices.size());
+                instance.lightCount = static_cast<uint32_t>(selection.lights.size());
+                frame.objectLightIndices.insert(frame.objectLightIndices.end(),
+                    selection.lights.begin(), selection.lights.end());
             }
         }
 
-        obj->draw();
+        frame.instances.push_back(instance);
+        frame.stencilValues.push_back(obj->getID());
 
-        if (texture != nullptr && texture->isTextureLoaded()) {
-            texture->unbind();
+        bool sameBatch = batchItem != nullptr &&
+            batchItem->shader == item.shader &&
+            batchItem->object->getTexture() == obj->getTexture() &&
+            batchItem->object->getModel().getMesh() == obj->getModel().getMesh();
+
+        if (sameBatch) {
+            // A batch writes 0; Renderer::pick draws its instances one by one.
+            frame.draws.back().instanceCount++;
+            frame.draws.back().stencilValue = 0;
+            continue;
         }
 
-        shader->unuse();
+        Texture* texture = obj->getTexture();
+
+        DrawCommand draw;
+        draw.shader = item.shader;
+        draw.texture = (texture != nullptr && texture->isTextureLoaded()) ? texture->getID() : 0;
+        draw.model = obj->getModel();
+        draw.firstInstance = frame.instances.size() - 1;
+        draw.instanceCount = 1;
+        draw.stencilValue = obj->getID();
+        frame.draws.push_back(draw);
+
+        batchItem = &item;
     }
+}
 
-    glDisable(GL_STENCIL_TEST);
+void Scene::buildFrame(FrameSnapshot& frame)
+{
+    updatePendingModels();
+    updateFrameBlock();
+    updateLightBlock();
+    updateObjectLights();
+
+    frame.scene = this;
+    frame.frameBlock = frameBlock;
+    frame.cameraVersion = cameraVersion;
+    // Each snapshot keeps the lists it was last given, so they are only
+    // copied when they changed since.
+    if (frame.lightVersion != lightVersion) {
+        frame.lights = lightData;
+        frame.lightClusters = lightClusters.getClusters();
+        frame.lightIndices = lightClusters.getLightIndices();
+    }
+    frame.lightBlock = lightBlock;
+    frame.lightVersion = lightVersion;
+
+    buildRenderQueue();
+    buildBatches(frame);
+    cullingStats.drawCalls = frame.draws.size();
 }
 
 void Scene::setCamera(Camera* newCamera)
@@ -239,7 +803,7 @@ void Scene::setCamera(Camera* newCamera)
 
         viewMatrix = camera->getCamera();
         projectionMatrix = camera->getProjectionMatrix();
-
+        cameraDirty = true;
     }
 }
 
@@ -249,6 +813,7 @@ void Scene::updateCameraMatrices()
     {
         viewMatrix = camera->getCamera();
         projectionMatrix = camera->getProjectionMatrix();
+        cameraDirty = true;
     }
 }
 
@@ -256,12 +821,16 @@ void Scene::onCameraChanged(Camera* camera)
 {
     if (camera) {
         viewMatrix = camera->getCamera();
+        projectionMatrix = camera->getProjectionMatrix();
+        cameraDirty = true;
     }
 }
 
 void Scene::onLightChanged(Light* light)
 {
     if (!light) return;
+
+    lightsDirty = true;
 }
 
 void Scene::onLightDestroyed(Light* light)
@@ -271,6 +840,7 @@ void Scene::onLightDestroyed(Light* light)
     auto it = std::find(lights.begin(), lights.end(), light);
     if (it != lights.end()) {
         lights.erase(it);
+        lightsDirty = true;
         std::cout << "Scene::onLightDestroyed() - Light removed. Total lights: "
             << lights.size() << std::endl;
     }
@@ -301,9 +871,16 @@ const DrawableObject* Scene::getObject(size_t index) const
 
 ShaderProgram* Scene::createShader(const std::string& vertexPath, const std::string& fragmentPath)
 {
-    auto shader = std::make_unique<ShaderProgram>();
+    // Compiling, and deleting a program that failed, need the context.
+    std::unique_ptr<ShaderProgram> shader;
+    GLInvoker::run([&] {
+        shader = std::make_unique<ShaderProgram>();
+        if (!shader->loadFromFiles(vertexPath, fragmentPath)) {
+            shader.reset();
+        }
+    });
 
-    if (!shader->loadFromFiles(vertexPath, fragmentPath)) {
+    if (!shader) {
         std::cerr << "Scene: Failed to load shader: " << vertexPath << " + " << fragmentPath << std::endl;
         return nullptr;
     }
@@ -314,22 +891,113 @@ ShaderProgram* Scene::createShader(const std::string& vertexPath, const std::str
     return shaders.back().get();
 }
 
+Texture* Scene::loadTexture(const std::string& filePath)
+{
+    std::shared_ptr<Texture> texture = TextureCache::getInstance().loadTextureAsync(filePath);
+
+    if (!texture) {
+        std::cerr << "Scene: Failed to load texture: " << filePath << std::endl;
+        return nullptr;
+    }
+
+    if (std::find(textures.begin(), textures.end(), texture) == textures.end()) {
+        textures.push_back(texture);
+    }
+    return texture.get();
+}
+
+size_t Scene::getResidentBytes() const
+{
+    std::unordered_set<const GpuMesh*> meshes;
+    size_t total = 0;
+
+    for (const auto& obj : objects) {
+        const GpuMesh* mesh = obj->getModel().getMesh();
+        if (mesh != nullptr && meshes.insert(mesh).second) {
+            total += mesh->sizeBytes;
+        }
+    }
+
+    for (const auto& texture : textures) {
+        total += texture->getBytes();
+    }
+
+    return total;
+}
+
 void Scene::setSpotLight(SpotLight* light)
 {
     spotlight = light;
+    lightsDirty = true;
     std::cout << "SpotLight added to scene" << std::endl;
 }
 
 DrawableObject* Scene::findObjectByID(int id)
 {
-    for (auto& obj : objects)
-    {
-        if (obj->getID() == id)
-        {
-            return obj.get();
+    auto it = objectsByID.find(id);
+    return it != objectsByID.end() ? it->second : nullptr;
+}
+
+void Scene::refineQuery(std::vector<DrawableObject*>& results, const BoundingBox* box,
+    const glm::vec3* center, float radius) const
+{
+    // Leaf boxes in the hierarchy are enlarged; recheck against exact bounds.
+    auto rejected = [&](DrawableObject* obj) {
+        BoundingBox bounds;
+        if (!computeWorldBounds(*obj, bounds)) {
+            return true;
+        }
+        if (box != nullptr) {
+            return !bounds.overlaps(*box);
+        }
+        glm::vec3 offset = glm::clamp(*center, bounds.min, bounds.max) - *center;
+        return glm::dot(offset, offset) > radius * radius;
+    };
+
+    results.erase(std::remove_if(results.begin(), results.end(), rejected), results.end());
+}
+
+void Scene::queryBox(const BoundingBox& box, std::vector<DrawableObject*>& results) const
+{
+    std::vector<DrawableObject*> candidates;
+    bvh.queryBox(box, candidates);
+    refineQuery(candidates, &box, nullptr, 0.0f);
+    results.insert(results.end(), candidates.begin(), candidates.end());
+}
+
+void Scene::querySphere(const glm::vec3& center, float radius, std::vector<DrawableObject*>& results) const
+{
+    std::vector<DrawableObject*> candidates;
+    bvh.querySphere(center, radius, candidates);
+    refineQuery(candidates, nullptr, &center, radius);
+    results.insert(results.end(), candidates.begin(), candidates.end());
+}
+
+DrawableObject* Scene::raycast(const glm::vec3& origin, const glm::vec3& direction, float maxDistance,
+    float* hitDistance) const
+{
+    std::vector<DrawableObject*> candidates;
+    bvh.queryRay(origin, direction, maxDistance, candidates);
+
+    const glm::vec3 inverseDirection = 1.0f / direction;
+    DrawableObject* closest = nullptr;
+    float closestDistance = maxDistance;
+
+    for (DrawableObject* obj : candidates) {
+        BoundingBox bounds;
+        float distance;
+        if (computeWorldBounds(*obj, bounds) &&
+            bounds.intersectRay(origin, inverseDirection, closestDistance, distance)) {
+            closest = obj;
+            closestDistance = distance;
         }
     }
-    return nullptr;
+
+    if (closest != nullptr && hitDistance != nullptr) {
+        *hitDistance = closestDistance;
+    }
+
+    return closest;
 }
 
 void Scene::putTree(const glm::vec3& position)
@@ -378,15 +1046,14 @@ void Scene::putTeren(const glm::vec3& position)
         return;
     }
 
-    Texture* grassTexture = new Texture();
-    if (grassTexture->loadFromFile("texture/grass.png")) {
+    Texture* grassTexture = loadTexture("texture/grass.png");
+    if (grassTexture != nullptr) {
         teren->setTexture(grassTexture);
         std::cout << "Grass texture loaded for terrain" << std::endl;
     }
     else {
         std::cerr << "Failed to load grass.png texture, using default color" << std::endl;
         teren->setObjectColor(glm::vec3(0.2f, 0.6f, 0.2f));
-        delete grassTexture;
     }
 
     teren->setShininess(32.0f);
@@ -1,7 +1,10 @@
 #pragma once
+#include <atomic>
 #include <vector>
 #include <memory>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
 #include <glm/mat4x4.hpp>
 #include "DrawableObject.h"
 #include "Camera.h"
@@ -11,9 +14,27 @@
 #include "LightObserver.h"
 #include "TranslateTransform.h"
 #include "SpotLight.h"
+#include "LightClusters.h"
+#include "UniformBlocks.h"
+#include "RenderQueue.h"
+#include "FrameSnapshot.h"
+#include "Frustum.h"
+#include "DynamicBVH.h"
+#include "TransformStore.h"
 
 class LightObject;
 
+struct CullingStats
+{
+    size_t tested;
+    size_t culled;
+    size_t drawn;
+    size_t drawCalls;
+    size_t nodesVisited;
+
+    CullingStats() : tested(0), culled(0), drawn(0), drawCalls(0), nodesVisited(0) {}
+};
+
 class Scene : public CameraObserver, public LightObserver
 {
 private:
@@ -23,10 +44,97 @@ private:
     SpotLight* spotlight;
 
     std::vector<std::unique_ptr<ShaderProgram>> shaders;
+    std::vector<std::shared_ptr<Texture>> textures;
+
+    LightBlock lightBlock;
+    std::vector<LightData> lightData;
+    LightClusters lightClusters;
+    unsigned int lightVersion;
+    // Lights can report changes from objects updated on worker threads.
+    std::atomic<bool> lightsDirty;
+    const SpotLight* uploadedSpotLight;
+    unsigned int uploadedSpotLightVersion;
+    // Clusters are laid out in view space, so they are rebuilt when the
+    // camera moves as well.
+    unsigned int clusteredCameraVersion;
+
+    // Point lights reaching a lit object. Chosen again only when the object
+    // moves or a light near it changes.
+    struct ObjectLights
+    {
+        std::vector<uint32_t> lights;
+        // Reached by too many lights for a list of its own.
+        bool clustered;
+        bool bounded;
+        bool dirty;
+        unsigned int worldVersion;
+
+        ObjectLights() : clustered(false), bounded(false), dirty(true), worldVersion(0) {}
+    };
+    std::unordered_map<const DrawableObject*, ObjectLights> objectLights;
+    // Lights as they were when objectLights was last brought up to date.
+    std::vector<LightData> selectedLights;
+    unsigned int selectedLightVersion;
+    std::vector<DrawableObject*> lightQueryResults;
+
+    void updateLightBlock();
+    void updateFrameBlock();
+    void updateObjectLights();
+    void selectLights(const DrawableObject& obj, ObjectLights& selection) const;
+    bool getWorldSphere(const DrawableObject& obj, const glm::mat4& modelMatrix, glm::vec3& center, float& radius) const;
+    void buildRenderQueue();
+    void buildBatches(FrameSnapshot& frame);
+    bool isVisible(const DrawableObject& obj, const glm::mat4& modelMatrix) const;
+
+    bool computeWorldBounds(const DrawableObject& obj, BoundingBox& bounds) const;
+    void registerObject(DrawableObject* obj);
+    void insertProxy(DrawableObject* obj);
+    void unregisterObject(DrawableObject* obj);
+    void updatePendingModels();
+    void updateMobility(DrawableObject* obj);
+    bool containsObject(const DrawableObject* obj) const;
+    void refitMovingObjects();
+    void refineQuery(std::vector<DrawableObject*>& results, const BoundingBox* box,
+        const glm::vec3* center, float radius) const;
 
     glm::mat4 viewMatrix;
     glm::mat4 projectionMatrix;
 
+    FrameBlock frameBlock;
+    unsigned int cameraVersion;
+    bool cameraDirty;
+    float elapsedTime;
+    float interpolation;
+
+    RenderQueue renderQueue;
+
+    Frustum frustum;
+    bool frustumCulling;
+    CullingStats cullingStats;
+
+    TransformStore transformStore;
+    DynamicBVH bvh;
+    std::unordered_map<const DrawableObject*, int> proxyIDs;
+    std::unordered_map<int, DrawableObject*> objectsByID;
+    struct MovingProxy
+    {
+        DrawableObject* object;
+        int proxyID;
+        unsigned int worldVersion;
+    };
+    std::vector<MovingProxy> movingObjects;
+
+    // Only objects whose world matrix can change are updated each frame;
+    // static objects keep the matrices baked when they were added.
+    std::vector<DrawableObject*> dynamicObjects;
+    std::unordered_set<const DrawableObject*> dynamicObjectSet;
+    std::vector<DrawableObject*> unboundedObjects;
+    // Objects whose model is still loading; they join the hierarchy once
+    // their mesh is resident.
+    std::vector<DrawableObject*> pendingObjects;
+    std::vector<DrawableObject*> visibleObjects;
+    std::vector<unsigned char> visibleFlags;
+
     int nextObjectID;
 
 public:
@@ -37,9 +145,29 @@ public:
     void addLightObject(LightObject* lightObj);
     void removeObject(DrawableObject* obj);
 
+    // Promotes an object to the per-frame update set when it starts moving,
+    // or freezes it in place when it stops. Children inherit the change.
+    void setObjectDynamic(DrawableObject* obj, bool dynamic);
+    size_t getDynamicObjectCount() const { return dynamicObjects.size(); }
+    size_t getPendingObjectCount() const { return pendingObjects.size(); }
+
     void clear();
+    // Advances the simulation by one step. Moving objects remember their
+    // previous world matrix so buildFrame() can blend towards the current one.
     void update(float deltaTime);
-    void render();
+
+    // Picks up finished model loads, then culls, sorts and batches the
+    // visible objects and copies everything the renderer needs into frame.
+    // Makes no GL calls.
+    void buildFrame(FrameSnapshot& frame);
+
+    // Fraction of a simulation step that has elapsed since the last update,
+    // in [0, 1]; 1 renders the latest state.
+    void setInterpolation(float alpha);
+    // Makes the previous state equal the current one, e.g. after the scene
+    // was inactive, so the next frames do not blend across the gap.
+    void resetInterpolation();
+    float getInterpolation() const { return interpolation; }
 
     void setCamera(Camera* newCamera);
     void updateCameraMatrices();
@@ -48,17 +176,34 @@ public:
     void removeLight(Light* light);
     const std::vector<Light*>& getLights() const { return lights; }
     size_t getLightCount() const { return lights.size(); }
+    const LightClusters& getLightClusters() const { return lightClusters; }
 
     void onCameraChanged(Camera* camera) override;
     void onLightChanged(Light* light) override;
     void onLightDestroyed(Light* light) override;
 
     ShaderProgram* createShader(const std::string& vertexPath, const std::string& fragmentPath);
+    // Shared through the texture cache and kept alive while the scene
+    // exists. The texture streams in over the next frames; objects using it
+    // draw untextured until then, and for good if it fails to load.
+    Texture* loadTexture(const std::string& filePath);
+
+    // Estimated GPU memory held by the scene's meshes and textures. Meshes
+    // and textures shared with other scenes are counted in each of them.
+    size_t getResidentBytes() const;
 
     void setSpotLight(SpotLight* light);
 
     DrawableObject* findObjectByID(int id);
 
+    // Spatial queries over world-space object bounds.
+    void queryBox(const BoundingBox& box, std::vector<DrawableObject*>& results) const;
+    void querySphere(const glm::vec3& center, float radius, std::vector<DrawableObject*>& results) const;
+    DrawableObject* raycast(const glm::vec3& origin, const glm::vec3& direction, float maxDistance,
+        float* hitDistance = nullptr) const;
+    const DynamicBVH& getBVH() const { return bvh; }
+    const TransformStore& getTransformStore() const { return transformStore; }
+
     void putTree(const glm::vec3& position);
     void putTeren(const glm::vec3& position);
 
@@ -67,9 +212,14 @@ public:
     DrawableObject* getObject(size_t index);
     const DrawableObject* getObject(size_t index) const;
 
-    void setProjectionMatrix(const glm::mat4& proj) { projectionMatrix = proj; }
+    void setProjectionMatrix(const glm::mat4& proj) { projectionMatrix = proj; cameraDirty = true; }
     const glm::mat4& getViewMatrix() const { return viewMatrix; }
     const glm::mat4& getProjectionMatrix() const { return projectionMatrix; }
     SpotLight* getSpotLight() const { return spotlight; }
+    float getElapsedTime() const { return elapsedTime; }
+
+    void setFrustumCulling(bool enabled) { frustumCulling = enabled; }
+    bool isFrustumCullingEnabled() const { return frustumCulling; }
+    const CullingStats& getCullingStats() const { return cullingStats; }
 
 };
\ No newline at end of file
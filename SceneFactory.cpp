@@ -12,6 +12,7 @@
 #include "ScaleTransform.h"
 #include "RotateTransform.h"
 #include "Texture.h"
+#include "TextureCache.h"
 #include "WindowManager.h"
 #include "DynamicRotateTransform.h"
 #include <iostream>
@@ -40,6 +41,8 @@ Scene* SceneFactory::createScene(int sceneID, float aspectRatio)
         return createScene3(aspectRatio);
     case 4:
         return createScene4(aspectRatio);
+    case 5:
+        return createScene5(aspectRatio);
     default:
         std::cerr << "Invalid scene ID: " << sceneID << std::endl;
         return nullptr;
@@ -51,6 +54,13 @@ Scene* SceneFactory::createScene1(float aspectRatio)
     std::cout << "\nCreating Scene 1..." << std::endl;
     Scene* scene = new Scene();
 
+    // Decode on worker threads while the shaders compile.
+    TextureCache& textureCache = TextureCache::getInstance();
+    textureCache.prefetch("texture/grass.png");
+    textureCache.prefetch("texture/wooden_fence.png");
+    textureCache.prefetch("texture/shrek.png");
+    textureCache.prefetch("texture/fiona.png");
+
     ShaderProgram* phongShader = scene->createShader(
         "shaders/phong_vertex.glsl",
         "shaders/phong_fragment.glsl"
@@ -67,32 +77,24 @@ Scene* SceneFactory::createScene1(float aspectRatio)
     );
 
 
-    Texture* grassTexture = new Texture();
-    if (!grassTexture->loadFromFile("texture/grass.png")) {
+    Texture* grassTexture = scene->loadTexture("texture/grass.png");
+    if (grassTexture == nullptr) {
         std::cerr << "Failed to load grass texture!" << std::endl;
-        delete grassTexture;
-        grassTexture = nullptr;
     }
 
-    Texture* woodTexture = new Texture();
-    if (!woodTexture->loadFromFile("texture/wooden_fence.png")) {
+    Texture* woodTexture = scene->loadTexture("texture/wooden_fence.png");
+    if (woodTexture == nullptr) {
         std::cerr << "Failed to load wooden fence texture!" << std::endl;
-        delete woodTexture;
-        woodTexture = nullptr;
     }
 
-    Texture* shrekTexture = new Texture();
-    if (!shrekTexture->loadFromFile("texture/shrek.png")) {
+    Texture* shrekTexture = scene->loadTexture("texture/shrek.png");
+    if (shrekTexture == nullptr) {
         std::cerr << "Failed to load shrekTexture fence texture!" << std::endl;
-        delete shrekTexture;
-        shrekTexture = nullptr;
     }
 
-    Texture* fionaTexture = new Texture();
-    if (!fionaTexture->loadFromFile("texture/fiona.png")) {
+    Texture* fionaTexture = scene->loadTexture("texture/fiona.png");
+    if (fionaTexture == nullptr) {
         std::cerr << "Failed to load fionaTexture fence texture!" << std::endl;
-        delete fionaTexture;
-        fionaTexture = nullptr;
     }
 
     Camera* camera = new Camera(
@@ -141,39 +143,33 @@ Scene* SceneFactory::createScene1(float aspectRatio)
     SpotLightTracker* tracker = new SpotLightTracker(flashlight);
     camera->attach(tracker);
 
+    // The OBJ models are large; they stream in while the scene already runs.
     DrawableObject* teren = new DrawableObject();
     teren->setShader(lambertShader);
-    if (teren->loadModelFromOBJ("models/teren.obj")) {
-        teren->setTexture(grassTexture);
-        teren->setObjectColor(glm::vec3(0.2f, 0.6f, 0.2f));
-        teren->setShininess(32.0f);
-        scene->addObject(teren);
-    }
-    else {
-        std::cerr << "Failed to load teren.obj model!" << std::endl;
-        delete teren;
-    }
+    teren->loadModelFromOBJAsync("models/teren.obj");
+    teren->setTexture(grassTexture);
+    teren->setObjectColor(glm::vec3(0.2f, 0.6f, 0.2f));
+    teren->setShininess(32.0f);
+    scene->addObject(teren);
 
     DrawableObject* shrek = new DrawableObject(false);
     shrek->setShader(lambertShader);
 
-    if (shrek->loadModelFromOBJ("models/shrek.obj")) {
-        shrek->setTexture(shrekTexture);
-        shrek->addStaticTransform(new TranslateTransform(glm::vec3(-9.0f, 0.0f, 0.0f)));
-        shrek->addStaticTransform(new ScaleTransform(glm::vec3(2.0f, 2.0f, 2.0f)));
-        scene->addObject(shrek);
-    }
+    shrek->loadModelFromOBJAsync("models/shrek.obj");
+    shrek->setTexture(shrekTexture);
+    shrek->addStaticTransform(new TranslateTransform(glm::vec3(-9.0f, 0.0f, 0.0f)));
+    shrek->addStaticTransform(new ScaleTransform(glm::vec3(2.0f, 2.0f, 2.0f)));
+    scene->addObject(shrek);
 
     DrawableObject* fiona = new DrawableObject(false);
     fiona->setShader(lambertShader);
 
-    if (fiona->loadModelFromOBJ("models/fiona.obj")) {
-        fiona->setTexture(fionaTexture);
-        fiona->addStaticTransform(new TranslateTransform(glm::vec3(-5.0f, 0.0f, 0.0f)));
-        fiona->addStaticTransform(new ScaleTransform(glm::vec3(2.0f, 2.0f, 2.0f)));
-        fiona->addDynamicTransform(new DynamicRotateTransform(glm::vec3(0.0f, 1.0f, 0.0f), 60.0f));
-        scene->addObject(fiona);
-    }
+    fiona->loadModelFromOBJAsync("models/fiona.obj");
+    fiona->setTexture(fionaTexture);
+    fiona->addStaticTransform(new TranslateTransform(glm::vec3(-5.0f, 0.0f, 0.0f)));
+    fiona->addStaticTransform(new ScaleTransform(glm::vec3(2.0f, 2.0f, 2.0f)));
+    fiona->addDynamicTransform(new DynamicRotateTransform(glm::vec3(0.0f, 1.0f, 0.0f), 60.0f));
+    scene->addObject(fiona);
 
 
     DrawableObject* cubeFront = new DrawableObject(false);
@@ -222,23 +218,21 @@ Scene* SceneFactory::createScene1(float aspectRatio)
 
     DrawableObject* car = new DrawableObject(false);
     car->setShader(phongShader);
-    if (car->loadModelFromOBJ("models/formula1.obj")) {
-        car->setObjectColor(glm::vec3(0.8f, 0.2f, 0.4f));
-        car->setShininess(64.0f);
-        car->addStaticTransform(new TranslateTransform(glm::vec3(10.0f, 0.0f, 10.0f)));
-        car->addStaticTransform(new ScaleTransform(glm::vec3(0.25f, 0.25f, 0.25f)));
-        scene->addObject(car);
-    }
+    car->loadModelFromOBJAsync("models/formula1.obj");
+    car->setObjectColor(glm::vec3(0.8f, 0.2f, 0.4f));
+    car->setShininess(64.0f);
+    car->addStaticTransform(new TranslateTransform(glm::vec3(10.0f, 0.0f, 10.0f)));
+    car->addStaticTransform(new ScaleTransform(glm::vec3(0.25f, 0.25f, 0.25f)));
+    scene->addObject(car);
 
 
     DrawableObject* tree = new DrawableObject(false);
     tree->setShader(phongShader);
-    if (tree->loadModel("models/tree.h", "tree")) {
-        tree->setObjectColor(glm::vec3(0.3f, 0.2f, 0.1f));
-        tree->setShininess(96.0f);
-        tree->addStaticTransform(new TranslateTransform(glm::vec3(5.0f, 0.0f, 5.0f)));
-        scene->addObject(tree);
-    }
+    tree->loadModelAsync("models/tree.h", "tree");
+    tree->setObjectColor(glm::vec3(0.3f, 0.2f, 0.1f));
+    tree->setShininess(96.0f);
+    tree->addStaticTransform(new TranslateTransform(glm::vec3(5.0f, 0.0f, 5.0f)));
+    scene->addObject(tree);
 
 
     int gridSize = 3;
@@ -485,63 +479,52 @@ Scene* SceneFactory::createScene3(float aspectRatio)
     int treeCount = 0;
     int bushCount = 0;
 
+    // All instances share one load; they appear together once it is resident.
     for (int i = 0; i < 50; i++) {
         DrawableObject* tree = new DrawableObject(false);
         tree->setShader(lambertShader);
+        tree->loadModelAsync("models/tree.h", "tree");
+        tree->setObjectColor(glm::vec3(0.4f, 0.25f, 0.1f));
+        tree->setShininess(16.0f);
 
-        if (tree->loadModel("models/tree.h", "tree")) {
-            tree->setObjectColor(glm::vec3(0.4f, 0.25f, 0.1f));
-            tree->setShininess(16.0f);
-
-            float xPos, zPos;
-            do {
-                xPos = randomFloat(-30.0f, 30.0f);
-                zPos = randomFloat(-30.0f, 30.0f);
-            } while (sqrt(xPos * xPos + zPos * zPos) < 3.0f);
+        float xPos, zPos;
+        do {
+            xPos = randomFloat(-30.0f, 30.0f);
+            zPos = randomFloat(-30.0f, 30.0f);
+        } while (sqrt(xPos * xPos + zPos * zPos) < 3.0f);
 
-            float scale = randomFloat(0.8f, 1.5f);
+        float scale = randomFloat(0.8f, 1.5f);
 
-            float rotation = randomFloat(0.0f, 360.0f);
+        float rotation = randomFloat(0.0f, 360.0f);
 
-            tree->addStaticTransform(new TranslateTransform(glm::vec3(xPos, 0.0f, zPos)));
-            tree->addStaticTransform(new ScaleTransform(glm::vec3(scale, scale, scale)));
-            tree->addStaticTransform(new RotateTransform(glm::vec3(0.0f, 1.0f, 0.0f), glm::radians(rotation)));
+        tree->addStaticTransform(new TranslateTransform(glm::vec3(xPos, 0.0f, zPos)));
+        tree->addStaticTransform(new ScaleTransform(glm::vec3(scale, scale, scale)));
+        tree->addStaticTransform(new RotateTransform(glm::vec3(0.0f, 1.0f, 0.0f), glm::radians(rotation)));
 
-            scene->addObject(tree);
-            treeCount++;
-        }
-        else {
-            delete tree;
-            std::cerr << "Failed to load tree model!" << std::endl;
-        }
+        scene->addObject(tree);
+        treeCount++;
     }
 
     for (int i = 0; i < 50; i++) {
         DrawableObject* bush = new DrawableObject(false);
         bush->setShader(lambertShader);
+        bush->loadModelAsync("models/bushes.h", "bushes");
+        bush->setObjectColor(glm::vec3(0.1f, 0.5f, 0.1f));
 
-        if (bush->loadModel("models/bushes.h", "bushes")) {
-            bush->setObjectColor(glm::vec3(0.1f, 0.5f, 0.1f));
 
+        float xPos, zPos;
+        do {
+            xPos = randomFloat(-30.0f, 30.0f);
+            zPos = randomFloat(-30.0f, 30.0f);
+        } while (sqrt(xPos * xPos + zPos * zPos) < 3.0f);
 
-            float xPos, zPos;
-            do {
-                xPos = randomFloat(-30.0f, 30.0f);
-                zPos = randomFloat(-30.0f, 30.0f);
-            } while (sqrt(xPos * xPos + zPos * zPos) < 3.0f);
+        float scale = randomFloat(0.5f, 1.0f);
 
-            float scale = randomFloat(0.5f, 1.0f);
+        bush->addStaticTransform(new TranslateTransform(glm::vec3(xPos, 0.0f, zPos)));
+        bush->addStaticTransform(new ScaleTransform(glm::vec3(scale, scale, scale)));
 
-            bush->addStaticTransform(new TranslateTransform(glm::vec3(xPos, 0.0f, zPos)));
-            bush->addStaticTransform(new ScaleTransform(glm::vec3(scale, scale, scale)));
-
-            scene->addObject(bush);
-            bushCount++;
-        }
-        else {
-            delete bush;
-            std::cerr << "Failed to load bush model!" << std::endl;
-        }
+        scene->addObject(bush);
+        bushCount++;
     }
 
     int gridWidth = 4;
@@ -605,6 +588,8 @@ Scene* SceneFactory::createScene4(float aspectRatio)
 
     Scene* scene = new Scene();
 
+    TextureCache::getInstance().prefetch("texture/earth.jpg");
+
     ShaderProgram* constantShader = scene->createShader(
         "shaders/constant_vertex.glsl",
         "shaders/constant_fragment.glsl"
@@ -622,11 +607,9 @@ Scene* SceneFactory::createScene4(float aspectRatio)
         "shaders/lambert_fragment.glsl"
     );
 
-    Texture* earthTexture = new Texture();
-    if (!earthTexture->loadFromFile("texture/earth.jpg")) {
+    Texture* earthTexture = scene->loadTexture("texture/earth.jpg");
+    if (earthTexture == nullptr) {
         std::cerr << "Failed to load earthTexture!" << std::endl;
-        delete earthTexture;
-        earthTexture = nullptr;
     }
 
     Camera* camera = new Camera(
@@ -712,4 +695,154 @@ Scene* SceneFactory::createScene4(float aspectRatio)
     std::cout << "Scene 4 created!" << std::endl;
 
     return scene;
-}
\ No newline at end of file
+}
+
+Scene* SceneFactory::createScene5(float aspectRatio)
+{
+    std::cout << "\nCreating Scene 5" << std::endl;
+
+    Scene* scene = new Scene();
+
+    ShaderProgram* lambertShader = scene->createShader(
+        "shaders/lambert_vertex.glsl",
+        "shaders/lambert_fragment.glsl"
+    );
+    ShaderProgram* constantShader = scene->createShader(
+        "shaders/constant_vertex.glsl",
+        "shaders/constant_fragment.glsl"
+    );
+
+    Camera* camera = new Camera(
+        glm::vec3(0.0f, 12.0f, 60.0f),
+        glm::vec3(0.0f, 0.0f, 0.0f),
+        glm::vec3(0.0f, 1.0f, 0.0f),
+        45.0f,
+        aspectRatio,
+        0.1f,
+        300.0f
+    );
+    scene->setCamera(camera);
+
+    Light* moonlight = new Light(
+        glm::vec3(0.0f, 50.0f, 0.0f),
+        glm::vec3(0.05f, 0.05f, 0.08f),
+        0.1f,
+        1.0f, 0.007f, 0.0002f
+    );
+    scene->addLight(moonlight);
+
+    DrawableObject* ground = new DrawableObject(false);
+    ground->setShader(lambertShader);
+
+    if (ground->loadModelFromText("models/plain.txt")) {
+        ground->setObjectColor(glm::vec3(0.2f, 0.4f, 0.2f));
+        ground->addStaticTransform(new ScaleTransform(glm::vec3(100.0f, 1.0f, 100.0f)));
+        scene->addObject(ground);
+    }
+    else {
+        delete ground;
+    }
+
+    // A field of fireflies with short reach: far more lights than any one
+    // fragment is lit by, which is what clustered shading is for.
+    int gridSize = 32;
+    float spacing = 6.0f;
+    int fireflyCount = 0;
+
+    std::cout << "\nAdding LightObject... (fireflies)" << std::endl;
+    for (int z = 0; z < gridSize; z++) {
+        for (int x = 0; x < gridSize; x++) {
+            glm::vec3 center(
+                (x - gridSize / 2.0f + 0.5f) * spacing + randomFloat(-1.0f, 1.0f),
+                0.0f,
+                (z - gridSize / 2.0f + 0.5f) * spacing + randomFloat(-1.0f, 1.0f)
+            );
+
+            glm::vec3 color(randomFloat(0.6f, 1.0f), 1.0f, randomFloat(0.2f, 0.5f));
+
+            LightObject* firefly = new LightObject(
+                center,
+                2.5f,
+                0.3f,
+                2.5f,
+                color,
+                2.5f,
+                1.0f, 0.7f, 1.8f
+            );
+
+            firefly->setShader(constantShader);
+
+            if (firefly->loadModel("models/sphere.h", "sphere")) {
+                firefly->setObjectColor(color);
+                firefly->addStaticTransform(new ScaleTransform(glm::vec3(0.05f, 0.05f, 0.05f)));
+                firefly->setSpeed(randomFloat(1.0f, 2.5f));
+
+                scene->addLightObject(firefly);
+                fireflyCount++;
+            }
+            else {
+                delete firefly;
+            }
+        }
+    }
+
+    std::cout << "Fireflies: " << fireflyCount << std::endl;
+    std::cout << "Scene 5 created!" << std::endl;
+
+    return scene;
+}
+
+Scene* SceneFactory::createStressScene(size_t objectCount, float aspectRatio)
+{
+    std::cout << "\nCreating stress scene with " << objectCount << " objects..." << std::endl;
+    Scene* scene = new Scene();
+
+    ShaderProgram* lambertShader = scene->createShader(
+        "shaders/lambert_vertex.glsl",
+        "shaders/lambert_fragment.glsl"
+    );
+
+    Camera* camera = new Camera(
+        glm::vec3(0.0f, 40.0f, 80.0f),
+        glm::vec3(0.0f, 0.0f, 0.0f),
+        glm::vec3(0.0f, 1.0f, 0.0f),
+        60.0f,
+        aspectRatio,
+        0.1f,
+        500.0f
+    );
+    scene->setCamera(camera);
+
+    DrawableObject* previous = nullptr;
+
+    for (size_t i = 0; i < objectCount; i++) {
+        DrawableObject* obj = new DrawableObject(true);
+        obj->setShader(lambertShader);
+
+        if (!obj->loadModel("models/sphere.h", "sphere")) {
+            delete obj;
+            break;
+        }
+
+        float speed = randomFloat(10.0f, 90.0f);
+        obj->addDynamicTransform(new DynamicRotateTransform(glm::vec3(0.0f, 1.0f, 0.0f), speed));
+        obj->addDynamicTransform(new TranslateTransform(glm::vec3(randomFloat(5.0f, 60.0f), randomFloat(-10.0f, 10.0f), 0.0f)));
+
+        // Every 8th object orbits the previous one, every 4th stays on the
+        // component path through a non-uniform scale.
+        if (i % 8 == 7 && previous != nullptr) {
+            obj->setParent(previous);
+        }
+        else if (i % 4 == 3) {
+            obj->addDynamicTransform(new ScaleTransform(glm::vec3(1.0f, 0.5f, 1.0f)));
+        }
+
+        obj->addDynamicTransform(new DynamicRotateTransform(glm::vec3(1.0f, 0.0f, 0.0f), speed * 2.0f));
+        obj->addStaticTransform(new ScaleTransform(glm::vec3(0.2f)));
+
+        scene->addObject(obj);
+        previous = obj;
+    }
+
+    return scene;
+}
@@ -14,10 +14,15 @@ private:
     Scene* createScene2(float aspectRatio);
     Scene* createScene3(float aspectRatio);
     Scene* createScene4(float aspectRatio);
+    // Over a thousand moving point lights.
+    Scene* createScene5(float aspectRatio);
 
 public:
     SceneFactory();
     ~SceneFactory() = default;
 
     Scene* createScene(int sceneID, float aspectRatio);
+
+    // Many moving spheres, for measuring update cost.
+    Scene* createStressScene(size_t objectCount, float aspectRatio);
 };
\ No newline at end of file
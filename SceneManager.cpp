@@ -1,8 +1,24 @@
 #include "SceneManager.h"
+#include "JobSystem.h"
+#include <algorithm>
 #include <iostream>
+#include <vector>
+
+namespace
+{
+    const size_t DEFAULT_MEMORY_BUDGET = 256 * 1024 * 1024;
+
+    // The renderer may still draw the two previous frames.
+    const unsigned long long FRAMES_IN_FLIGHT = 2;
+
+    // Scene sizes change while models stream in, so the budget is also
+    // rechecked periodically.
+    const unsigned long long BUDGET_CHECK_INTERVAL = 60;
+}
 
 SceneManager::SceneManager()
-    : currentScene(nullptr), currentSceneID(-1)
+    : currentScene(nullptr), currentSceneID(-1),
+    memoryBudget(DEFAULT_MEMORY_BUDGET), autoPrefetch(false), frame(0), budgetDirty(false)
 {
 }
 
@@ -10,6 +26,18 @@ SceneManager::~SceneManager()
 {
 }
 
+void SceneManager::runTask(std::function<void()> task)
+{
+    if (runner)
+    {
+        runner(std::move(task));
+    }
+    else
+    {
+        task();
+    }
+}
+
 void SceneManager::addScene(int sceneID, Scene* scene)
 {
     if (scene == nullptr)
@@ -18,7 +46,10 @@ void SceneManager::addScene(int sceneID, Scene* scene)
         return;
     }
 
-    scenes[sceneID] = std::unique_ptr<Scene>(scene);
+    SceneEntry& entry = scenes[sceneID];
+    entry.builder = nullptr;
+    entry.scene.reset(scene);
+    entry.state = SCENE_READY;
 
     if (currentScene == nullptr)
     {
@@ -29,6 +60,86 @@ void SceneManager::addScene(int sceneID, Scene* scene)
     std::cout << "Scene " << sceneID << " added. Total scenes: " << scenes.size() << "\n";
 }
 
+void SceneManager::registerScene(int sceneID, SceneBuilder builder)
+{
+    if (!builder)
+    {
+        std::cerr << "ERROR: Cannot register scene " << sceneID << " without a builder\n";
+        return;
+    }
+
+    scenes[sceneID].builder = std::move(builder);
+    std::cout << "Scene " << sceneID << " registered. Total scenes: " << scenes.size() << "\n";
+}
+
+void SceneManager::build(SceneEntry& entry)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (entry.state != SCENE_UNLOADED)
+        {
+            return;
+        }
+        entry.state = SCENE_BUILDING;
+    }
+
+    // Entries are never erased while scenes exist, so the pointer stays valid.
+    SceneEntry* target = &entry;
+    auto finish = [this, target](Scene* scene) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            target->scene.reset(scene);
+            target->state = scene != nullptr ? SCENE_READY : SCENE_UNLOADED;
+            budgetDirty = true;
+        }
+        buildCondition.notify_all();
+    };
+
+    if (!invoker)
+    {
+        runTask([target, finish] { finish(target->builder()); });
+        return;
+    }
+
+    // Files are read and parsed on the job system. The context thread only
+    // runs the GL calls, one task at a time, and keeps presenting frames
+    // in between.
+    GLInvoker::Function glInvoker = invoker;
+    auto job = [target, finish, glInvoker] {
+        GLInvoker::Scope scope(glInvoker);
+        finish(target->builder());
+    };
+
+    // Without worker threads nothing would pick the job up.
+    JobSystem& jobs = JobSystem::getInstance();
+    if (jobs.getThreadCount() > 1)
+    {
+        jobs.scheduleBackground(job);
+    }
+    else
+    {
+        job();
+    }
+}
+
+void SceneManager::waitForBuilds()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    buildCondition.wait(lock, [this] {
+        return std::none_of(scenes.begin(), scenes.end(),
+            [](const std::pair<const int, SceneEntry>& pair) { return pair.second.state == SCENE_BUILDING; });
+    });
+}
+
+void SceneManager::setInvoker(GLInvoker::Function glInvoker)
+{
+    if (!glInvoker)
+    {
+        waitForBuilds();
+    }
+    invoker = std::move(glInvoker);
+}
+
 void SceneManager::switchScene(int sceneID)
 {
     auto it = scenes.find(sceneID);
@@ -39,17 +150,227 @@ void SceneManager::switchScene(int sceneID)
         return;
     }
 
-    currentScene = it->second.get();
-    currentSceneID = sceneID;
+    SceneEntry& entry = it->second;
+    build(entry);
+
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        buildCondition.wait(lock, [&entry] { return entry.state != SCENE_BUILDING; });
+
+        if (!entry.scene)
+        {
+            std::cerr << "ERROR: Scene " << sceneID << " could not be built\n";
+            return;
+        }
+
+        if (currentSceneID != -1 && currentSceneID != sceneID)
+        {
+            transitions[currentSceneID][sceneID]++;
+        }
+
+        currentScene = entry.scene.get();
+        currentSceneID = sceneID;
+        entry.lastUsedFrame = frame;
+        budgetDirty = true;
+    }
 
     std::cout << "Switched to scene " << sceneID << "\n";
+
+    if (autoPrefetch)
+    {
+        prefetchLikelyNext();
+    }
+}
+
+void SceneManager::prefetchScene(int sceneID)
+{
+    auto it = scenes.find(sceneID);
+    if (it == scenes.end() || !it->second.builder)
+    {
+        return;
+    }
+
+    SceneEntry& entry = it->second;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (entry.state != SCENE_UNLOADED)
+        {
+            return;
+        }
+
+        // A scene known to overflow the budget would only be evicted again.
+        size_t resident = 0;
+        for (const auto& pair : scenes)
+        {
+            if (pair.second.state == SCENE_READY)
+            {
+                resident += pair.second.residentBytes;
+            }
+        }
+        if (resident + entry.residentBytes > memoryBudget)
+        {
+            return;
+        }
+    }
+
+    std::cout << "Prefetching scene " << sceneID << "\n";
+    build(entry);
+}
+
+void SceneManager::prefetchLikelyNext()
+{
+    int nextID = -1;
+    unsigned int bestCount = 0;
+
+    auto history = transitions.find(currentSceneID);
+    if (history != transitions.end())
+    {
+        for (const auto& pair : history->second)
+        {
+            if (pair.second > bestCount)
+            {
+                bestCount = pair.second;
+                nextID = pair.first;
+            }
+        }
+    }
+
+    // Without history, guess the next scene in order.
+    if (nextID == -1 && !scenes.empty())
+    {
+        auto next = scenes.upper_bound(currentSceneID);
+        nextID = next != scenes.end() ? next->first : scenes.begin()->first;
+    }
+
+    if (nextID != currentSceneID)
+    {
+        prefetchScene(nextID);
+    }
 }
 
-Scene* SceneManager::getCurrentScene() const
+void SceneManager::update()
 {
-    auto it = scenes.find(currentSceneID);
-    if (it != scenes.end()) {
-        return it->second.get();
+    frame++;
+
+    auto current = scenes.find(currentSceneID);
+    if (current != scenes.end())
+    {
+        current->second.lastUsedFrame = frame;
+    }
+
+    if (budgetDirty || frame % BUDGET_CHECK_INTERVAL == 0)
+    {
+        enforceBudget();
     }
-    return nullptr;
-}
\ No newline at end of file
+}
+
+void SceneManager::enforceBudget()
+{
+    std::vector<Scene*> evicted;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        budgetDirty = false;
+
+        size_t resident = 0;
+        std::vector<SceneEntry*> candidates;
+
+        for (auto& pair : scenes)
+        {
+            SceneEntry& entry = pair.second;
+            if (entry.state != SCENE_READY)
+            {
+                continue;
+            }
+
+            // Scenes that are not current do not change, but their models
+            // may have streamed in since the last measurement.
+            entry.residentBytes = entry.scene->getResidentBytes();
+            resident += entry.residentBytes;
+
+            bool inFlight = entry.lastUsedFrame != 0 && entry.lastUsedFrame + FRAMES_IN_FLIGHT >= frame;
+            if (entry.builder && pair.first != currentSceneID && !inFlight)
+            {
+                candidates.push_back(&entry);
+            }
+        }
+
+        // Never shown (prefetched) scenes sort first, then least recently used.
+        std::sort(candidates.begin(), candidates.end(), [](const SceneEntry* a, const SceneEntry* b) {
+            return a->lastUsedFrame < b->lastUsedFrame;
+        });
+
+        for (SceneEntry* entry : candidates)
+        {
+            if (resident <= memoryBudget)
+            {
+                break;
+            }
+
+            resident -= entry->residentBytes;
+            evicted.push_back(entry->scene.release());
+            entry->state = SCENE_UNLOADED;
+            entry->lastUsedFrame = 0;
+        }
+    }
+
+    for (Scene* scene : evicted)
+    {
+        std::cout << "Evicting scene (" << scene->getResidentBytes() / 1024 << " KB)\n";
+        runTask([scene] { delete scene; });
+    }
+}
+
+void SceneManager::setMemoryBudget(size_t bytes)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    memoryBudget = bytes;
+    budgetDirty = true;
+}
+
+size_t SceneManager::getResidentBytes()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    size_t total = 0;
+    for (const auto& pair : scenes)
+    {
+        if (pair.second.state == SCENE_READY)
+        {
+            total += pair.second.scene->getResidentBytes();
+        }
+    }
+    return total;
+}
+
+void SceneManager::printStats()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    std::cout << "\n=== Scene Manager ===\n";
+    for (const auto& pair : scenes)
+    {
+        const SceneEntry& entry = pair.second;
+        const char* state = entry.state == SCENE_READY ? "resident"
+            : entry.state == SCENE_BUILDING ? "building" : "unloaded";
+
+        std::cout << "Scene " << pair.first << ": " << state;
+        if (entry.state == SCENE_READY)
+        {
+            std::cout << ", " << entry.scene->getResidentBytes() / 1024 << " KB";
+        }
+        std::cout << (pair.first == currentSceneID ? " (current)" : "") << "\n";
+    }
+    std::cout << "Budget: " << memoryBudget / (1024 * 1024) << " MB\n";
+    std::cout << "========================\n";
+}
+
+void SceneManager::clear()
+{
+    // Builds under way have to finish before their entries go.
+    waitForBuilds();
+
+    scenes.clear();
+    transitions.clear();
+    currentScene = nullptr;
+    currentSceneID = -1;
+}
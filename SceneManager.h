@@ -1,21 +1,98 @@
 #pragma once
-#include <unordered_map>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <map>
 #include <memory>
+#include <mutex>
+#include "GLInvoker.h"
 #include "Scene.h"
 
+// Builds scenes on first use and keeps recently used ones resident within
+// a GPU memory budget, evicting the least recently used. Scenes are
+// destroyed through the task runner, which must execute tasks on the
+// thread that owns the GL context; without one they run inline. Builds go
+// through the runner as well, unless an invoker is set: then they run on
+// the job system and only their GL calls are handed to the invoker.
 class SceneManager
 {
+public:
+    typedef std::function<Scene*()> SceneBuilder;
+    typedef std::function<void(std::function<void()>)> TaskRunner;
+
 private:
-    std::unordered_map<int, std::unique_ptr<Scene>> scenes;
+    enum SceneState { SCENE_UNLOADED, SCENE_BUILDING, SCENE_READY };
+
+    struct SceneEntry
+    {
+        SceneBuilder builder;
+        std::unique_ptr<Scene> scene;
+        SceneState state;
+        // Frame the scene was last current in; 0 if it never was.
+        unsigned long long lastUsedFrame;
+        // Last measured size, kept after eviction to decide on prefetching.
+        size_t residentBytes;
+
+        SceneEntry() : state(SCENE_UNLOADED), lastUsedFrame(0), residentBytes(0) {}
+    };
+
+    std::map<int, SceneEntry> scenes;
+    // How often each scene was switched to from another, for prefetching.
+    std::map<int, std::map<int, unsigned int>> transitions;
     Scene* currentScene;
     int currentSceneID;
 
+    TaskRunner runner;
+    GLInvoker::Function invoker;
+    size_t memoryBudget;
+    bool autoPrefetch;
+    unsigned long long frame;
+    // Set by builds finishing on the runner's thread.
+    std::atomic<bool> budgetDirty;
+
+    // Guards entry state and scenes while a build runs on another thread.
+    std::mutex mutex;
+    std::condition_variable buildCondition;
+
+    void build(SceneEntry& entry);
+    void runTask(std::function<void()> task);
+    void waitForBuilds();
+    void prefetchLikelyNext();
+    void enforceBudget();
+
 public:
     SceneManager();
     ~SceneManager();
 
+    // A prebuilt scene; it is never evicted.
     void addScene(int sceneID, Scene* scene);
+    // A scene built on its first switchScene() or prefetchScene().
+    void registerScene(int sceneID, SceneBuilder builder);
+
+    // Builds the scene if needed; waits for a prefetch that is under way.
     void switchScene(int sceneID);
-    Scene* getCurrentScene() const;
+    // Starts building the scene without waiting for it.
+    void prefetchScene(int sceneID);
+
+    // Call once per frame after the frame was submitted; evicts scenes over
+    // budget once no frame in flight can reference them.
+    void update();
+
+    void setTaskRunner(TaskRunner taskRunner) { runner = std::move(taskRunner); }
+    // Runs a task on the context thread and returns once it has run. Clearing
+    // it waits for the builds that use it.
+    void setInvoker(GLInvoker::Function glInvoker);
+    void setMemoryBudget(size_t bytes);
+    size_t getMemoryBudget() const { return memoryBudget; }
+    // Prefetch the most likely next scene after every switch. Only useful
+    // when the runner does not block the caller.
+    void setAutoPrefetch(bool enabled) { autoPrefetch = enabled; }
+
+    size_t getResidentBytes();
+    void printStats();
+
+    // Destroys scenes on the calling thread, which must own the context.
+    void clear();
+    Scene* getCurrentScene() const { return currentScene; }
     int getCurrentSceneID() const { return currentSceneID; }
-};
\ No newline at end of file
+};
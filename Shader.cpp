@@ -1,6 +1,5 @@
 #include "Shader.h"
-#include <fstream>
-#include <sstream>
+#include "ShaderPreprocessor.h"
 #include <iostream>
 
 Shader::Shader()
@@ -13,23 +12,6 @@ Shader::~Shader()
     deleteShader();
 }
 
-std::string Shader::readFile(const std::string& filePath)
-{
-    std::ifstream file(filePath);
-
-    if (!file.is_open())
-    {
-        std::cerr << "ERROR: Unable to open shader file: " << filePath << "\n";
-        return "";
-    }
-
-    std::stringstream buffer;
-    buffer << file.rdbuf();
-    file.close();
-
-    return buffer.str();
-}
-
 bool Shader::checkCompilation()
 {
     GLint status;
@@ -49,6 +31,11 @@ bool Shader::checkCompilation()
 
         std::cerr << "ERROR: " << typeStr << " Shader compilation failed!\n";
         std::cerr << "File: " << shaderPath << "\n";
+        // Messages give the source number of included files before the line.
+        for (size_t i = 1; i < sourceFiles.size(); i++)
+        {
+            std::cerr << "Source " << i << ": " << sourceFiles[i] << "\n";
+        }
         std::cerr << "Log: " << infoLog << "\n";
 
         delete[] infoLog;
@@ -86,17 +73,18 @@ bool Shader::createShader(GLenum type, const std::string& sourceCode)
     return checkCompilation();
 }
 
-bool Shader::createShaderFromFile(GLenum type, const std::string& filePath)
+bool Shader::createShaderFromFile(GLenum type, const std::string& filePath, const std::string& defines)
 {
     shaderPath = filePath;
-    std::string sourceCode = readFile(filePath);
 
-    if (sourceCode.empty())
+    ShaderPreprocessor preprocessor;
+    if (!preprocessor.process(filePath, defines))
     {
         return false;
     }
 
-    return createShader(type, sourceCode);
+    sourceFiles = preprocessor.getFiles();
+    return createShader(type, preprocessor.getSource());
 }
 
 void Shader::attachToProgram(GLuint programID)
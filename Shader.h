@@ -1,6 +1,7 @@
 #pragma once
 #include <GL/glew.h>
 #include <string>
+#include <vector>
 
 class Shader
 {
@@ -8,8 +9,9 @@ private:
     GLuint shaderID;
     GLenum shaderType;
     std::string shaderPath;
+    // Files pasted together by the preprocessor, by #line source number.
+    std::vector<std::string> sourceFiles;
 
-    std::string readFile(const std::string& filePath);
     bool checkCompilation();
 
 public:
@@ -18,7 +20,8 @@ public:
 
     bool createShader(GLenum type, const std::string& sourceCode);
 
-    bool createShaderFromFile(GLenum type, const std::string& filePath);
+    // Resolves #include directives; defines go right after #version.
+    bool createShaderFromFile(GLenum type, const std::string& filePath, const std::string& defines = "");
 
     void attachToProgram(GLuint programID);
 
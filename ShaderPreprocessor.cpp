@@ -0,0 +1,115 @@
+#include "ShaderPreprocessor.h"
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <iostream>
+
+namespace
+{
+    // Name of the preprocessor directive on the line, or an empty string.
+    // rest is left at what follows the name.
+    std::string getDirective(const std::string& line, size_t& rest)
+    {
+        size_t pos = line.find_first_not_of(" \t");
+        if (pos == std::string::npos || line[pos] != '#')
+        {
+            return "";
+        }
+
+        pos = line.find_first_not_of(" \t", pos + 1);
+        if (pos == std::string::npos)
+        {
+            return "";
+        }
+
+        size_t end = pos;
+        while (end < line.size() && std::isalpha(static_cast<unsigned char>(line[end])))
+        {
+            end++;
+        }
+
+        rest = end;
+        return line.substr(pos, end - pos);
+    }
+
+    std::string getDirectory(const std::string& filePath)
+    {
+        size_t slash = filePath.find_last_of("/\\");
+        return slash == std::string::npos ? "" : filePath.substr(0, slash + 1);
+    }
+
+    std::string makeLineDirective(int line, int fileIndex)
+    {
+        return "#line " + std::to_string(line) + " " + std::to_string(fileIndex) + "\n";
+    }
+}
+
+bool ShaderPreprocessor::process(const std::string& filePath, const std::string& variantDefines)
+{
+    defines = variantDefines;
+    files.assign(1, filePath);
+    source.clear();
+
+    return expand(filePath, 0);
+}
+
+bool ShaderPreprocessor::expand(const std::string& filePath, int fileIndex)
+{
+    std::ifstream file(filePath);
+
+    if (!file.is_open())
+    {
+        std::cerr << "ERROR: Unable to open shader file: " << filePath << "\n";
+        return false;
+    }
+
+    const std::string directory = getDirectory(filePath);
+
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(file, line))
+    {
+        lineNumber++;
+
+        size_t rest = 0;
+        std::string directive = getDirective(line, rest);
+
+        if (directive == "version" && fileIndex == 0)
+        {
+            source += line + "\n";
+            source += defines;
+            source += makeLineDirective(lineNumber + 1, fileIndex);
+            continue;
+        }
+
+        if (directive != "include")
+        {
+            source += line + "\n";
+            continue;
+        }
+
+        size_t open = line.find('"', rest);
+        size_t close = open == std::string::npos ? std::string::npos : line.find('"', open + 1);
+        if (close == std::string::npos)
+        {
+            std::cerr << "ERROR: Malformed #include in " << filePath << ":" << lineNumber << "\n";
+            return false;
+        }
+
+        std::string includePath = directory + line.substr(open + 1, close - open - 1);
+        if (std::find(files.begin(), files.end(), includePath) == files.end())
+        {
+            int includeIndex = static_cast<int>(files.size());
+            files.push_back(includePath);
+
+            source += makeLineDirective(1, includeIndex);
+            if (!expand(includePath, includeIndex))
+            {
+                return false;
+            }
+        }
+        source += makeLineDirective(lineNumber + 1, fileIndex);
+    }
+
+    return true;
+}
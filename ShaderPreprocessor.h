@@ -0,0 +1,25 @@
+#pragma once
+#include <string>
+#include <vector>
+
+// Expands #include "file" directives in GLSL sources, which the compiler
+// does not support itself. Paths are relative to the including file and
+// every file is pasted at most once, so shared headers need no guards.
+// Defines are inserted right after #version, where the first one has to
+// stay. #line directives keep compiler messages pointing at the original
+// files; their source-string numbers index the returned file list.
+class ShaderPreprocessor
+{
+private:
+    std::string defines;
+    std::vector<std::string> files;
+    std::string source;
+
+    bool expand(const std::string& filePath, int fileIndex);
+
+public:
+    bool process(const std::string& filePath, const std::string& defines);
+
+    const std::string& getSource() const { return source; }
+    const std::vector<std::string>& getFiles() const { return files; }
+};
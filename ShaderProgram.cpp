@@ -1,14 +1,37 @@
 #include "ShaderProgram.h"
-#include "Camera.h"
+#include "ShaderVariantCache.h"
+#include "UniformBlocks.h"
+#include "VertexAttributes.h"
 #include <glm/gtc/type_ptr.hpp>
+#include <algorithm>
 #include <iostream>
 
+namespace
+{
+    const char* const uniformNames[] = {
+        "textureUnitID",
+        "useTexture",
+        "lightTexels",
+        "lightClusterTexels",
+        "lightIndexTexels",
+        "objectLightIndexTexels"
+    };
+
+    static_assert(sizeof(uniformNames) / sizeof(uniformNames[0]) == static_cast<size_t>(UniformID::Count),
+        "uniformNames must match UniformID");
+}
+
 ShaderProgram::ShaderProgram()
     : programID(0)
+    , generic(false)
+    , variantFamily(-1)
     , attribPosition(-1)
     , attribNormal(-1)
     , attribTexCoord(-1)
 {
+    std::fill(std::begin(uniformHandles), std::end(uniformHandles), -1);
+    variants.fill(nullptr);
+
     programID = glCreateProgram();
 }
 
@@ -21,14 +44,14 @@ ShaderProgram::~ShaderProgram()
 }
 
 bool ShaderProgram::loadFromFiles(const std::string& vertexPath,
-    const std::string& fragmentPath)
+    const std::string& fragmentPath, const std::string& defines)
 {
-    if (!addShader(GL_VERTEX_SHADER, vertexPath))
+    if (!addShader(GL_VERTEX_SHADER, vertexPath, defines))
     {
         return false;
     }
 
-    if (!addShader(GL_FRAGMENT_SHADER, fragmentPath))
+    if (!addShader(GL_FRAGMENT_SHADER, fragmentPath, defines))
     {
         return false;
     }
@@ -38,14 +61,20 @@ bool ShaderProgram::loadFromFiles(const std::string& vertexPath,
         return false;
     }
 
+    generic = defines.empty();
+    if (generic)
+    {
+        variantFamily = ShaderVariantCache::getInstance().getFamily(vertexPath, fragmentPath);
+    }
+
     return true;
 }
 
-bool ShaderProgram::addShader(GLenum type, const std::string& filePath)
+bool ShaderProgram::addShader(GLenum type, const std::string& filePath, const std::string& defines)
 {
     auto shader = std::make_unique<Shader>();
 
-    if (!shader->createShaderFromFile(type, filePath))
+    if (!shader->createShaderFromFile(type, filePath, defines))
     {
         return false;
     }
@@ -73,6 +102,7 @@ bool ShaderProgram::addShaderFromSource(GLenum type, const std::string& sourceCo
 
 bool ShaderProgram::link()
 {
+    bindAttributeLocations();
     glLinkProgram(programID);
 
     if (!checkLinking()) {
@@ -80,10 +110,34 @@ bool ShaderProgram::link()
     }
 
     queryAttributeLocations();
+    reflectUniforms();
+    resolveUniformHandles();
+    bindUniformBlocks();
 
     return true;
 }
 
+ShaderProgram* ShaderProgram::getVariant(const ShaderVariantKey& key)
+{
+    if (!generic)
+    {
+        return this;
+    }
+
+    ShaderProgram*& variant = variants[key.getIndex()];
+    if (variant == nullptr)
+    {
+        ShaderProgram* program = nullptr;
+        if (!ShaderVariantCache::getInstance().find(variantFamily, key, program))
+        {
+            return this;
+        }
+        // A variant that failed to build leaves the work to this program.
+        variant = program != nullptr ? program : this;
+    }
+    return variant;
+}
+
 bool ShaderProgram::checkLinking()
 {
     GLint status;
@@ -115,6 +169,95 @@ void ShaderProgram::queryAttributeLocations()
     attribTexCoord = glGetAttribLocation(programID, "vt");
 }
 
+void ShaderProgram::bindAttributeLocations()
+{
+    glBindAttribLocation(programID, ATTRIB_POSITION, "vp");
+    glBindAttribLocation(programID, ATTRIB_NORMAL, "vn");
+    glBindAttribLocation(programID, ATTRIB_TEXCOORD, "vt");
+    glBindAttribLocation(programID, ATTRIB_INSTANCE_MODEL, "instanceModelMatrix");
+    glBindAttribLocation(programID, ATTRIB_INSTANCE_NORMAL, "instanceNormalMatrix");
+    glBindAttribLocation(programID, ATTRIB_INSTANCE_COLOR, "instanceColor");
+    glBindAttribLocation(programID, ATTRIB_INSTANCE_SHININESS, "instanceShininess");
+    glBindAttribLocation(programID, ATTRIB_INSTANCE_LIGHTS, "instanceLights");
+}
+
+void ShaderProgram::reflectUniforms()
+{
+    uniforms.clear();
+
+    GLint activeCount = 0;
+    GLint maxNameLength = 0;
+    glGetProgramiv(programID, GL_ACTIVE_UNIFORMS, &activeCount);
+    glGetProgramiv(programID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxNameLength);
+
+    std::vector<char> nameBuffer(maxNameLength + 1);
+    uniforms.reserve(activeCount);
+
+    for (GLint i = 0; i < activeCount; i++)
+    {
+        GLsizei nameLength = 0;
+        UniformInfo info;
+        glGetActiveUniform(programID, i, static_cast<GLsizei>(nameBuffer.size()), &nameLength,
+            &info.size, &info.type, nameBuffer.data());
+
+        info.name.assign(nameBuffer.data(), nameLength);
+
+        // Plain arrays are reported as "name[0]"; index them by their base name.
+        if (info.name.size() > 3 && info.name.compare(info.name.size() - 3, 3, "[0]") == 0)
+        {
+            info.name.resize(info.name.size() - 3);
+        }
+
+        info.location = glGetUniformLocation(programID, info.name.c_str());
+
+        // Uniforms inside a uniform block have no location.
+        if (info.location != -1)
+        {
+            uniforms.push_back(std::move(info));
+        }
+    }
+
+    std::sort(uniforms.begin(), uniforms.end(),
+        [](const UniformInfo& a, const UniformInfo& b) { return a.name < b.name; });
+}
+
+void ShaderProgram::resolveUniformHandles()
+{
+    for (int i = 0; i < static_cast<int>(UniformID::Count); i++)
+    {
+        uniformHandles[i] = getUniformLocation(uniformNames[i]);
+    }
+}
+
+void ShaderProgram::bindUniformBlocks()
+{
+    bindUniformBlock("LightBlock", LIGHT_BLOCK_BINDING);
+    bindUniformBlock("FrameBlock", FRAME_BLOCK_BINDING);
+
+    // Samplers of the light lists never change, so they are set once here.
+    if (hasUniform(UniformID::LightTexels))
+    {
+        glUseProgram(programID);
+        setUniform(UniformID::LightTexels, static_cast<int>(LIGHT_DATA_TEXTURE_UNIT));
+        setUniform(UniformID::LightClusterTexels, static_cast<int>(LIGHT_CLUSTER_TEXTURE_UNIT));
+        setUniform(UniformID::LightIndexTexels, static_cast<int>(LIGHT_INDEX_TEXTURE_UNIT));
+        setUniform(UniformID::ObjectLightIndexTexels, static_cast<int>(OBJECT_LIGHT_INDEX_TEXTURE_UNIT));
+        glUseProgram(0);
+    }
+}
+
+bool ShaderProgram::bindUniformBlock(const std::string& blockName, GLuint bindingPoint)
+{
+    GLuint blockIndex = glGetUniformBlockIndex(programID, blockName.c_str());
+    if (blockIndex == GL_INVALID_INDEX)
+    {
+        return false;
+    }
+
+    glUniformBlockBinding(programID, blockIndex, bindingPoint);
+    return true;
+}
+
 void ShaderProgram::use() const
 {
     glUseProgram(programID);
@@ -125,19 +268,46 @@ void ShaderProgram::unuse() const
     glUseProgram(0);
 }
 
-GLint ShaderProgram::getUniformLocation(const std::string& name)
+GLint ShaderProgram::getUniformLocation(const std::string& name) const
+{
+    auto it = std::lower_bound(uniforms.begin(), uniforms.end(), name,
+        [](const UniformInfo& info, const std::string& key) { return info.name < key; });
+
+    if (it != uniforms.end() && it->name == name)
+    {
+        return it->location;
+    }
+    return -1;
+}
+
+void ShaderProgram::setUniform(GLint location, float value)
 {
-    GLint location = glGetUniformLocation(programID, name.c_str());
-    return location;
+    glUniform1f(location, value);
 }
 
-void ShaderProgram::onCameraChanged(Camera* camera)
+void ShaderProgram::setUniform(GLint location, int value)
 {
-    if (!camera) return;
+    glUniform1i(location, value);
+}
 
-    use();
-    setUniform("viewMatrix", camera->getCamera());
-    setUniform("projectionMatrix", camera->getProjectionMatrix());
+void ShaderProgram::setUniform(GLint location, const glm::vec3& vec)
+{
+    glUniform3fv(location, 1, glm::value_ptr(vec));
+}
+
+void ShaderProgram::setUniform(GLint location, const glm::vec4& vec)
+{
+    glUniform4fv(location, 1, glm::value_ptr(vec));
+}
+
+void ShaderProgram::setUniform(GLint location, const glm::mat3& matrix)
+{
+    glUniformMatrix3fv(location, 1, GL_FALSE, glm::value_ptr(matrix));
+}
+
+void ShaderProgram::setUniform(GLint location, const glm::mat4& matrix)
+{
+    glUniformMatrix4fv(location, 1, GL_FALSE, glm::value_ptr(matrix));
 }
 
 void ShaderProgram::setUniform(const std::string& name, float value)
@@ -1,5 +1,6 @@
 ﻿#pragma once
 #include <GL/glew.h>
+#include <array>
 #include <string>
 #include <vector>
 #include <memory>
@@ -8,40 +9,96 @@
 #include <glm/vec3.hpp>
 #include <glm/vec4.hpp>
 #include "Shader.h"
-#include "CameraObserver.h"
+#include "ShaderVariant.h"
 
-class Camera;
+enum class UniformID
+{
+    TextureUnit,
+    UseTexture,
+    LightTexels,
+    LightClusterTexels,
+    LightIndexTexels,
+    ObjectLightIndexTexels,
+    Count
+};
 
-class ShaderProgram : public CameraObserver
+struct UniformInfo
+{
+    std::string name;
+    GLint location;
+    GLenum type;
+    GLint size;
+};
+
+class ShaderProgram
 {
 private:
     GLuint programID;
     std::vector<std::unique_ptr<Shader>> shaders;
 
+    // A program loaded from files without defines is generic: it decides
+    // every variant feature at run time and can hand out variants
+    // specialised for them, looked up by the family of its files.
+    bool generic;
+    int variantFamily;
+    // Variants settled so far, by ShaderVariantKey::getIndex().
+    std::array<ShaderProgram*, ShaderVariantKey::COUNT> variants;
+
     GLint attribPosition;  
     GLint attribNormal;
     GLint attribTexCoord;
 
+    // Active uniforms reflected once after linking, sorted by name.
+    std::vector<UniformInfo> uniforms;
+
+    GLint uniformHandles[static_cast<int>(UniformID::Count)];
+
     bool checkLinking();
 
+    void bindAttributeLocations();
     void queryAttributeLocations();
+    void reflectUniforms();
+    void resolveUniformHandles();
+    void bindUniformBlocks();
 
 public:
     ShaderProgram();
     ~ShaderProgram();
 
     bool loadFromFiles(const std::string& vertexPath,
-        const std::string& fragmentPath);
+        const std::string& fragmentPath, const std::string& defines = "");
 
-    bool addShader(GLenum type, const std::string& filePath);
+    bool addShader(GLenum type, const std::string& filePath, const std::string& defines = "");
     bool addShaderFromSource(GLenum type, const std::string& sourceCode);
 
     bool link();
 
+    // Simulation thread. The variant of this program built for key, or the
+    // program itself until the variant has been compiled on the GL thread.
+    ShaderProgram* getVariant(const ShaderVariantKey& key);
+
     void use() const;
     void unuse() const;
 
-    GLint getUniformLocation(const std::string& name);
+    GLint getUniformLocation(const std::string& name) const;
+    bool bindUniformBlock(const std::string& blockName, GLuint bindingPoint);
+
+    GLint getUniformHandle(UniformID id) const { return uniformHandles[static_cast<int>(id)]; }
+    bool hasUniform(UniformID id) const { return getUniformHandle(id) != -1; }
+    // Whether the program shades with the scene's point lights.
+    bool usesLights() const { return hasUniform(UniformID::LightTexels); }
+
+    const std::vector<UniformInfo>& getActiveUniforms() const { return uniforms; }
+
+    void setUniform(GLint location, float value);
+    void setUniform(GLint location, int value);
+    void setUniform(GLint location, const glm::vec3& vec);
+    void setUniform(GLint location, const glm::vec4& vec);
+    void setUniform(GLint location, const glm::mat3& matrix);
+    void setUniform(GLint location, const glm::mat4& matrix);
+
+    template <typename T>
+    void setUniform(UniformID id, const T& value) { setUniform(getUniformHandle(id), value); }
 
     void setUniform(const std::string& name, float value);
     void setUniform(const std::string& name, int value);
@@ -55,8 +112,6 @@ public:
     void setUniform(const std::string& name, const glm::mat4& matrix);
     void setUniform(const std::string& name, bool value);
 
-    void onCameraChanged(Camera* camera) override;
-
     GLuint getID() const { return programID; }
 
     GLint getPositionAttribLocation() const { return attribPosition; }
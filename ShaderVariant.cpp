@@ -0,0 +1,65 @@
+#include "ShaderVariant.h"
+
+namespace
+{
+    constexpr size_t bucketSizes[] = { 0, 1, 2, 4, 8 };
+
+    static_assert(sizeof(bucketSizes) / sizeof(bucketSizes[0]) == LIGHT_BUCKET_CLUSTERED,
+        "bucketSizes must match LightBucket");
+    static_assert(bucketSizes[LIGHT_BUCKET_CLUSTERED - 1] == ShaderVariantKey::MAX_LIST_LIGHTS,
+        "the largest bucket must hold MAX_LIST_LIGHTS");
+}
+
+LightBucket ShaderVariantKey::getListBucket(size_t count)
+{
+    int bucket = LIGHT_BUCKET_NONE;
+    while (bucketSizes[bucket] < count)
+    {
+        bucket++;
+    }
+    return static_cast<LightBucket>(bucket);
+}
+
+std::string ShaderVariantKey::getDefines() const
+{
+    std::string defines = "#define VARIANT\n";
+    if (textured)
+    {
+        defines += "#define TEXTURED\n";
+    }
+    if (spotlight)
+    {
+        defines += "#define SPOTLIGHT\n";
+    }
+    if (lightBucket == LIGHT_BUCKET_CLUSTERED)
+    {
+        defines += "#define CLUSTERED_LIGHT_LISTS\n";
+    }
+    else
+    {
+        defines += "#define LIGHT_LIST_SIZE " + std::to_string(bucketSizes[lightBucket]) + "\n";
+    }
+    return defines;
+}
+
+std::string ShaderVariantKey::getName() const
+{
+    std::string name = textured ? "textured" : "untextured";
+    if (spotlight)
+    {
+        name += ", spotlight";
+    }
+    if (lightBucket == LIGHT_BUCKET_CLUSTERED)
+    {
+        name += ", clustered lights";
+    }
+    else if (lightBucket == LIGHT_BUCKET_NONE)
+    {
+        name += ", no lights";
+    }
+    else
+    {
+        name += ", up to " + std::to_string(bucketSizes[lightBucket]) + " lights";
+    }
+    return name;
+}
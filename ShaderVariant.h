@@ -0,0 +1,42 @@
+#pragma once
+#include <cstddef>
+#include <string>
+
+// How many point lights a variant loops over. Objects take the smallest
+// bucket that holds their list, so objects with similar lists share a
+// program.
+enum LightBucket
+{
+    LIGHT_BUCKET_NONE,
+    LIGHT_BUCKET_1,
+    LIGHT_BUCKET_2,
+    LIGHT_BUCKET_4,
+    LIGHT_BUCKET_8,
+    // Lights come from the clustered lists instead.
+    LIGHT_BUCKET_CLUSTERED,
+    LIGHT_BUCKET_COUNT
+};
+
+// What a program variant is specialised for. The shaders see the key as
+// #defines (VARIANT, then TEXTURED, SPOTLIGHT and LIGHT_LIST_SIZE or
+// CLUSTERED_LIGHT_LISTS), so none of it is tested per fragment. The
+// lighting model is not part of the key: it is fixed by the shader files.
+struct ShaderVariantKey
+{
+    static const int COUNT = 2 * 2 * LIGHT_BUCKET_COUNT;
+    // Longest light list of an object that a variant can loop over.
+    static const size_t MAX_LIST_LIGHTS = 8;
+
+    bool textured;
+    bool spotlight;
+    LightBucket lightBucket;
+
+    ShaderVariantKey() : textured(false), spotlight(false), lightBucket(LIGHT_BUCKET_NONE) {}
+
+    // count must not exceed MAX_LIST_LIGHTS.
+    static LightBucket getListBucket(size_t count);
+
+    int getIndex() const { return (lightBucket * 2 + (spotlight ? 1 : 0)) * 2 + (textured ? 1 : 0); }
+    std::string getDefines() const;
+    std::string getName() const;
+};
@@ -0,0 +1,156 @@
+#include "ShaderVariantCache.h"
+#include "ShaderProgram.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+ShaderVariantCache* ShaderVariantCache::instance = nullptr;
+
+ShaderVariantCache::ShaderVariantCache()
+    : compiledCount(0), failedCount(0), compileTime(0.0)
+{
+}
+
+ShaderVariantCache::~ShaderVariantCache()
+{
+}
+
+ShaderVariantCache& ShaderVariantCache::getInstance()
+{
+    if (!instance)
+        instance = new ShaderVariantCache();
+    return *instance;
+}
+
+void ShaderVariantCache::destroy()
+{
+    if (instance)
+    {
+        delete instance;
+        instance = nullptr;
+    }
+}
+
+int ShaderVariantCache::getFamily(const std::string& vertexPath, const std::string& fragmentPath)
+{
+    std::string name = vertexPath + "|" + fragmentPath;
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto it = familyIDs.find(name);
+    if (it != familyIDs.end())
+    {
+        return it->second;
+    }
+
+    int family = static_cast<int>(families.size());
+    families.push_back({ vertexPath, fragmentPath });
+    familyIDs[name] = family;
+    return family;
+}
+
+bool ShaderVariantCache::find(int family, const ShaderVariantKey& key, ShaderProgram*& program)
+{
+    int id = family * ShaderVariantKey::COUNT + key.getIndex();
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto it = variants.find(id);
+    if (it != variants.end())
+    {
+        program = it->second.get();
+        return true;
+    }
+
+    bool queued = std::any_of(requests.begin(), requests.end(),
+        [id](const VariantRequest& request) { return request.id == id; });
+    if (!queued)
+    {
+        requests.push_back({ id, family, key });
+    }
+
+    program = nullptr;
+    return false;
+}
+
+void ShaderVariantCache::process(double budgetSeconds)
+{
+    std::vector<VariantRequest> pending;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (requests.empty())
+        {
+            return;
+        }
+        pending.swap(requests);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    auto elapsed = [&start] {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    };
+
+    std::vector<VariantRequest> waiting;
+    bool compiled = false;
+
+    for (VariantRequest& request : pending)
+    {
+        if (compiled && elapsed() >= budgetSeconds)
+        {
+            waiting.push_back(std::move(request));
+            continue;
+        }
+
+        // Asked for again while an earlier call compiled it.
+        Family family;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (variants.count(request.id) != 0)
+            {
+                continue;
+            }
+            family = families[request.family];
+        }
+
+        auto program = std::make_unique<ShaderProgram>();
+        if (!program->loadFromFiles(family.vertexPath, family.fragmentPath, request.key.getDefines()))
+        {
+            std::cerr << "ERROR: Shader variant (" << request.key.getName() << ") of "
+                << family.vertexPath << " + " << family.fragmentPath << " could not be built" << std::endl;
+            program.reset();
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        (program ? compiledCount : failedCount)++;
+        variants[request.id] = std::move(program);
+        compiled = true;
+    }
+
+    double time = elapsed();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    compileTime += time;
+    // Requests made while this ran go after the ones that were already waiting.
+    for (VariantRequest& request : requests)
+    {
+        waiting.push_back(std::move(request));
+    }
+    requests.swap(waiting);
+}
+
+size_t ShaderVariantCache::getPendingCount()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return requests.size();
+}
+
+void ShaderVariantCache::printStats()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    std::cout << "\n=== Shader Variant Cache ===\n";
+    std::cout << "Pending: " << requests.size() << "\n";
+    std::cout << "Compiled: " << compiledCount << ", failed: " << failedCount << "\n";
+    std::cout << "Time on the GL thread: " << compileTime * 1000.0 << " ms\n";
+    std::cout << "========================\n";
+}
@@ -0,0 +1,72 @@
+#pragma once
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "ShaderVariant.h"
+
+class ShaderProgram;
+
+// Program variants by shader files and variant key. Variants are compiled
+// the first time they are asked for, on the GL thread and within a time
+// budget, and are shared by every scene drawing with the same files. Each
+// pair of files is registered once as a family; lookups then go by the
+// family and the key's index.
+class ShaderVariantCache
+{
+private:
+    static ShaderVariantCache* instance;
+
+    struct Family
+    {
+        std::string vertexPath;
+        std::string fragmentPath;
+    };
+
+    struct VariantRequest
+    {
+        int id;
+        int family;
+        ShaderVariantKey key;
+    };
+
+    std::mutex mutex;
+    std::vector<Family> families;
+    std::unordered_map<std::string, int> familyIDs;
+    // By family * ShaderVariantKey::COUNT + key index. Null for variants
+    // that failed to build, so they are not retried.
+    std::unordered_map<int, std::unique_ptr<ShaderProgram>> variants;
+    std::vector<VariantRequest> requests;
+
+    size_t compiledCount;
+    size_t failedCount;
+    double compileTime;
+
+    ShaderVariantCache();
+
+public:
+    ~ShaderVariantCache();
+
+    ShaderVariantCache(const ShaderVariantCache&) = delete;
+    ShaderVariantCache& operator=(const ShaderVariantCache&) = delete;
+
+    static ShaderVariantCache& getInstance();
+    // Deletes the programs; needs the GL context.
+    static void destroy();
+
+    // Any thread. The same files always give the same family.
+    int getFamily(const std::string& vertexPath, const std::string& fragmentPath);
+
+    // Any thread. Returns false while the variant is still being compiled;
+    // the first call queues it. Once it returns true, program is the
+    // variant, or null if it could not be built.
+    bool find(int family, const ShaderVariantKey& key, ShaderProgram*& program);
+
+    // GL thread only. Compiles queued variants until budgetSeconds have
+    // passed; at least one per call.
+    void process(double budgetSeconds);
+
+    size_t getPendingCount();
+    void printStats();
+};
@@ -1,6 +1,8 @@
 #include "SpotLight.h"
-#include "ShaderProgram.h"
+#include "Light.h"
+#include "UniformBlocks.h"
 #include <glm/gtc/type_ptr.hpp>
+#include <algorithm>
 #include <iostream>
 
 SpotLight::SpotLight(const glm::vec3& position,
@@ -22,6 +24,7 @@ SpotLight::SpotLight(const glm::vec3& position,
     , linear(linear)
     , quadratic(quadratic)
     , enabled(true)
+    , version(0)
 {
     std::cout << "\nSpotLight created at position: ("
         << position.x << ", " << position.y << ", " << position.z << ")" << std::endl;
@@ -30,27 +33,32 @@ SpotLight::SpotLight(const glm::vec3& position,
 void SpotLight::setPosition(const glm::vec3& pos)
 {
     position = pos;
+    version++;
 }
 
 void SpotLight::setDirection(const glm::vec3& dir)
 {
     direction = glm::normalize(dir);
+    version++;
 }
 
 void SpotLight::setColor(const glm::vec3& col)
 {
     color = col;
+    version++;
 }
 
 void SpotLight::setIntensity(float inten)
 {
     intensity = inten;
+    version++;
 }
 
 void SpotLight::setCutOff(float cutOffAngle, float outerCutOffAngle)
 {
     cutOff = cutOffAngle;
     outerCutOff = outerCutOffAngle;
+    version++;
 }
 
 void SpotLight::setAttenuation(float c, float l, float q)
@@ -58,23 +66,30 @@ void SpotLight::setAttenuation(float c, float l, float q)
     constant = c;
     linear = l;
     quadratic = q;
+    version++;
 }
 
 void SpotLight::setEnabled(bool isEnabled)
 {
     enabled = isEnabled;
+    version++;
 }
 
-void SpotLight::applyToShader(ShaderProgram& shader, const std::string& uniformName) const
+void SpotLight::applyToBlock(SpotLightData& data) const
 {
-    shader.setUniform(uniformName + ".position", position);
-    shader.setUniform(uniformName + ".direction", direction);
-    shader.setUniform(uniformName + ".color", color);
-    shader.setUniform(uniformName + ".intensity", intensity);
-    shader.setUniform(uniformName + ".cutOff", glm::cos(glm::radians(cutOff)));
-    shader.setUniform(uniformName + ".outerCutOff", glm::cos(glm::radians(outerCutOff)));
-    shader.setUniform(uniformName + ".constant", constant);
-    shader.setUniform(uniformName + ".linear", linear);
-    shader.setUniform(uniformName + ".quadratic", quadratic);
-    shader.setUniform(uniformName + ".enabled", enabled ? 1 : 0);
-}
\ No newline at end of file
+    data.position = position;
+    data.intensity = intensity;
+    data.direction = direction;
+    data.cutOff = glm::cos(glm::radians(cutOff));
+    data.color = color;
+    data.outerCutOff = glm::cos(glm::radians(outerCutOff));
+    data.constant = constant;
+    data.linear = linear;
+    data.quadratic = quadratic;
+    data.enabled = enabled ? 1 : 0;
+}
+
+float SpotLight::getRadius() const
+{
+    return Light::computeRadius(intensity * std::max(color.x, std::max(color.y, color.z)), constant, linear, quadratic);
+}
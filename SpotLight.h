@@ -2,7 +2,7 @@
 #include <glm/vec3.hpp>
 #include <string>
 
-class ShaderProgram;
+struct SpotLightData;
 
 class SpotLight
 {
@@ -22,6 +22,8 @@ private:
 
     bool enabled;
 
+    unsigned int version;
+
 public:
     SpotLight(const glm::vec3& position = glm::vec3(0.0f),
         const glm::vec3& direction = glm::vec3(0.0f, 0.0f, -1.0f),
@@ -53,6 +55,9 @@ public:
     float getLinear() const { return linear; }
     float getQuadratic() const { return quadratic; }
     bool isEnabled() const { return enabled; }
+    unsigned int getVersion() const { return version; }
+    // Reach of the cone, as Light::getRadius().
+    float getRadius() const;
 
-    void applyToShader(ShaderProgram& shader, const std::string& uniformName = "spotlight") const;
+    void applyToBlock(SpotLightData& data) const;
 };
\ No newline at end of file
@@ -1,7 +1,7 @@
 #include "StaticTransformComponent.h"
 
 StaticTransformComponent::StaticTransformComponent()
-    : cachedMatrix(1.0f), isDirty(true)
+    : cachedMatrix(1.0f), addCount(0), cachedVersion(0)
 {
 }
 
@@ -14,7 +14,7 @@ void StaticTransformComponent::add(ITransformComponent* component)
     if (component)
     {
         components.push_back(std::unique_ptr<ITransformComponent>(component));
-        isDirty = true;
+        addCount++;
     }
 }
 
@@ -25,23 +25,30 @@ void StaticTransformComponent::updateCachedMatrix()
     {
         cachedMatrix = cachedMatrix * component->getMatrix();
     }
-    isDirty = false;
+    cachedVersion = getVersion();
 }
 
 glm::mat4 StaticTransformComponent::getMatrix() const
 {
-    if (isDirty)
+    if (getVersion() != cachedVersion)
     {
         const_cast<StaticTransformComponent*>(this)->updateCachedMatrix();
     }
     return cachedMatrix;
 }
 
-void StaticTransformComponent::update(float deltaTime)
+void StaticTransformComponent::update(float)
 {
-    for (auto& component : components)
+    // Static components do not change over time; the cached matrix is only
+    // rebuilt when a component is added or changed through a setter.
+}
+
+unsigned int StaticTransformComponent::getVersion() const
+{
+    unsigned int version = addCount;
+    for (const auto& component : components)
     {
-        component->update(deltaTime);
+        version += component->getVersion();
     }
-    isDirty = true;
+    return version;
 }
\ No newline at end of file
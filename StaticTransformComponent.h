@@ -8,7 +8,8 @@ class StaticTransformComponent : public ITransformComponent
 private:
     std::vector<std::unique_ptr<ITransformComponent>> components;
     glm::mat4 cachedMatrix;
-    bool isDirty;
+    unsigned int addCount;
+    unsigned int cachedVersion;
 
     void updateCachedMatrix();
 
@@ -18,4 +19,5 @@ public:
     void add(ITransformComponent* component);
     glm::mat4 getMatrix() const override;
     void update(float deltaTime) override;
+    unsigned int getVersion() const override;
 };
\ No newline at end of file
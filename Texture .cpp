@@ -1,14 +1,83 @@
 #include "Texture.h"
+#include "MappedFile.h"
 #include <iostream>
 
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
 
+namespace
+{
+    // Grey and grey-alpha images are stored in one or two channels and
+    // expanded when sampled.
+    void getPixelFormat(int channels, GLenum& internalFormat, GLenum& pixelFormat)
+    {
+        switch (channels) {
+        case 1:
+            internalFormat = GL_R8;
+            pixelFormat = GL_RED;
+            break;
+        case 2:
+            internalFormat = GL_RG8;
+            pixelFormat = GL_RG;
+            break;
+        case 3:
+            internalFormat = GL_RGB8;
+            pixelFormat = GL_RGB;
+            break;
+        default:
+            internalFormat = GL_RGBA8;
+            pixelFormat = GL_RGBA;
+            break;
+        }
+    }
+
+    // BC1 is only cooked for opaque images, so its 1-bit alpha goes unused.
+    GLenum getCompressedFormat(TextureFormat format)
+    {
+        return format == TEXTURE_BC3 ? GL_COMPRESSED_RGBA_S3TC_DXT5_EXT : GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+    }
+}
+
+TextureImage::TextureImage()
+    : width(0)
+    , height(0)
+    , channels(0)
+    , format(TEXTURE_UNCOMPRESSED)
+    , pixels(nullptr, stbi_image_free)
+{
+}
+
+size_t TextureImage::getBytes() const
+{
+    size_t total = 0;
+    for (const TextureLevel& level : levels) {
+        total += level.size;
+    }
+    return total;
+}
+
+size_t TextureImage::getRowPitch(size_t level) const
+{
+    return getLevelSize(format, channels, levels[level].width, getRowAlignment());
+}
+
+size_t TextureImage::getLevelSize(TextureFormat format, int channels, int width, int height)
+{
+    if (format == TEXTURE_UNCOMPRESSED) {
+        return static_cast<size_t>(width) * height * channels;
+    }
+
+    size_t blocks = static_cast<size_t>((width + 3) / 4) * ((height + 3) / 4);
+    return blocks * (format == TEXTURE_BC1 ? 8 : 16);
+}
+
 Texture::Texture()
     : textureID(0)
     , width(0)
     , height(0)
     , channels(0)
+    , format(TEXTURE_UNCOMPRESSED)
+    , bytes(0)
     , isLoaded(false)
 {
 }
@@ -21,41 +90,111 @@ Texture::~Texture()
     }
 }
 
+std::unique_ptr<TextureImage> Texture::decode(const std::string& filepath)
+{
+    auto image = std::make_unique<TextureImage>();
+    image->path = filepath;
+
+    // The thread-local setting keeps concurrent decodes from racing on it.
+    stbi_set_flip_vertically_on_load_thread(true);
+
+    image->pixels.reset(stbi_load(filepath.c_str(), &image->width, &image->height, &image->channels, 0));
+
+    if (!image->pixels) {
+        std::cerr << "ERROR: Failed to load texture: " << filepath << std::endl;
+        std::cerr << "Reason: " << stbi_failure_reason() << std::endl;
+        return nullptr;
+    }
+
+    TextureLevel level;
+    level.width = image->width;
+    level.height = image->height;
+    level.data = image->pixels.get();
+    level.size = TextureImage::getLevelSize(TEXTURE_UNCOMPRESSED, image->channels, image->width, image->height);
+    image->levels.push_back(level);
+
+    return image;
+}
+
 bool Texture::loadFromFile(const std::string& filepath)
+{
+    std::cout << "\nLoading texture: " << filepath << std::endl;
+
+    std::unique_ptr<TextureImage> image = decode(filepath);
+    if (!image) {
+        return false;
+    }
+
+    return upload(*image);
+}
+
+bool Texture::upload(const TextureImage& image)
+{
+    if (!allocate(image)) {
+        return false;
+    }
+
+    for (size_t i = 0; i < image.levels.size(); i++) {
+        uploadRows(image, i, 0, image.levels[i].height, image.levels[i].data);
+    }
+
+    complete(image);
+    return true;
+}
+
+bool Texture::allocate(const TextureImage& image)
 {
     if (textureID != 0) {
         glDeleteTextures(1, &textureID);
         textureID = 0;
+        isLoaded = false;
     }
 
-    std::cout << "\nLoading texture: " << filepath << std::endl;
+    if (image.levels.empty()) {
+        return false;
+    }
 
-    stbi_set_flip_vertically_on_load(true);
+    width = image.width;
+    height = image.height;
+    channels = image.channels;
+    format = image.format;
 
-    unsigned char* data = stbi_load(filepath.c_str(), &width, &height, &channels, 4);
+    GLenum internalFormat;
+    GLenum pixelFormat;
+    getPixelFormat(channels, internalFormat, pixelFormat);
 
-    if (!data) {
-        std::cerr << "ERROR: Failed to load texture: " << filepath << std::endl;
-        std::cerr << "Reason: " << stbi_failure_reason() << std::endl;
-        return false;
+    while (glGetError() != GL_NO_ERROR) {
     }
 
     glGenTextures(1, &textureID);
     glBindTexture(GL_TEXTURE_2D, textureID);
 
-    glTexImage2D(
-        GL_TEXTURE_2D,     
-        0,               
-        GL_RGBA,
-        width,
-        height, 
-        0,
-        GL_RGBA,
-        GL_UNSIGNED_BYTE,
-        data
-    );
+    for (size_t i = 0; i < image.levels.size(); i++) {
+        const TextureLevel& level = image.levels[i];
 
-    glGenerateMipmap(GL_TEXTURE_2D);
+        if (image.isCompressed()) {
+            glCompressedTexImage2D(GL_TEXTURE_2D, static_cast<GLint>(i), getCompressedFormat(format),
+                level.width, level.height, 0, static_cast<GLsizei>(level.size), nullptr);
+        }
+        else {
+            glTexImage2D(GL_TEXTURE_2D, static_cast<GLint>(i), internalFormat,
+                level.width, level.height, 0, pixelFormat, GL_UNSIGNED_BYTE, nullptr);
+        }
+    }
+
+    // Decoded images come without mips; cooked ones carry the whole chain.
+    if (image.levels.size() == 1 && !image.isCompressed()) {
+        bytes = image.getBytes() * 4 / 3;
+    }
+    else {
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, static_cast<GLint>(image.levels.size() - 1));
+        bytes = image.getBytes();
+    }
+
+    if (!image.isCompressed() && channels < 3) {
+        GLint swizzle[4] = { GL_RED, GL_RED, GL_RED, channels == 2 ? GL_GREEN : GL_ONE };
+        glTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_RGBA, swizzle);
+    }
 
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
@@ -65,14 +204,56 @@ bool Texture::loadFromFile(const std::string& filepath)
 
     glBindTexture(GL_TEXTURE_2D, 0);
 
-    stbi_image_free(data);
-
-    isLoaded = true;
-    std::cout << "Texture loaded successfully (ID: " << textureID << ")" << std::endl;
+    if (glGetError() != GL_NO_ERROR) {
+        std::cerr << "ERROR: Texture upload rejected: " << image.path << std::endl;
+        glDeleteTextures(1, &textureID);
+        textureID = 0;
+        bytes = 0;
+        return false;
+    }
 
     return true;
 }
 
+void Texture::uploadRows(const TextureImage& image, size_t level, int firstRow, int rowCount, const void* data)
+{
+    const TextureLevel& target = image.levels[level];
+
+    glBindTexture(GL_TEXTURE_2D, textureID);
+
+    if (image.isCompressed()) {
+        // Block rows: firstRow is a multiple of 4, the last band may be shorter.
+        size_t size = (rowCount + 3) / 4 * image.getRowPitch(level);
+        glCompressedTexSubImage2D(GL_TEXTURE_2D, static_cast<GLint>(level), 0, firstRow,
+            target.width, rowCount, getCompressedFormat(format), static_cast<GLsizei>(size), data);
+    }
+    else {
+        GLenum internalFormat;
+        GLenum pixelFormat;
+        getPixelFormat(channels, internalFormat, pixelFormat);
+
+        // Rows of RGB and grey images are not 4-byte aligned.
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glTexSubImage2D(GL_TEXTURE_2D, static_cast<GLint>(level), 0, firstRow,
+            target.width, rowCount, pixelFormat, GL_UNSIGNED_BYTE, data);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    }
+
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+void Texture::complete(const TextureImage& image)
+{
+    if (image.levels.size() == 1 && !image.isCompressed()) {
+        glBindTexture(GL_TEXTURE_2D, textureID);
+        glGenerateMipmap(GL_TEXTURE_2D);
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+
+    isLoaded.store(true, std::memory_order_release);
+    std::cout << "Texture loaded successfully (ID: " << textureID << ")" << std::endl;
+}
+
 void Texture::bind(GLuint textureUnit) const
 {
     if (!isLoaded) {
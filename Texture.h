@@ -1,6 +1,61 @@
 #pragma once
 #include <GL/glew.h>
+#include <atomic>
+#include <memory>
 #include <string>
+#include <vector>
+
+class MappedFile;
+
+enum TextureFormat
+{
+    // Uncompressed, one to four 8-bit channels.
+    TEXTURE_UNCOMPRESSED = 0,
+    // 4x4 blocks: BC1 is 8 bytes per block with 1-bit alpha at most, BC3
+    // adds 8 bytes of interpolated alpha.
+    TEXTURE_BC1 = 1,
+    TEXTURE_BC3 = 2
+};
+
+struct TextureLevel
+{
+    int width;
+    int height;
+    const unsigned char* data;
+    size_t size;
+};
+
+// Pixels ready for upload, either decoded from an image file (one level,
+// mips are generated on the GPU) or mapped from a cooked .tex file (every
+// level, possibly block compressed). Loading needs no GL context, so it can
+// run on any thread; only Texture::upload() has to happen on the GL thread.
+struct TextureImage
+{
+    std::string path;
+    int width;
+    int height;
+    int channels;
+    TextureFormat format;
+    std::vector<TextureLevel> levels;
+
+    // Owns the level data of decoded images.
+    std::unique_ptr<unsigned char, void(*)(void*)> pixels;
+    // Owns the level data of cooked images.
+    std::shared_ptr<MappedFile> mapping;
+
+    TextureImage();
+
+    bool isCompressed() const { return format != TEXTURE_UNCOMPRESSED; }
+    size_t getBytes() const;
+
+    // Rows are uploaded in groups of getRowAlignment() (4 for block
+    // compressed formats); getRowPitch() is the size of one such group.
+    int getRowAlignment() const { return isCompressed() ? 4 : 1; }
+    size_t getRowPitch(size_t level) const;
+
+    // Bytes of one level; blocks are rounded up for compressed formats.
+    static size_t getLevelSize(TextureFormat format, int channels, int width, int height);
+};
 
 class Texture
 {
@@ -9,7 +64,10 @@ private:
     int width;
     int height;
     int channels;
-    bool isLoaded;
+    TextureFormat format;
+    // Both are read by the simulation thread while a texture streams in.
+    std::atomic<size_t> bytes;
+    std::atomic<bool> isLoaded;
 
 public:
     Texture();
@@ -17,6 +75,20 @@ public:
 
     bool loadFromFile(const std::string& filepath);
 
+    // Keeps the file's channel count. Returns nullptr if the file cannot be
+    // decoded. Thread-safe.
+    static std::unique_ptr<TextureImage> decode(const std::string& filepath);
+    // Fails if the driver rejects the format, e.g. without S3TC support.
+    bool upload(const TextureImage& image);
+
+    // Streaming upload, GL thread only: allocate() creates storage for every
+    // level, uploadRows() fills rows of one level from the bound
+    // GL_PIXEL_UNPACK_BUFFER (data is then an offset into it) or from client
+    // memory, and complete() makes the texture usable.
+    bool allocate(const TextureImage& image);
+    void uploadRows(const TextureImage& image, size_t level, int firstRow, int rowCount, const void* data);
+    void complete(const TextureImage& image);
+
     void bind(GLuint textureUnit = 0) const;
 
     void unbind() const;
@@ -25,8 +97,11 @@ public:
     int getWidth() const { return width; }
     int getHeight() const { return height; }
     int getChannels() const { return channels; }
-    bool isTextureLoaded() const { return isLoaded; }
+    TextureFormat getFormat() const { return format; }
+    bool isTextureLoaded() const { return isLoaded.load(std::memory_order_acquire); }
+    // GPU memory including the mip chain.
+    size_t getBytes() const { return bytes; }
 
     Texture(const Texture&) = delete;
     Texture& operator=(const Texture&) = delete;
-};
\ No newline at end of file
+};
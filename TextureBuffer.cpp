@@ -0,0 +1,64 @@
+#include "TextureBuffer.h"
+#include <algorithm>
+
+namespace
+{
+    // Never empty, so the texture always has storage attached.
+    const GLsizeiptr MIN_CAPACITY = 256;
+}
+
+TextureBuffer::TextureBuffer(GLuint textureUnit, GLenum internalFormat)
+    : bufferID(0)
+    , textureID(0)
+    , textureUnit(textureUnit)
+    , capacity(MIN_CAPACITY)
+{
+    glGenBuffers(1, &bufferID);
+    glBindBuffer(GL_TEXTURE_BUFFER, bufferID);
+    glBufferData(GL_TEXTURE_BUFFER, capacity, nullptr, GL_STREAM_DRAW);
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+
+    glGenTextures(1, &textureID);
+    glBindTexture(GL_TEXTURE_BUFFER, textureID);
+    glTexBuffer(GL_TEXTURE_BUFFER, internalFormat, bufferID);
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+}
+
+TextureBuffer::~TextureBuffer()
+{
+    if (textureID != 0)
+    {
+        glDeleteTextures(1, &textureID);
+        textureID = 0;
+    }
+    if (bufferID != 0)
+    {
+        glDeleteBuffers(1, &bufferID);
+        bufferID = 0;
+    }
+}
+
+void TextureBuffer::update(const void* data, GLsizeiptr dataSize)
+{
+    if (dataSize > capacity)
+    {
+        capacity = std::max(dataSize, capacity * 2);
+    }
+
+    // Orphaning the old storage lets the GPU keep reading last frame's
+    // contents while this frame's are written.
+    glBindBuffer(GL_TEXTURE_BUFFER, bufferID);
+    glBufferData(GL_TEXTURE_BUFFER, capacity, nullptr, GL_STREAM_DRAW);
+    if (dataSize > 0)
+    {
+        glBufferSubData(GL_TEXTURE_BUFFER, 0, dataSize, data);
+    }
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+}
+
+void TextureBuffer::bind() const
+{
+    glActiveTexture(GL_TEXTURE0 + textureUnit);
+    glBindTexture(GL_TEXTURE_BUFFER, textureID);
+    glActiveTexture(GL_TEXTURE0);
+}
@@ -0,0 +1,29 @@
+#pragma once
+#include <GL/glew.h>
+
+// Buffer object read by shaders through a samplerBuffer bound to a fixed
+// texture unit. Unlike a uniform block it has no fixed size: the storage
+// grows to fit whatever is uploaded.
+class TextureBuffer
+{
+private:
+    GLuint bufferID;
+    GLuint textureID;
+    GLuint textureUnit;
+    GLsizeiptr capacity;
+
+public:
+    TextureBuffer(GLuint textureUnit, GLenum internalFormat);
+    ~TextureBuffer();
+
+    // Replaces the whole contents.
+    void update(const void* data, GLsizeiptr dataSize);
+    void bind() const;
+
+    GLuint getID() const { return bufferID; }
+    GLuint getTextureUnit() const { return textureUnit; }
+    GLsizeiptr getCapacity() const { return capacity; }
+
+    TextureBuffer(const TextureBuffer&) = delete;
+    TextureBuffer& operator=(const TextureBuffer&) = delete;
+};
@@ -0,0 +1,252 @@
+#include "TextureCache.h"
+#include "TextureFile.h"
+#include "TextureUploadQueue.h"
+#include "JobSystem.h"
+#include <chrono>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+TextureCache* TextureCache::instance = nullptr;
+
+TextureCache::TextureCache()
+    : runningDecodes(0), hitCount(0), missCount(0)
+{
+}
+
+TextureCache::~TextureCache()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    decodesDone.wait(lock, [this] { return runningDecodes == 0; });
+}
+
+TextureCache& TextureCache::getInstance()
+{
+    if (!instance)
+        instance = new TextureCache();
+    return *instance;
+}
+
+void TextureCache::destroy()
+{
+    if (instance)
+    {
+        delete instance;
+        instance = nullptr;
+    }
+}
+
+TextureImageFuture TextureCache::decodeAsync(const std::string& filePath)
+{
+    auto promise = std::make_shared<std::promise<std::shared_ptr<TextureImage>>>();
+    TextureImageFuture future = promise->get_future().share();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        auto pending = decoding.find(filePath);
+        if (pending != decoding.end())
+        {
+            return pending->second;
+        }
+
+        // Kept until loadTextureAsync() picks the image up, so a prefetched
+        // image is not decoded twice.
+        decoding[filePath] = future;
+        runningDecodes++;
+    }
+
+    auto job = [this, filePath, promise] {
+        promise->set_value(loadImage(filePath));
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (releaseWhenDecoded.erase(filePath) != 0)
+        {
+            decoding.erase(filePath);
+        }
+        runningDecodes--;
+        // Under the lock: the destructor may run as soon as it is released.
+        decodesDone.notify_all();
+    };
+
+    // Without worker threads nothing would pick the job up.
+    JobSystem& jobs = JobSystem::getInstance();
+    if (jobs.getThreadCount() > 1)
+    {
+        jobs.scheduleBackground(job);
+    }
+    else
+    {
+        job();
+    }
+
+    return future;
+}
+
+std::shared_ptr<TextureImage> TextureCache::loadImage(const std::string& filePath)
+{
+    std::shared_ptr<TextureImage> image = loadCooked(filePath);
+    if (image)
+    {
+        return image;
+    }
+    return Texture::decode(filePath);
+}
+
+std::shared_ptr<TextureImage> TextureCache::loadCooked(const std::string& filePath)
+{
+    std::string cookedPath = TextureFile::getCookedPath(filePath);
+
+    std::error_code error;
+    if (!std::filesystem::exists(cookedPath, error))
+    {
+        return nullptr;
+    }
+
+    // A missing source is fine (shipping only cooked files), a newer one is not.
+    if (std::filesystem::exists(filePath, error) &&
+        std::filesystem::last_write_time(filePath, error) > std::filesystem::last_write_time(cookedPath, error))
+    {
+        std::cout << "Cooked texture is older than its source, ignoring: " << cookedPath << "\n";
+        return nullptr;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::shared_ptr<TextureImage> image = TextureFile::load(cookedPath);
+    if (!image)
+    {
+        return nullptr;
+    }
+    image->path = filePath;
+
+    double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    // Formatted separately: loads run on several threads and cout's flags are shared.
+    std::ostringstream message;
+    message << "Texture mapped: " << cookedPath << " (" << image->levels.size() << " levels, "
+        << std::fixed << std::setprecision(3) << milliseconds << " ms)\n";
+    std::cout << message.str();
+
+    return image;
+}
+
+void TextureCache::prefetch(const std::string& filePath)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = textures.find(filePath);
+        if (it != textures.end() && !it->second.expired())
+        {
+            return;
+        }
+    }
+
+    decodeAsync(filePath);
+}
+
+std::shared_ptr<Texture> TextureCache::loadTextureAsync(const std::string& filePath)
+{
+    std::shared_ptr<Texture> texture;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = textures.find(filePath);
+        if (it != textures.end())
+        {
+            texture = it->second.lock();
+        }
+
+        if (texture)
+        {
+            hitCount++;
+            return texture;
+        }
+
+        // Registered right away so that later requests share it.
+        texture = std::make_shared<Texture>();
+        textures[filePath] = texture;
+        missCount++;
+    }
+
+    // The entry stays until the decode is done, so that requests made
+    // meanwhile share it.
+    TextureImageFuture future = decodeAsync(filePath);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (future.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+        {
+            decoding.erase(filePath);
+        }
+        else
+        {
+            releaseWhenDecoded.insert(filePath);
+        }
+    }
+
+    TextureUploadQueue::getInstance().request(texture, future);
+    return texture;
+}
+
+size_t TextureCache::getResidentBytes() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    size_t total = 0;
+    for (const auto& pair : textures)
+    {
+        if (std::shared_ptr<Texture> texture = pair.second.lock())
+        {
+            total += texture->getBytes();
+        }
+    }
+    return total;
+}
+
+void TextureCache::clear()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    textures.clear();
+    decoding.clear();
+    releaseWhenDecoded.clear();
+    std::cout << "Texture cache cleared\n";
+}
+
+void TextureCache::printStats() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    size_t resident = 0;
+    size_t residentBytes = 0;
+
+    std::cout << "\n=== Texture Cache ===\n";
+
+    for (const auto& pair : textures)
+    {
+        std::shared_ptr<Texture> texture = pair.second.lock();
+        if (!texture)
+        {
+            continue;
+        }
+
+        std::cout << pair.first << ": ";
+        if (texture->isTextureLoaded())
+        {
+            const char* format = texture->getFormat() == TEXTURE_BC1 ? ", BC1"
+                : texture->getFormat() == TEXTURE_BC3 ? ", BC3" : "";
+
+            std::cout << texture->getWidth() << "x" << texture->getHeight()
+                << format << ", " << texture->getBytes() / 1024 << " KB, ";
+        }
+        else
+        {
+            std::cout << "streaming, ";
+        }
+        std::cout << texture.use_count() - 1 << " references\n";
+
+        resident++;
+        residentBytes += texture->getBytes();
+    }
+
+    std::cout << "Resident textures: " << resident << ", decoding: " << decoding.size() << "\n";
+    std::cout << "Hits: " << hitCount << ", misses: " << missCount << "\n";
+    std::cout << "GPU memory: " << residentBytes / 1024 << " KB resident\n";
+    std::cout << "========================\n";
+}
@@ -0,0 +1,62 @@
+#pragma once
+#include <condition_variable>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include "Texture.h"
+
+// Resolves to nullptr when the image could not be loaded.
+typedef std::shared_future<std::shared_ptr<TextureImage>> TextureImageFuture;
+
+// Shares one GL texture per image file. Loading (mapping a cooked .tex file
+// or decoding the image) runs on the job system; the TextureUploadQueue
+// creates the texture on the GL thread. Textures are released when the
+// last scene using them goes away.
+class TextureCache
+{
+private:
+    static TextureCache* instance;
+    std::map<std::string, std::weak_ptr<Texture>> textures;
+    std::map<std::string, TextureImageFuture> decoding;
+    // Decodes nobody picks up; their entries go once the image is in.
+    std::set<std::string> releaseWhenDecoded;
+    mutable std::mutex mutex;
+    // Decode jobs still to finish; they use the cache until they have.
+    size_t runningDecodes;
+    std::condition_variable decodesDone;
+
+    size_t hitCount;
+    size_t missCount;
+
+    TextureCache();
+    TextureImageFuture decodeAsync(const std::string& filePath);
+    // Maps the cooked form of an image if it exists and is not older than
+    // the source; decodes the source otherwise.
+    static std::shared_ptr<TextureImage> loadImage(const std::string& filePath);
+    static std::shared_ptr<TextureImage> loadCooked(const std::string& filePath);
+
+public:
+    ~TextureCache();
+
+    TextureCache(const TextureCache&) = delete;
+    TextureCache& operator=(const TextureCache&) = delete;
+
+    static TextureCache& getInstance();
+    static void destroy();
+
+    // Starts loading in the background so that a later loadTextureAsync()
+    // finds the image decoded. Does nothing for textures that are already resident.
+    void prefetch(const std::string& filePath);
+
+    // Any thread. Returns at once; the texture is uploaded by the
+    // TextureUploadQueue over the next frames and reports isTextureLoaded()
+    // when done. Stays unloaded if the image cannot be loaded.
+    std::shared_ptr<Texture> loadTextureAsync(const std::string& filePath);
+
+    size_t getResidentBytes() const;
+    void clear();
+    void printStats() const;
+};
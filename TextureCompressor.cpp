@@ -0,0 +1,392 @@
+#include "TextureCompressor.h"
+#include "JobSystem.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+namespace
+{
+    // Block rows handed to a thread at once.
+    const size_t BLOCK_ROW_GRAIN_SIZE = 4;
+    const size_t PIXEL_ROW_GRAIN_SIZE = 64;
+
+    struct Block
+    {
+        // RGBA per texel, row by row.
+        unsigned char texels[16][4];
+    };
+
+    void fetchTexel(const unsigned char* pixels, int width, int channels, int x, int y, unsigned char* out)
+    {
+        const unsigned char* texel = pixels + (static_cast<size_t>(y) * width + x) * channels;
+
+        if (channels >= 3)
+        {
+            out[0] = texel[0];
+            out[1] = texel[1];
+            out[2] = texel[2];
+        }
+        else
+        {
+            out[0] = out[1] = out[2] = texel[0];
+        }
+
+        out[3] = channels == 4 ? texel[3] : channels == 2 ? texel[1] : 255;
+    }
+
+    // Texels outside the image repeat the last row or column.
+    void fetchBlock(const unsigned char* pixels, int width, int height, int channels, int blockX, int blockY, Block& block)
+    {
+        for (int y = 0; y < 4; y++)
+        {
+            for (int x = 0; x < 4; x++)
+            {
+                int sourceX = std::min(blockX * 4 + x, width - 1);
+                int sourceY = std::min(blockY * 4 + y, height - 1);
+                fetchTexel(pixels, width, channels, sourceX, sourceY, block.texels[y * 4 + x]);
+            }
+        }
+    }
+
+    uint16_t packColor(const float* color)
+    {
+        int r = static_cast<int>(std::lround(std::min(std::max(color[0], 0.0f), 255.0f) * 31.0f / 255.0f));
+        int g = static_cast<int>(std::lround(std::min(std::max(color[1], 0.0f), 255.0f) * 63.0f / 255.0f));
+        int b = static_cast<int>(std::lround(std::min(std::max(color[2], 0.0f), 255.0f) * 31.0f / 255.0f));
+        return static_cast<uint16_t>((r << 11) | (g << 5) | b);
+    }
+
+    void unpackColor(uint16_t packed, float* color)
+    {
+        int r = (packed >> 11) & 31;
+        int g = (packed >> 5) & 63;
+        int b = packed & 31;
+        color[0] = static_cast<float>((r << 3) | (r >> 2));
+        color[1] = static_cast<float>((g << 2) | (g >> 4));
+        color[2] = static_cast<float>((b << 3) | (b >> 2));
+    }
+
+    // Picks the closest of the four palette colors for every texel and
+    // returns the total squared error.
+    float assignIndices(const Block& block, uint16_t color0, uint16_t color1, uint8_t* indices)
+    {
+        float palette[4][3];
+        unpackColor(color0, palette[0]);
+        unpackColor(color1, palette[1]);
+        for (int c = 0; c < 3; c++)
+        {
+            palette[2][c] = (2.0f * palette[0][c] + palette[1][c]) / 3.0f;
+            palette[3][c] = (palette[0][c] + 2.0f * palette[1][c]) / 3.0f;
+        }
+
+        float totalError = 0.0f;
+        for (int i = 0; i < 16; i++)
+        {
+            float bestError = 0.0f;
+            uint8_t best = 0;
+
+            for (uint8_t p = 0; p < 4; p++)
+            {
+                float error = 0.0f;
+                for (int c = 0; c < 3; c++)
+                {
+                    float difference = block.texels[i][c] - palette[p][c];
+                    error += difference * difference;
+                }
+
+                if (p == 0 || error < bestError)
+                {
+                    bestError = error;
+                    best = p;
+                }
+            }
+
+            indices[i] = best;
+            totalError += bestError;
+        }
+        return totalError;
+    }
+
+    // Endpoints along the principal axis of the block's colors, refined
+    // once by a least-squares fit to the chosen indices.
+    void encodeColorBlock(const Block& block, unsigned char* out)
+    {
+        float mean[3] = { 0.0f, 0.0f, 0.0f };
+        for (int i = 0; i < 16; i++)
+        {
+            for (int c = 0; c < 3; c++)
+            {
+                mean[c] += block.texels[i][c] / 16.0f;
+            }
+        }
+
+        float covariance[3][3] = {};
+        for (int i = 0; i < 16; i++)
+        {
+            float d[3];
+            for (int c = 0; c < 3; c++)
+            {
+                d[c] = block.texels[i][c] - mean[c];
+            }
+            for (int a = 0; a < 3; a++)
+            {
+                for (int b = 0; b < 3; b++)
+                {
+                    covariance[a][b] += d[a] * d[b];
+                }
+            }
+        }
+
+        float axis[3] = { 1.0f, 1.0f, 1.0f };
+        for (int iteration = 0; iteration < 8; iteration++)
+        {
+            float next[3];
+            for (int a = 0; a < 3; a++)
+            {
+                next[a] = covariance[a][0] * axis[0] + covariance[a][1] * axis[1] + covariance[a][2] * axis[2];
+            }
+
+            float length = std::max(std::fabs(next[0]), std::max(std::fabs(next[1]), std::fabs(next[2])));
+            if (length < 1e-6f)
+            {
+                break;
+            }
+            for (int a = 0; a < 3; a++)
+            {
+                axis[a] = next[a] / length;
+            }
+        }
+
+        float minDot = 0.0f;
+        float maxDot = 0.0f;
+        int minTexel = 0;
+        int maxTexel = 0;
+        for (int i = 0; i < 16; i++)
+        {
+            float dot = block.texels[i][0] * axis[0] + block.texels[i][1] * axis[1] + block.texels[i][2] * axis[2];
+            if (i == 0 || dot < minDot)
+            {
+                minDot = dot;
+                minTexel = i;
+            }
+            if (i == 0 || dot > maxDot)
+            {
+                maxDot = dot;
+                maxTexel = i;
+            }
+        }
+
+        // Pull the endpoints in slightly: extremes are often outliers.
+        float high[3];
+        float low[3];
+        for (int c = 0; c < 3; c++)
+        {
+            float inset = (block.texels[maxTexel][c] - block.texels[minTexel][c]) / 16.0f;
+            high[c] = block.texels[maxTexel][c] - inset;
+            low[c] = block.texels[minTexel][c] + inset;
+        }
+
+        uint16_t color0 = packColor(high);
+        uint16_t color1 = packColor(low);
+        uint8_t indices[16];
+        float error = assignIndices(block, std::max(color0, color1), std::min(color0, color1), indices);
+
+        // Solve for the endpoints that best reproduce the texels with these
+        // indices; palette entry p weighs color0 by weights[p].
+        static const float weights[4] = { 1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f };
+        float aa = 0.0f;
+        float ab = 0.0f;
+        float bb = 0.0f;
+        float ax[3] = { 0.0f, 0.0f, 0.0f };
+        float bx[3] = { 0.0f, 0.0f, 0.0f };
+        for (int i = 0; i < 16; i++)
+        {
+            float alpha = weights[indices[i]];
+            float beta = 1.0f - alpha;
+            aa += alpha * alpha;
+            ab += alpha * beta;
+            bb += beta * beta;
+            for (int c = 0; c < 3; c++)
+            {
+                ax[c] += alpha * block.texels[i][c];
+                bx[c] += beta * block.texels[i][c];
+            }
+        }
+
+        float determinant = aa * bb - ab * ab;
+        if (std::fabs(determinant) > 1e-6f)
+        {
+            float fitted0[3];
+            float fitted1[3];
+            for (int c = 0; c < 3; c++)
+            {
+                fitted0[c] = (ax[c] * bb - bx[c] * ab) / determinant;
+                fitted1[c] = (bx[c] * aa - ax[c] * ab) / determinant;
+            }
+
+            uint16_t refined0 = packColor(fitted0);
+            uint16_t refined1 = packColor(fitted1);
+            uint8_t refinedIndices[16];
+            float refinedError = assignIndices(block, std::max(refined0, refined1), std::min(refined0, refined1),
+                refinedIndices);
+
+            if (refinedError < error)
+            {
+                color0 = refined0;
+                color1 = refined1;
+                std::memcpy(indices, refinedIndices, sizeof(indices));
+            }
+        }
+
+        // color0 > color1 selects the four color mode. Equal colors fall
+        // back to three colors, where index 0 is still color0.
+        uint16_t first = std::max(color0, color1);
+        uint16_t second = std::min(color0, color1);
+        uint32_t packedIndices = 0;
+        if (first != second)
+        {
+            for (int i = 0; i < 16; i++)
+            {
+                packedIndices |= static_cast<uint32_t>(indices[i]) << (i * 2);
+            }
+        }
+
+        out[0] = static_cast<unsigned char>(first & 0xFF);
+        out[1] = static_cast<unsigned char>(first >> 8);
+        out[2] = static_cast<unsigned char>(second & 0xFF);
+        out[3] = static_cast<unsigned char>(second >> 8);
+        for (int i = 0; i < 4; i++)
+        {
+            out[4 + i] = static_cast<unsigned char>((packedIndices >> (i * 8)) & 0xFF);
+        }
+    }
+
+    // Eight alpha values interpolated between the block's extremes.
+    void encodeAlphaBlock(const Block& block, unsigned char* out)
+    {
+        int high = 0;
+        int low = 255;
+        for (int i = 0; i < 16; i++)
+        {
+            high = std::max<int>(high, block.texels[i][3]);
+            low = std::min<int>(low, block.texels[i][3]);
+        }
+
+        out[0] = static_cast<unsigned char>(high);
+        out[1] = static_cast<unsigned char>(low);
+
+        uint64_t packedIndices = 0;
+        if (high != low)
+        {
+            int palette[8];
+            palette[0] = high;
+            palette[1] = low;
+            for (int p = 2; p < 8; p++)
+            {
+                palette[p] = ((8 - p) * high + (p - 1) * low) / 7;
+            }
+
+            for (int i = 0; i < 16; i++)
+            {
+                int best = 0;
+                for (int p = 1; p < 8; p++)
+                {
+                    if (std::abs(palette[p] - block.texels[i][3]) < std::abs(palette[best] - block.texels[i][3]))
+                    {
+                        best = p;
+                    }
+                }
+                packedIndices |= static_cast<uint64_t>(best) << (i * 3);
+            }
+        }
+
+        for (int i = 0; i < 6; i++)
+        {
+            out[2 + i] = static_cast<unsigned char>((packedIndices >> (i * 8)) & 0xFF);
+        }
+    }
+}
+
+std::vector<unsigned char> TextureCompressor::downsample(const unsigned char* pixels, int width, int height, int channels)
+{
+    const int halfWidth = std::max(width / 2, 1);
+    const int halfHeight = std::max(height / 2, 1);
+    std::vector<unsigned char> result(static_cast<size_t>(halfWidth) * halfHeight * channels);
+
+    JobSystem::getInstance().parallelFor(halfHeight, PIXEL_ROW_GRAIN_SIZE, [&](size_t begin, size_t end) {
+        for (size_t y = begin; y < end; y++)
+        {
+            int y0 = std::min(static_cast<int>(y) * 2, height - 1);
+            int y1 = std::min(y0 + 1, height - 1);
+
+            for (int x = 0; x < halfWidth; x++)
+            {
+                int x0 = std::min(x * 2, width - 1);
+                int x1 = std::min(x0 + 1, width - 1);
+
+                for (int c = 0; c < channels; c++)
+                {
+                    int sum = pixels[(static_cast<size_t>(y0) * width + x0) * channels + c]
+                        + pixels[(static_cast<size_t>(y0) * width + x1) * channels + c]
+                        + pixels[(static_cast<size_t>(y1) * width + x0) * channels + c]
+                        + pixels[(static_cast<size_t>(y1) * width + x1) * channels + c];
+                    result[(y * halfWidth + x) * channels + c] = static_cast<unsigned char>((sum + 2) / 4);
+                }
+            }
+        }
+    });
+
+    return result;
+}
+
+std::vector<unsigned char> TextureCompressor::compress(const unsigned char* pixels, int width, int height, int channels,
+    TextureFormat format)
+{
+    const int blocksWide = (width + 3) / 4;
+    const int blocksHigh = (height + 3) / 4;
+    const size_t blockSize = format == TEXTURE_BC1 ? 8 : 16;
+    std::vector<unsigned char> result(static_cast<size_t>(blocksWide) * blocksHigh * blockSize);
+
+    JobSystem::getInstance().parallelFor(blocksHigh, BLOCK_ROW_GRAIN_SIZE, [&](size_t begin, size_t end) {
+        Block block;
+        for (size_t blockY = begin; blockY < end; blockY++)
+        {
+            for (int blockX = 0; blockX < blocksWide; blockX++)
+            {
+                fetchBlock(pixels, width, height, channels, blockX, static_cast<int>(blockY), block);
+                unsigned char* out = &result[(blockY * blocksWide + blockX) * blockSize];
+
+                if (format == TEXTURE_BC3)
+                {
+                    encodeAlphaBlock(block, out);
+                    encodeColorBlock(block, out + 8);
+                }
+                else
+                {
+                    encodeColorBlock(block, out);
+                }
+            }
+        }
+    });
+
+    return result;
+}
+
+bool TextureCompressor::hasAlpha(const unsigned char* pixels, int width, int height, int channels)
+{
+    if (channels != 2 && channels != 4)
+    {
+        return false;
+    }
+
+    const size_t count = static_cast<size_t>(width) * height;
+    for (size_t i = 0; i < count; i++)
+    {
+        if (pixels[i * channels + channels - 1] != 255)
+        {
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,22 @@
+#pragma once
+#include <vector>
+#include "Texture.h"
+
+// CPU side of texture cooking: mip generation and BC1/BC3 block
+// compression, both spread over the job system. Used by the offline
+// texture converter, not at run time.
+class TextureCompressor
+{
+public:
+    // Half-size level, each texel the average of a 2x2 box. A trailing odd
+    // row or column is dropped, like most GPU mip generators do.
+    static std::vector<unsigned char> downsample(const unsigned char* pixels, int width, int height, int channels);
+
+    // Encodes a level of 1 to 4 channels; grey is replicated to RGB and
+    // missing alpha is opaque. Returns TextureImage::getLevelSize() bytes.
+    static std::vector<unsigned char> compress(const unsigned char* pixels, int width, int height, int channels,
+        TextureFormat format);
+
+    // True if any texel is not fully opaque; such images need BC3.
+    static bool hasAlpha(const unsigned char* pixels, int width, int height, int channels);
+};
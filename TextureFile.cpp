@@ -0,0 +1,181 @@
+#include "TextureFile.h"
+#include "Texture.h"
+#include "MappedFile.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+static_assert(sizeof(TextureFileHeader) == 32, "TextureFileHeader layout changed");
+static_assert(sizeof(TextureFileLevel) == 24, "TextureFileLevel layout changed");
+
+namespace
+{
+    const char MAGIC[4] = { 'T', 'E', 'X', 'F' };
+
+    // Enough for a 2^31 texel edge.
+    const uint32_t MAX_LEVELS = 32;
+
+    uint64_t alignOffset(uint64_t offset)
+    {
+        const uint64_t alignment = TextureFile::SECTION_ALIGNMENT;
+        return (offset + alignment - 1) / alignment * alignment;
+    }
+
+    void writePadding(std::ofstream& file, uint64_t from, uint64_t to)
+    {
+        static const char zeros[TextureFile::SECTION_ALIGNMENT] = {};
+        file.write(zeros, static_cast<std::streamsize>(to - from));
+    }
+}
+
+std::string TextureFile::getCookedPath(const std::string& sourcePath)
+{
+    size_t slash = sourcePath.find_last_of("/\\");
+    size_t dot = sourcePath.find_last_of('.');
+    std::string stem = (dot != std::string::npos && (slash == std::string::npos || dot > slash))
+        ? sourcePath.substr(0, dot)
+        : sourcePath;
+
+    return stem + ".tex";
+}
+
+bool TextureFile::write(const std::string& filePath, const TextureImage& image)
+{
+    if (image.levels.empty() || image.levels.size() > MAX_LEVELS)
+    {
+        std::cerr << "TextureFile: " << image.path << " has " << image.levels.size() << " levels" << std::endl;
+        return false;
+    }
+
+    TextureFileHeader header = {};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.format = image.format;
+    header.channels = static_cast<uint32_t>(image.channels);
+    header.width = static_cast<uint32_t>(image.width);
+    header.height = static_cast<uint32_t>(image.height);
+    header.levelCount = static_cast<uint32_t>(image.levels.size());
+
+    std::vector<TextureFileLevel> levels(image.levels.size());
+    uint64_t offset = sizeof(TextureFileHeader) + levels.size() * sizeof(TextureFileLevel);
+
+    for (size_t i = 0; i < levels.size(); i++)
+    {
+        offset = alignOffset(offset);
+        levels[i].width = static_cast<uint32_t>(image.levels[i].width);
+        levels[i].height = static_cast<uint32_t>(image.levels[i].height);
+        levels[i].offset = offset;
+        levels[i].size = image.levels[i].size;
+        offset += levels[i].size;
+    }
+
+    std::ofstream file(filePath, std::ios::binary | std::ios::trunc);
+    if (!file.is_open())
+    {
+        std::cerr << "TextureFile: cannot write " << filePath << std::endl;
+        return false;
+    }
+
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(levels.data()),
+        static_cast<std::streamsize>(levels.size() * sizeof(TextureFileLevel)));
+
+    uint64_t position = sizeof(TextureFileHeader) + levels.size() * sizeof(TextureFileLevel);
+    for (size_t i = 0; i < levels.size(); i++)
+    {
+        writePadding(file, position, levels[i].offset);
+        file.write(reinterpret_cast<const char*>(image.levels[i].data), static_cast<std::streamsize>(levels[i].size));
+        position = levels[i].offset + levels[i].size;
+    }
+
+    if (!file.good())
+    {
+        std::cerr << "TextureFile: write failed for " << filePath << std::endl;
+        return false;
+    }
+    return true;
+}
+
+std::unique_ptr<TextureImage> TextureFile::load(const std::string& filePath)
+{
+    auto file = std::make_shared<MappedFile>();
+    if (!file->open(filePath))
+    {
+        return nullptr;
+    }
+
+    if (file->size() < sizeof(TextureFileHeader))
+    {
+        std::cerr << "TextureFile: " << filePath << " is truncated" << std::endl;
+        return nullptr;
+    }
+
+    TextureFileHeader header;
+    std::memcpy(&header, file->data(), sizeof(header));
+
+    if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != VERSION)
+    {
+        std::cerr << "TextureFile: " << filePath << " is not a version " << VERSION << " texture file" << std::endl;
+        return nullptr;
+    }
+
+    const TextureFormat format = static_cast<TextureFormat>(header.format);
+    const uint64_t tableEnd = sizeof(TextureFileHeader) + static_cast<uint64_t>(header.levelCount) * sizeof(TextureFileLevel);
+
+    bool valid = (format == TEXTURE_UNCOMPRESSED || format == TEXTURE_BC1 || format == TEXTURE_BC3)
+        && header.channels >= 1 && header.channels <= 4
+        && header.width > 0 && header.height > 0
+        && header.levelCount > 0 && header.levelCount <= MAX_LEVELS
+        && tableEnd <= file->size();
+
+    if (!valid)
+    {
+        std::cerr << "TextureFile: " << filePath << " is corrupt" << std::endl;
+        return nullptr;
+    }
+
+    auto image = std::make_unique<TextureImage>();
+    image->path = filePath;
+    image->width = static_cast<int>(header.width);
+    image->height = static_cast<int>(header.height);
+    image->channels = static_cast<int>(header.channels);
+    image->format = format;
+    image->mapping = file;
+
+    const unsigned char* base = file->data();
+    uint32_t levelWidth = header.width;
+    uint32_t levelHeight = header.height;
+
+    for (uint32_t i = 0; i < header.levelCount; i++)
+    {
+        TextureFileLevel entry;
+        std::memcpy(&entry, base + sizeof(TextureFileHeader) + i * sizeof(TextureFileLevel), sizeof(entry));
+
+        const uint64_t expectedSize = TextureImage::getLevelSize(format, image->channels,
+            static_cast<int>(levelWidth), static_cast<int>(levelHeight));
+
+        if (entry.width != levelWidth || entry.height != levelHeight
+            || entry.size != expectedSize
+            || entry.offset % SECTION_ALIGNMENT != 0
+            || entry.offset < tableEnd
+            || entry.offset + entry.size > file->size())
+        {
+            std::cerr << "TextureFile: " << filePath << " level " << i << " is corrupt" << std::endl;
+            return nullptr;
+        }
+
+        TextureLevel level;
+        level.width = static_cast<int>(entry.width);
+        level.height = static_cast<int>(entry.height);
+        level.data = base + entry.offset;
+        level.size = static_cast<size_t>(entry.size);
+        image->levels.push_back(level);
+
+        levelWidth = std::max<uint32_t>(levelWidth / 2, 1);
+        levelHeight = std::max<uint32_t>(levelHeight / 2, 1);
+    }
+
+    return image;
+}
@@ -0,0 +1,48 @@
+#pragma once
+#include <string>
+#include <memory>
+#include <cstdint>
+
+struct TextureImage;
+
+// On-disk layout of a cooked texture (.tex), little endian:
+//   TextureFileHeader
+//   TextureFileLevel  levelCount entries, largest level first
+//   level data        each level at its offset
+// Every level starts on a SECTION_ALIGNMENT boundary. Rows are already
+// flipped for OpenGL and the mip chain is complete, so loading is a map
+// plus one upload per level.
+struct TextureFileHeader
+{
+    char magic[4];
+    uint32_t version;
+    uint32_t format;
+    uint32_t channels;
+    uint32_t width;
+    uint32_t height;
+    uint32_t levelCount;
+    uint32_t reserved;
+};
+
+struct TextureFileLevel
+{
+    uint32_t width;
+    uint32_t height;
+    uint64_t offset;
+    uint64_t size;
+};
+
+class TextureFile
+{
+public:
+    static const uint32_t VERSION = 1;
+    static const uint32_t SECTION_ALIGNMENT = 16;
+
+    // texture/earth.jpg -> texture/earth.tex
+    static std::string getCookedPath(const std::string& sourcePath);
+
+    static bool write(const std::string& filePath, const TextureImage& image);
+
+    // Returns nullptr if the file is missing or malformed.
+    static std::unique_ptr<TextureImage> load(const std::string& filePath);
+};
@@ -0,0 +1,310 @@
+#include "TextureUploadQueue.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+TextureUploadQueue* TextureUploadQueue::instance = nullptr;
+
+namespace
+{
+    // Three buffers let the CPU fill one while the GPU still reads the
+    // previous frames' uploads.
+    const size_t STAGING_BUFFER_COUNT = 3;
+    // Largest band of rows uploaded at once; a 2048x2048 RGBA level takes four.
+    const size_t STAGING_BUFFER_SIZE = 4 * 1024 * 1024;
+    const size_t STAGING_ALIGNMENT = 16;
+}
+
+TextureUploadQueue::TextureUploadQueue()
+    : nextBuffer(0), currentBuffer(nullptr), currentOffset(0),
+    pendingCount(0), completedCount(0), failedCount(0), bytesStreamed(0), stallCount(0), uploadTime(0.0)
+{
+}
+
+TextureUploadQueue::~TextureUploadQueue()
+{
+    for (StagingBuffer& staging : stagingBuffers)
+    {
+        if (staging.fence != nullptr)
+        {
+            glDeleteSync(staging.fence);
+        }
+        glDeleteBuffers(1, &staging.buffer);
+    }
+}
+
+TextureUploadQueue& TextureUploadQueue::getInstance()
+{
+    if (!instance)
+        instance = new TextureUploadQueue();
+    return *instance;
+}
+
+void TextureUploadQueue::destroy()
+{
+    if (instance)
+    {
+        delete instance;
+        instance = nullptr;
+    }
+}
+
+void TextureUploadQueue::request(std::shared_ptr<Texture> texture, TextureImageFuture future)
+{
+    TextureUpload upload;
+    upload.texture = std::move(texture);
+    upload.imageFuture = std::move(future);
+    upload.level = 0;
+    upload.row = 0;
+
+    pendingCount++;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    requests.push_back(std::move(upload));
+}
+
+TextureUploadQueue::StagingBuffer* TextureUploadQueue::acquireBuffer()
+{
+    if (stagingBuffers.empty())
+    {
+        stagingBuffers.resize(STAGING_BUFFER_COUNT);
+        for (StagingBuffer& staging : stagingBuffers)
+        {
+            glGenBuffers(1, &staging.buffer);
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, staging.buffer);
+            glBufferData(GL_PIXEL_UNPACK_BUFFER, STAGING_BUFFER_SIZE, nullptr, GL_STREAM_DRAW);
+            staging.fence = nullptr;
+        }
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    }
+
+    // Buffers are reused in order, so the oldest one is checked.
+    StagingBuffer& staging = stagingBuffers[nextBuffer];
+    if (staging.fence != nullptr)
+    {
+        if (glClientWaitSync(staging.fence, 0, 0) == GL_TIMEOUT_EXPIRED)
+        {
+            return nullptr;
+        }
+        glDeleteSync(staging.fence);
+        staging.fence = nullptr;
+    }
+
+    nextBuffer = (nextBuffer + 1) % stagingBuffers.size();
+    return &staging;
+}
+
+void TextureUploadQueue::releaseBuffer()
+{
+    if (currentBuffer != nullptr)
+    {
+        currentBuffer->fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        currentBuffer = nullptr;
+        currentOffset = 0;
+    }
+}
+
+bool TextureUploadQueue::begin(TextureUpload& upload)
+{
+    upload.image = upload.imageFuture.get();
+    upload.imageFuture = TextureImageFuture();
+
+    if (!upload.image)
+    {
+        return false;
+    }
+
+    if (upload.texture->allocate(*upload.image))
+    {
+        return true;
+    }
+
+    // A driver without S3TC rejects compressed cooked files. Rare enough to
+    // decode the source right here.
+    if (upload.image->mapping)
+    {
+        upload.image = Texture::decode(upload.image->path);
+        return upload.image && upload.texture->allocate(*upload.image);
+    }
+
+    return false;
+}
+
+size_t TextureUploadQueue::uploadNext(TextureUpload& upload, size_t maxBytes)
+{
+    const TextureImage& image = *upload.image;
+    const TextureLevel& level = image.levels[upload.level];
+    const int alignment = image.getRowAlignment();
+    const size_t pitch = image.getRowPitch(upload.level);
+
+    const size_t remainingGroups = (level.height - upload.row + alignment - 1) / alignment;
+    const size_t groups = std::max<size_t>(std::min(std::min(maxBytes, STAGING_BUFFER_SIZE) / pitch, remainingGroups), 1);
+    const int rows = std::min(static_cast<int>(groups) * alignment, level.height - upload.row);
+    const size_t bytes = groups * pitch;
+    const unsigned char* source = level.data + (upload.row / alignment) * pitch;
+
+    if (bytes > STAGING_BUFFER_SIZE)
+    {
+        // A single band that does not fit a staging buffer goes from client memory.
+        upload.texture->uploadRows(image, upload.level, upload.row, rows, source);
+    }
+    else
+    {
+        if (currentBuffer == nullptr || currentOffset + bytes > STAGING_BUFFER_SIZE)
+        {
+            releaseBuffer();
+            currentBuffer = acquireBuffer();
+            if (currentBuffer == nullptr)
+            {
+                return 0;
+            }
+        }
+
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, currentBuffer->buffer);
+
+        // The fence has passed, so the driver need not synchronize the mapping.
+        void* mapped = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, static_cast<GLintptr>(currentOffset),
+            static_cast<GLsizeiptr>(bytes), GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+
+        if (mapped != nullptr)
+        {
+            std::memcpy(mapped, source, bytes);
+            glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+            upload.texture->uploadRows(image, upload.level, upload.row, rows,
+                reinterpret_cast<const void*>(currentOffset));
+        }
+        else
+        {
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+            upload.texture->uploadRows(image, upload.level, upload.row, rows, source);
+        }
+
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        currentOffset = (currentOffset + bytes + STAGING_ALIGNMENT - 1) / STAGING_ALIGNMENT * STAGING_ALIGNMENT;
+    }
+
+    upload.row += rows;
+    if (upload.row >= level.height)
+    {
+        upload.level++;
+        upload.row = 0;
+    }
+
+    return bytes;
+}
+
+void TextureUploadQueue::process(size_t budgetBytes)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (TextureUpload& upload : requests)
+        {
+            uploads.push_back(std::move(upload));
+        }
+        requests.clear();
+    }
+
+    if (uploads.empty())
+    {
+        return;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+
+    size_t remaining = budgetBytes;
+    size_t streamed = 0;
+    size_t completed = 0;
+    size_t failed = 0;
+    bool stalled = false;
+
+    std::vector<TextureUpload> waiting;
+
+    for (TextureUpload& upload : uploads)
+    {
+        bool progressed = streamed > 0;
+        if (stalled || (progressed && remaining == 0))
+        {
+            waiting.push_back(std::move(upload));
+            continue;
+        }
+
+        // Nobody holds the texture any more, e.g. its scene was evicted.
+        if (upload.texture.use_count() == 1)
+        {
+            pendingCount--;
+            continue;
+        }
+
+        if (!upload.image)
+        {
+            if (upload.imageFuture.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+            {
+                waiting.push_back(std::move(upload));
+                continue;
+            }
+
+            if (!begin(upload))
+            {
+                std::cerr << "ERROR: Texture could not be streamed in" << std::endl;
+                failed++;
+                pendingCount--;
+                continue;
+            }
+        }
+
+        while (upload.level < upload.image->levels.size() && (streamed == 0 || remaining > 0))
+        {
+            // The first band of a frame goes even over budget.
+            size_t bytes = uploadNext(upload, std::max<size_t>(remaining, 1));
+            if (bytes == 0)
+            {
+                stalled = true;
+                break;
+            }
+
+            streamed += bytes;
+            remaining -= std::min(bytes, remaining);
+        }
+
+        if (upload.level == upload.image->levels.size())
+        {
+            upload.texture->complete(*upload.image);
+            completed++;
+            pendingCount--;
+            continue;
+        }
+
+        waiting.push_back(std::move(upload));
+    }
+
+    uploads.swap(waiting);
+    releaseBuffer();
+
+    double time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    completedCount += completed;
+    failedCount += failed;
+    bytesStreamed += streamed;
+    stallCount += stalled ? 1 : 0;
+    uploadTime += time;
+}
+
+size_t TextureUploadQueue::getPendingCount()
+{
+    return pendingCount;
+}
+
+void TextureUploadQueue::printStats()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    std::cout << "\n=== Texture Upload Queue ===\n";
+    std::cout << "Pending: " << pendingCount << "\n";
+    std::cout << "Completed: " << completedCount << ", failed: " << failedCount << "\n";
+    std::cout << "Streamed: " << bytesStreamed / 1024 << " KB, frames waiting for a staging buffer: "
+        << stallCount << "\n";
+    std::cout << "Time on the GL thread: " << uploadTime * 1000.0 << " ms\n";
+    std::cout << "========================\n";
+}
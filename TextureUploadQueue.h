@@ -0,0 +1,89 @@
+#pragma once
+#include <GL/glew.h>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "Texture.h"
+#include "TextureCache.h"
+
+// Streams textures loaded in the background into GL textures. Texels are
+// copied into a small ring of pixel unpack buffers and uploaded with
+// glTexSubImage2D from there, so the driver never has to copy from client
+// memory inside the call. A fence per buffer tells when the GPU has read it
+// and the buffer can be reused. The renderer drains the queue once per
+// frame within a byte budget; large textures take several frames, a level
+// at a time or in bands of rows.
+class TextureUploadQueue
+{
+private:
+    static TextureUploadQueue* instance;
+
+    struct TextureUpload
+    {
+        std::shared_ptr<Texture> texture;
+        TextureImageFuture imageFuture;
+        std::shared_ptr<TextureImage> image;
+        // Next rows to upload.
+        size_t level;
+        int row;
+    };
+
+    struct StagingBuffer
+    {
+        GLuint buffer;
+        // Set while the GPU may still read from the buffer.
+        GLsync fence;
+    };
+
+    std::mutex mutex;
+    std::vector<TextureUpload> requests;
+
+    // GL thread only.
+    std::vector<TextureUpload> uploads;
+    std::vector<StagingBuffer> stagingBuffers;
+    size_t nextBuffer;
+    // Buffer being filled this frame; several bands share one buffer and
+    // one fence.
+    StagingBuffer* currentBuffer;
+    size_t currentOffset;
+
+    std::atomic<size_t> pendingCount;
+    size_t completedCount;
+    size_t failedCount;
+    size_t bytesStreamed;
+    size_t stallCount;
+    double uploadTime;
+
+    TextureUploadQueue();
+
+    StagingBuffer* acquireBuffer();
+    // Fences the current buffer once its uploads have been issued.
+    void releaseBuffer();
+    // Returns false once the texture has failed.
+    bool begin(TextureUpload& upload);
+    // Uploads the next band of rows, at most maxBytes unless a single band
+    // is larger. Returns the bytes uploaded, 0 if no buffer was free.
+    size_t uploadNext(TextureUpload& upload, size_t maxBytes);
+
+public:
+    ~TextureUploadQueue();
+
+    TextureUploadQueue(const TextureUploadQueue&) = delete;
+    TextureUploadQueue& operator=(const TextureUploadQueue&) = delete;
+
+    static TextureUploadQueue& getInstance();
+    // Deletes the staging buffers and unfinished textures; needs the GL context.
+    static void destroy();
+
+    // The texture becomes loaded once every level has been uploaded; until
+    // then isTextureLoaded() is false.
+    void request(std::shared_ptr<Texture> texture, TextureImageFuture future);
+
+    // GL thread only. Uploads at most budgetBytes of texel data, but always
+    // makes some progress so that large textures still get through.
+    void process(size_t budgetBytes);
+
+    size_t getPendingCount();
+    void printStats();
+};
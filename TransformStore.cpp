@@ -0,0 +1,634 @@
+#include "TransformStore.h"
+#include "DrawableObject.h"
+#include "ITransformComponent.h"
+#include "JobSystem.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define TRANSFORM_STORE_SSE 1
+#include <emmintrin.h>
+#else
+#define TRANSFORM_STORE_SSE 0
+#endif
+
+namespace
+{
+    const float DEGREES_TO_HALF_RADIANS = 3.14159265358979f / 360.0f;
+    const float MIN_VELOCITY_SQUARED = 0.0001f * 0.0001f;
+    const size_t EVALUATE_GRAIN_SIZE = 256;
+
+#if TRANSFORM_STORE_SSE
+    inline __m128 select(__m128 mask, __m128 a, __m128 b)
+    {
+        return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+    }
+
+    // Sine and cosine of four angles: reduce to [-pi/4, pi/4] around the
+    // nearest multiple of pi/2, evaluate Taylor polynomials and fix up the
+    // quadrant. Accurate to a few ulp for the small angles stored here.
+    inline void sinCos(__m128 x, __m128& sinOut, __m128& cosOut)
+    {
+        __m128i quadrant = _mm_cvtps_epi32(_mm_mul_ps(x, _mm_set1_ps(0.636619772f)));
+        __m128 q = _mm_cvtepi32_ps(quadrant);
+
+        __m128 r = _mm_sub_ps(x, _mm_mul_ps(q, _mm_set1_ps(1.5703125f)));
+        r = _mm_sub_ps(r, _mm_mul_ps(q, _mm_set1_ps(4.837512969970703125e-4f)));
+        r = _mm_sub_ps(r, _mm_mul_ps(q, _mm_set1_ps(7.54978995e-8f)));
+
+        __m128 r2 = _mm_mul_ps(r, r);
+
+        __m128 s = _mm_set1_ps(1.0f / 362880.0f);
+        s = _mm_add_ps(_mm_mul_ps(s, r2), _mm_set1_ps(-1.0f / 5040.0f));
+        s = _mm_add_ps(_mm_mul_ps(s, r2), _mm_set1_ps(1.0f / 120.0f));
+        s = _mm_add_ps(_mm_mul_ps(s, r2), _mm_set1_ps(-1.0f / 6.0f));
+        s = _mm_add_ps(_mm_mul_ps(s, r2), _mm_set1_ps(1.0f));
+        s = _mm_mul_ps(s, r);
+
+        __m128 c = _mm_set1_ps(1.0f / 40320.0f);
+        c = _mm_add_ps(_mm_mul_ps(c, r2), _mm_set1_ps(-1.0f / 720.0f));
+        c = _mm_add_ps(_mm_mul_ps(c, r2), _mm_set1_ps(1.0f / 24.0f));
+        c = _mm_add_ps(_mm_mul_ps(c, r2), _mm_set1_ps(-0.5f));
+        c = _mm_add_ps(_mm_mul_ps(c, r2), _mm_set1_ps(1.0f));
+
+        const __m128i one = _mm_set1_epi32(1);
+        const __m128i two = _mm_set1_epi32(2);
+
+        __m128 swap = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(quadrant, one), one));
+        __m128 sinSign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(quadrant, two), 30));
+        __m128 cosSign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(_mm_add_epi32(quadrant, one), two), 30));
+
+        sinOut = _mm_xor_ps(select(swap, c, s), sinSign);
+        cosOut = _mm_xor_ps(select(swap, s, c), cosSign);
+    }
+#endif
+
+    // out = a * b for column-major 4x4 matrices. out may alias a or b.
+    inline void multiplyMatrices(const float* a, const float* b, float* out)
+    {
+#if TRANSFORM_STORE_SSE
+        __m128 a0 = _mm_loadu_ps(a);
+        __m128 a1 = _mm_loadu_ps(a + 4);
+        __m128 a2 = _mm_loadu_ps(a + 8);
+        __m128 a3 = _mm_loadu_ps(a + 12);
+
+        __m128 columns[4];
+        for (int c = 0; c < 4; c++)
+        {
+            const float* column = b + c * 4;
+            __m128 r = _mm_mul_ps(a0, _mm_set1_ps(column[0]));
+            r = _mm_add_ps(r, _mm_mul_ps(a1, _mm_set1_ps(column[1])));
+            r = _mm_add_ps(r, _mm_mul_ps(a2, _mm_set1_ps(column[2])));
+            r = _mm_add_ps(r, _mm_mul_ps(a3, _mm_set1_ps(column[3])));
+            columns[c] = r;
+        }
+
+        for (int c = 0; c < 4; c++)
+        {
+            _mm_storeu_ps(out + c * 4, columns[c]);
+        }
+#else
+        float result[16];
+        for (int c = 0; c < 4; c++)
+        {
+            for (int r = 0; r < 4; r++)
+            {
+                result[c * 4 + r] = a[r] * b[c * 4] + a[4 + r] * b[c * 4 + 1] +
+                    a[8 + r] * b[c * 4 + 2] + a[12 + r] * b[c * 4 + 3];
+            }
+        }
+        std::memcpy(out, result, sizeof(result));
+#endif
+    }
+
+    // Column-major matrix of translate(t) * rotate(q) * scale(s).
+    inline void similarityToMatrix(const float q[4], const float t[3], float s, float* out)
+    {
+        float xx = q[0] * q[0], yy = q[1] * q[1], zz = q[2] * q[2];
+        float xy = q[0] * q[1], xz = q[0] * q[2], yz = q[1] * q[2];
+        float wx = q[3] * q[0], wy = q[3] * q[1], wz = q[3] * q[2];
+
+        out[0] = (1.0f - 2.0f * (yy + zz)) * s;
+        out[1] = 2.0f * (xy + wz) * s;
+        out[2] = 2.0f * (xz - wy) * s;
+        out[3] = 0.0f;
+
+        out[4] = 2.0f * (xy - wz) * s;
+        out[5] = (1.0f - 2.0f * (xx + zz)) * s;
+        out[6] = 2.0f * (yz + wx) * s;
+        out[7] = 0.0f;
+
+        out[8] = 2.0f * (xz + wy) * s;
+        out[9] = 2.0f * (yz - wx) * s;
+        out[10] = (1.0f - 2.0f * (xx + yy)) * s;
+        out[11] = 0.0f;
+
+        out[12] = t[0];
+        out[13] = t[1];
+        out[14] = t[2];
+        out[15] = 1.0f;
+    }
+}
+
+TransformRecord::TransformRecord()
+    : axis(0.0f, 1.0f, 0.0f), angle(0.0f), angularSpeed(0.0f),
+    position(0.0f), velocity(0.0f), scale(1.0f)
+{
+}
+
+TransformStore::TransformStore()
+    : orderDirty(false), removedCount(0)
+{
+}
+
+TransformStore::~TransformStore()
+{
+    clear();
+}
+
+void TransformStore::pushRecord(const TransformRecord& record, ITransformComponent* owner)
+{
+    axisX.push_back(record.axis.x);
+    axisY.push_back(record.axis.y);
+    axisZ.push_back(record.axis.z);
+    angle.push_back(record.angle);
+    angularSpeed.push_back(record.angularSpeed);
+    posX.push_back(record.position.x);
+    posY.push_back(record.position.y);
+    posZ.push_back(record.position.z);
+    velX.push_back(record.velocity.x);
+    velY.push_back(record.velocity.y);
+    velZ.push_back(record.velocity.z);
+    scale.push_back(record.scale);
+    quatX.push_back(0.0f);
+    quatY.push_back(0.0f);
+    quatZ.push_back(0.0f);
+    quatW.push_back(1.0f);
+    owners.push_back(owner);
+}
+
+bool TransformStore::add(DrawableObject* obj)
+{
+    if (obj == nullptr || obj->getTransformStore() != nullptr)
+    {
+        return false;
+    }
+
+    const Transformation& transform = obj->getTransformation();
+    const auto& components = transform.getDynamicComponents();
+
+    std::vector<TransformRecord> records(components.size());
+    for (size_t i = 0; i < components.size(); i++)
+    {
+        if (!components[i]->toRecord(records[i]))
+        {
+            return false;
+        }
+    }
+
+    Slot slot;
+    slot.object = obj;
+    slot.firstRecord = static_cast<int>(angle.size());
+    slot.recordCount = static_cast<int>(records.size());
+    slot.parentSlot = -1;
+    slot.parentObject = obj->getParent();
+    slot.staticMatrix = transform.getStaticMatrix();
+    slot.staticVersion = transform.getStaticVersion();
+
+    for (size_t i = 0; i < records.size(); i++)
+    {
+        pushRecord(records[i], components[i].get());
+        components[i]->bindRecord(this, slot.firstRecord + static_cast<int>(i));
+    }
+    computeRotations(slot.firstRecord, slot.recordCount);
+
+    if (slot.parentObject != nullptr && slot.parentObject->getTransformStore() == this)
+    {
+        slot.parentSlot = slot.parentObject->getTransformSlot();
+    }
+
+    int slotIndex = static_cast<int>(slots.size());
+    slots.push_back(slot);
+    worldMatrices.push_back(glm::mat4(1.0f));
+    normalMatrices.push_back(glm::mat3(1.0f));
+    slotVersions.push_back(0);
+    obj->bindTransformSlot(this, slotIndex);
+
+    evaluateSlot(slotIndex);
+    orderDirty = true;
+
+    return true;
+}
+
+void TransformStore::remove(DrawableObject* obj)
+{
+    if (obj == nullptr || obj->getTransformStore() != this)
+    {
+        return;
+    }
+
+    Slot& slot = slots[obj->getTransformSlot()];
+    for (int i = slot.firstRecord; i < slot.firstRecord + slot.recordCount; i++)
+    {
+        owners[i]->bindRecord(nullptr, -1);
+        owners[i] = nullptr;
+    }
+
+    slot.object = nullptr;
+    obj->bindTransformSlot(nullptr, -1);
+
+    removedCount++;
+    orderDirty = true;
+}
+
+void TransformStore::release(int record)
+{
+    for (const Slot& slot : slots)
+    {
+        if (slot.object != nullptr && record >= slot.firstRecord && record < slot.firstRecord + slot.recordCount)
+        {
+            remove(slot.object);
+            return;
+        }
+    }
+}
+
+void TransformStore::clear()
+{
+    for (Slot& slot : slots)
+    {
+        if (slot.object != nullptr)
+        {
+            remove(slot.object);
+        }
+    }
+
+    axisX.clear(); axisY.clear(); axisZ.clear();
+    angle.clear(); angularSpeed.clear();
+    posX.clear(); posY.clear(); posZ.clear();
+    velX.clear(); velY.clear(); velZ.clear();
+    scale.clear();
+    quatX.clear(); quatY.clear(); quatZ.clear(); quatW.clear();
+    owners.clear();
+
+    slots.clear();
+    worldMatrices.clear();
+    normalMatrices.clear();
+    slotVersions.clear();
+    order.clear();
+    ranges.clear();
+    orderDirty = false;
+    removedCount = 0;
+}
+
+void TransformStore::compact()
+{
+    TransformStore compacted;
+    compacted.slots.reserve(slots.size() - removedCount);
+
+    for (size_t index = 0; index < slots.size(); index++)
+    {
+        const Slot& slot = slots[index];
+        if (slot.object == nullptr)
+        {
+            continue;
+        }
+
+        Slot moved = slot;
+        moved.firstRecord = static_cast<int>(compacted.angle.size());
+
+        for (int i = 0; i < slot.recordCount; i++)
+        {
+            int from = slot.firstRecord + i;
+            TransformRecord record;
+            record.axis = glm::vec3(axisX[from], axisY[from], axisZ[from]);
+            record.angle = angle[from];
+            record.angularSpeed = angularSpeed[from];
+            record.position = getPosition(from);
+            record.velocity = getVelocity(from);
+            record.scale = scale[from];
+            compacted.pushRecord(record, owners[from]);
+        }
+
+        compacted.worldMatrices.push_back(worldMatrices[index]);
+        compacted.normalMatrices.push_back(normalMatrices[index]);
+        compacted.slotVersions.push_back(slotVersions[index]);
+        compacted.slots.push_back(moved);
+    }
+
+    axisX.swap(compacted.axisX); axisY.swap(compacted.axisY); axisZ.swap(compacted.axisZ);
+    angle.swap(compacted.angle); angularSpeed.swap(compacted.angularSpeed);
+    posX.swap(compacted.posX); posY.swap(compacted.posY); posZ.swap(compacted.posZ);
+    velX.swap(compacted.velX); velY.swap(compacted.velY); velZ.swap(compacted.velZ);
+    scale.swap(compacted.scale);
+    quatX.swap(compacted.quatX); quatY.swap(compacted.quatY); quatZ.swap(compacted.quatZ); quatW.swap(compacted.quatW);
+    owners.swap(compacted.owners);
+    slots.swap(compacted.slots);
+    worldMatrices.swap(compacted.worldMatrices);
+    normalMatrices.swap(compacted.normalMatrices);
+    slotVersions.swap(compacted.slotVersions);
+
+    // The old arrays now live in 'compacted' and must not be unbound by its destructor.
+    compacted.slots.clear();
+
+    for (size_t i = 0; i < slots.size(); i++)
+    {
+        slots[i].object->bindTransformSlot(this, static_cast<int>(i));
+        for (int r = slots[i].firstRecord; r < slots[i].firstRecord + slots[i].recordCount; r++)
+        {
+            owners[r]->bindRecord(this, r);
+        }
+    }
+
+    computeRotations(0, angle.size());
+    removedCount = 0;
+    orderDirty = true;
+}
+
+void TransformStore::rebuildOrder()
+{
+    order.clear();
+    std::vector<int> depth(slots.size(), 0);
+
+    for (size_t i = 0; i < slots.size(); i++)
+    {
+        Slot& slot = slots[i];
+        if (slot.object == nullptr)
+        {
+            continue;
+        }
+
+        DrawableObject* parent = slot.object->getParent();
+        slot.parentObject = parent;
+        slot.parentSlot = (parent != nullptr && parent->getTransformStore() == this) ? parent->getTransformSlot() : -1;
+
+        for (DrawableObject* p = parent; p != nullptr; p = p->getParent())
+        {
+            depth[i]++;
+        }
+
+        order.push_back(static_cast<int>(i));
+    }
+
+    // Parents are evaluated before their children; within a depth, slots
+    // with a parent outside the store come first.
+    auto external = [this](int slot) { return slots[slot].parentSlot < 0 && slots[slot].parentObject != nullptr; };
+    std::stable_sort(order.begin(), order.end(),
+        [&depth, &external](int a, int b) {
+            if (depth[a] != depth[b])
+                return depth[a] < depth[b];
+            return external(a) && !external(b);
+        });
+
+    ranges.clear();
+    for (size_t i = 0; i < order.size(); i++)
+    {
+        bool parallel = !external(order[i]);
+        if (ranges.empty() || ranges.back().parallel != parallel || depth[order[ranges.back().begin]] != depth[order[i]])
+        {
+            ranges.push_back({ i, i, parallel });
+        }
+        ranges.back().end = i + 1;
+    }
+
+    orderDirty = false;
+}
+
+void TransformStore::integrate(float deltaTime)
+{
+    const size_t count = angle.size();
+    size_t i = 0;
+
+#if TRANSFORM_STORE_SSE
+    const __m128 dt = _mm_set1_ps(deltaTime);
+    const __m128 fullTurn = _mm_set1_ps(360.0f);
+    const __m128 minVelocity = _mm_set1_ps(MIN_VELOCITY_SQUARED);
+
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128 a = _mm_add_ps(_mm_loadu_ps(&angle[i]), _mm_mul_ps(_mm_loadu_ps(&angularSpeed[i]), dt));
+        a = _mm_sub_ps(a, _mm_and_ps(_mm_cmpge_ps(a, fullTurn), fullTurn));
+        _mm_storeu_ps(&angle[i], a);
+
+        __m128 vx = _mm_loadu_ps(&velX[i]);
+        __m128 vy = _mm_loadu_ps(&velY[i]);
+        __m128 vz = _mm_loadu_ps(&velZ[i]);
+        __m128 lengthSquared = _mm_add_ps(_mm_add_ps(_mm_mul_ps(vx, vx), _mm_mul_ps(vy, vy)), _mm_mul_ps(vz, vz));
+        __m128 moving = _mm_cmpgt_ps(lengthSquared, minVelocity);
+
+        _mm_storeu_ps(&posX[i], _mm_add_ps(_mm_loadu_ps(&posX[i]), _mm_and_ps(moving, _mm_mul_ps(vx, dt))));
+        _mm_storeu_ps(&posY[i], _mm_add_ps(_mm_loadu_ps(&posY[i]), _mm_and_ps(moving, _mm_mul_ps(vy, dt))));
+        _mm_storeu_ps(&posZ[i], _mm_add_ps(_mm_loadu_ps(&posZ[i]), _mm_and_ps(moving, _mm_mul_ps(vz, dt))));
+    }
+#endif
+
+    for (; i < count; i++)
+    {
+        angle[i] += angularSpeed[i] * deltaTime;
+        if (angle[i] >= 360.0f)
+            angle[i] -= 360.0f;
+
+        float lengthSquared = velX[i] * velX[i] + velY[i] * velY[i] + velZ[i] * velZ[i];
+        if (lengthSquared > MIN_VELOCITY_SQUARED)
+        {
+            posX[i] += velX[i] * deltaTime;
+            posY[i] += velY[i] * deltaTime;
+            posZ[i] += velZ[i] * deltaTime;
+        }
+    }
+}
+
+void TransformStore::computeRotations(size_t first, size_t count)
+{
+    size_t i = first;
+    const size_t end = first + count;
+
+#if TRANSFORM_STORE_SSE
+    const __m128 toHalfRadians = _mm_set1_ps(DEGREES_TO_HALF_RADIANS);
+
+    for (; i + 4 <= end; i += 4)
+    {
+        __m128 s, c;
+        sinCos(_mm_mul_ps(_mm_loadu_ps(&angle[i]), toHalfRadians), s, c);
+
+        _mm_storeu_ps(&quatX[i], _mm_mul_ps(_mm_loadu_ps(&axisX[i]), s));
+        _mm_storeu_ps(&quatY[i], _mm_mul_ps(_mm_loadu_ps(&axisY[i]), s));
+        _mm_storeu_ps(&quatZ[i], _mm_mul_ps(_mm_loadu_ps(&axisZ[i]), s));
+        _mm_storeu_ps(&quatW[i], c);
+    }
+#endif
+
+    for (; i < end; i++)
+    {
+        float half = angle[i] * DEGREES_TO_HALF_RADIANS;
+        float s = std::sin(half);
+        quatX[i] = axisX[i] * s;
+        quatY[i] = axisY[i] * s;
+        quatZ[i] = axisZ[i] * s;
+        quatW[i] = std::cos(half);
+    }
+}
+
+void TransformStore::refreshStaticMatrices()
+{
+    // The static part is folded in as one matrix; it is re-read only when
+    // a setter of one of its components has run.
+    for (Slot& slot : slots)
+    {
+        if (slot.object == nullptr)
+        {
+            continue;
+        }
+
+        const Transformation& transform = slot.object->getTransformation();
+        unsigned int version = transform.getStaticVersion();
+        if (version != slot.staticVersion)
+        {
+            slot.staticMatrix = transform.getStaticMatrix();
+            slot.staticVersion = version;
+        }
+    }
+}
+
+void TransformStore::evaluateSlot(int slotIndex)
+{
+    const Slot& slot = slots[slotIndex];
+
+    // Fold the chain as similarity transforms: (q, t, s) * (qr, tr, sr)
+    // = (q * qr, t + s * rotate(q, tr), s * sr).
+    float q[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+    float t[3] = { 0.0f, 0.0f, 0.0f };
+    float s = 1.0f;
+
+    for (int r = slot.firstRecord; r < slot.firstRecord + slot.recordCount; r++)
+    {
+        float vx = posX[r] * s, vy = posY[r] * s, vz = posZ[r] * s;
+
+        // v + 2w(u x v) + 2u x (u x v)
+        float cx = q[1] * vz - q[2] * vy;
+        float cy = q[2] * vx - q[0] * vz;
+        float cz = q[0] * vy - q[1] * vx;
+        float ccx = q[1] * cz - q[2] * cy;
+        float ccy = q[2] * cx - q[0] * cz;
+        float ccz = q[0] * cy - q[1] * cx;
+
+        t[0] += vx + 2.0f * (q[3] * cx + ccx);
+        t[1] += vy + 2.0f * (q[3] * cy + ccy);
+        t[2] += vz + 2.0f * (q[3] * cz + ccz);
+
+        float rx = quatX[r], ry = quatY[r], rz = quatZ[r], rw = quatW[r];
+        float nx = q[3] * rx + q[0] * rw + q[1] * rz - q[2] * ry;
+        float ny = q[3] * ry - q[0] * rz + q[1] * rw + q[2] * rx;
+        float nz = q[3] * rz + q[0] * ry - q[1] * rx + q[2] * rw;
+        float nw = q[3] * rw - q[0] * rx - q[1] * ry - q[2] * rz;
+        q[0] = nx; q[1] = ny; q[2] = nz; q[3] = nw;
+
+        s *= scale[r];
+    }
+
+    float* world = &worldMatrices[slotIndex][0][0];
+    similarityToMatrix(q, t, s, world);
+    multiplyMatrices(world, &slot.staticMatrix[0][0], world);
+
+    if (slot.parentSlot >= 0)
+    {
+        multiplyMatrices(&worldMatrices[slot.parentSlot][0][0], world, world);
+    }
+    else if (slot.parentObject != nullptr)
+    {
+        multiplyMatrices(&slot.parentObject->getModelMatrix()[0][0], world, world);
+    }
+
+    // Inverse transpose of the upper 3x3: the columns b x c, c x a, a x b
+    // divided by the determinant.
+    const float* a = world;
+    const float* b = world + 4;
+    const float* c = world + 8;
+    float bc[3] = { b[1] * c[2] - b[2] * c[1], b[2] * c[0] - b[0] * c[2], b[0] * c[1] - b[1] * c[0] };
+    float ca[3] = { c[1] * a[2] - c[2] * a[1], c[2] * a[0] - c[0] * a[2], c[0] * a[1] - c[1] * a[0] };
+    float ab[3] = { a[1] * b[2] - a[2] * b[1], a[2] * b[0] - a[0] * b[2], a[0] * b[1] - a[1] * b[0] };
+    float determinant = a[0] * bc[0] + a[1] * bc[1] + a[2] * bc[2];
+    float inverse = determinant != 0.0f ? 1.0f / determinant : 0.0f;
+
+    glm::mat3& normal = normalMatrices[slotIndex];
+    for (int i = 0; i < 3; i++)
+    {
+        normal[0][i] = bc[i] * inverse;
+        normal[1][i] = ca[i] * inverse;
+        normal[2][i] = ab[i] * inverse;
+    }
+
+    slotVersions[slotIndex]++;
+}
+
+void TransformStore::update(float deltaTime)
+{
+    if (removedCount > 0)
+    {
+        compact();
+    }
+
+    if (orderDirty)
+    {
+        rebuildOrder();
+    }
+
+    refreshStaticMatrices();
+    integrate(deltaTime);
+    computeRotations(0, angle.size());
+
+    JobSystem& jobs = JobSystem::getInstance();
+    for (const EvaluationRange& range : ranges)
+    {
+        if (!range.parallel)
+        {
+            for (size_t i = range.begin; i < range.end; i++)
+            {
+                evaluateSlot(order[i]);
+            }
+            continue;
+        }
+
+        jobs.parallelFor(range.end - range.begin, EVALUATE_GRAIN_SIZE,
+            [this, &range](size_t begin, size_t end) {
+                for (size_t i = range.begin + begin; i < range.begin + end; i++)
+                {
+                    evaluateSlot(order[i]);
+                }
+            });
+    }
+}
+
+void TransformStore::setPosition(int record, const glm::vec3& position)
+{
+    posX[record] = position.x;
+    posY[record] = position.y;
+    posZ[record] = position.z;
+}
+
+void TransformStore::setAxis(int record, const glm::vec3& axis)
+{
+    axisX[record] = axis.x;
+    axisY[record] = axis.y;
+    axisZ[record] = axis.z;
+}
+
+void TransformStore::setVelocity(int record, const glm::vec3& velocity)
+{
+    velX[record] = velocity.x;
+    velY[record] = velocity.y;
+    velZ[record] = velocity.z;
+}
+
+glm::mat4 TransformStore::getRecordMatrix(int record) const
+{
+    float half = angle[record] * DEGREES_TO_HALF_RADIANS;
+    float sine = std::sin(half);
+    float q[4] = { axisX[record] * sine, axisY[record] * sine, axisZ[record] * sine, std::cos(half) };
+    float t[3] = { posX[record], posY[record], posZ[record] };
+
+    glm::mat4 result;
+    similarityToMatrix(q, t, scale[record], &result[0][0]);
+    return result;
+}
@@ -0,0 +1,125 @@
+#pragma once
+#include <vector>
+#include <glm/vec3.hpp>
+#include <glm/mat3x3.hpp>
+#include <glm/mat4x4.hpp>
+
+class DrawableObject;
+class ITransformComponent;
+
+// One element of a dynamic transform chain. Its matrix is
+// translate(position) * rotate(angle, axis) * scale(scale), with angle in
+// degrees. angularSpeed and velocity are integrated every update.
+struct TransformRecord
+{
+    glm::vec3 axis;
+    float angle;
+    float angularSpeed;
+    glm::vec3 position;
+    glm::vec3 velocity;
+    float scale;
+
+    TransformRecord();
+};
+
+// Structure-of-arrays storage for the transforms of moving objects. Each
+// object's dynamic component chain is compiled into contiguous records.
+// update() integrates all records, converts them to quaternions and writes
+// parent * chain * static into contiguous world and normal matrix arrays,
+// in batches (SSE when available, scalar otherwise). Bound components
+// forward their setters to the records, so the ITransformComponent API
+// keeps working.
+class TransformStore
+{
+public:
+    TransformStore();
+    ~TransformStore();
+
+    TransformStore(const TransformStore&) = delete;
+    TransformStore& operator=(const TransformStore&) = delete;
+
+    // Returns false, leaving the object on the component path, if any
+    // element of its dynamic chain cannot be expressed as a record.
+    bool add(DrawableObject* obj);
+    void remove(DrawableObject* obj);
+    // Removes the object owning the record, for components whose new state
+    // cannot be expressed as a record.
+    void release(int record);
+    void clear();
+
+    void update(float deltaTime);
+
+    const glm::mat4& getWorldMatrix(int slot) const { return worldMatrices[slot]; }
+    const glm::mat3& getNormalMatrix(int slot) const { return normalMatrices[slot]; }
+    // Incremented every time the slot's matrices are recomputed.
+    unsigned int getSlotVersion(int slot) const { return slotVersions[slot]; }
+
+    // Call when a bound object's parent changes.
+    void invalidateOrder() { orderDirty = true; }
+
+    float getAngle(int record) const { return angle[record]; }
+    void setAngle(int record, float value) { angle[record] = value; }
+    void setAxis(int record, const glm::vec3& axis);
+    void setAngularSpeed(int record, float speed) { angularSpeed[record] = speed; }
+    float getAngularSpeed(int record) const { return angularSpeed[record]; }
+
+    glm::vec3 getPosition(int record) const { return glm::vec3(posX[record], posY[record], posZ[record]); }
+    void setPosition(int record, const glm::vec3& position);
+    glm::vec3 getVelocity(int record) const { return glm::vec3(velX[record], velY[record], velZ[record]); }
+    void setVelocity(int record, const glm::vec3& velocity);
+    void setScale(int record, float value) { scale[record] = value; }
+
+    // Matrix of a single record, for components queried directly.
+    glm::mat4 getRecordMatrix(int record) const;
+
+    size_t getObjectCount() const { return slots.size() - removedCount; }
+    size_t getRecordCount() const { return angle.size(); }
+
+private:
+    // Record arrays
+    std::vector<float> axisX, axisY, axisZ;
+    std::vector<float> angle, angularSpeed;
+    std::vector<float> posX, posY, posZ;
+    std::vector<float> velX, velY, velZ;
+    std::vector<float> scale;
+    std::vector<float> quatX, quatY, quatZ, quatW;
+    std::vector<ITransformComponent*> owners;
+
+    struct Slot
+    {
+        DrawableObject* object;
+        int firstRecord;
+        int recordCount;
+        int parentSlot;
+        DrawableObject* parentObject;
+        glm::mat4 staticMatrix;
+        unsigned int staticVersion;
+    };
+
+    std::vector<Slot> slots;
+    std::vector<glm::mat4> worldMatrices;
+    std::vector<glm::mat3> normalMatrices;
+    std::vector<unsigned int> slotVersions;
+    std::vector<int> order;
+
+    // Consecutive runs of order[] that can be evaluated together. Slots of
+    // one depth are independent unless their parent lives outside the store,
+    // whose lazily cached matrix must be read from one thread.
+    struct EvaluationRange
+    {
+        size_t begin;
+        size_t end;
+        bool parallel;
+    };
+    std::vector<EvaluationRange> ranges;
+    bool orderDirty;
+    size_t removedCount;
+
+    void pushRecord(const TransformRecord& record, ITransformComponent* owner);
+    void integrate(float deltaTime);
+    void computeRotations(size_t first, size_t count);
+    void refreshStaticMatrices();
+    void evaluateSlot(int slot);
+    void rebuildOrder();
+    void compact();
+};
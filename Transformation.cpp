@@ -1,7 +1,7 @@
 #include "Transformation.h"
 
 Transformation::Transformation(bool isDynamic)
-    : useDynamic(isDynamic)
+    : useDynamic(isDynamic), version(0)
 {
     dynamicComponent = std::make_unique<DynamicTransformComponent>();
     staticComponent = std::make_unique<StaticTransformComponent>();
@@ -17,6 +17,7 @@ void Transformation::addDynamic(ITransformComponent* component)
     {
         dynamicComponent->add(component);
         useDynamic = true;
+        version++;
     }
 }
 
@@ -25,6 +26,7 @@ void Transformation::addStatic(ITransformComponent* component)
     if (component)
     {
         staticComponent->add(component);
+        version++;
     }
 }
 
@@ -38,6 +40,11 @@ glm::mat4 Transformation::getMatrix() const
 
 void Transformation::update(float deltaTime)
 {
+    if (!useDynamic)
+    {
+        return;
+    }
+
     dynamicComponent->update(deltaTime);
-    staticComponent->update(deltaTime);
+    version++;
 }
\ No newline at end of file
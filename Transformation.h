@@ -10,6 +10,7 @@ private:
     std::unique_ptr<DynamicTransformComponent> dynamicComponent;
     std::unique_ptr<StaticTransformComponent> staticComponent;
     bool useDynamic;
+    unsigned int version;
 
 public:
     Transformation(bool isDynamic = false);
@@ -21,6 +22,14 @@ public:
     glm::mat4 getMatrix() const;
     void update(float deltaTime);
 
-    void setDynamic(bool dynamic) { useDynamic = dynamic; }
+    glm::mat4 getStaticMatrix() const { return staticComponent->getMatrix(); }
+    unsigned int getStaticVersion() const { return staticComponent->getVersion(); }
+    const std::vector<std::unique_ptr<ITransformComponent>>& getDynamicComponents() const { return dynamicComponent->getComponents(); }
+
+    void setDynamic(bool dynamic) { useDynamic = dynamic; version++; }
     bool isDynamic() const { return useDynamic; }
+
+    // Changes whenever getMatrix() may return something new, including
+    // through setters of the components.
+    unsigned int getVersion() const { return version + dynamicComponent->getVersion() + staticComponent->getVersion(); }
 };
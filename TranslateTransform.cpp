@@ -1,8 +1,9 @@
 #include "TranslateTransform.h"
+#include "TransformStore.h"
 #include <glm/gtc/matrix_transform.hpp>
 
 TranslateTransform::TranslateTransform(const glm::vec3& pos)
-    : position(pos)
+    : position(pos), version(0), store(nullptr), record(-1)
 {
 }
 
@@ -15,7 +16,25 @@ glm::mat4 TranslateTransform::getMatrix() const
     return glm::translate(glm::mat4(1.0f), position);
 }
 
+bool TranslateTransform::toRecord(TransformRecord& out) const
+{
+    out.position = position;
+    return true;
+}
+
+void TranslateTransform::bindRecord(TransformStore* newStore, int newRecord)
+{
+    store = newStore;
+    record = newRecord;
+}
+
 void TranslateTransform::setPosition(const glm::vec3& pos)
 {
     position = pos;
+    version++;
+
+    if (store != nullptr)
+    {
+        store->setPosition(record, pos);
+    }
 }
\ No newline at end of file
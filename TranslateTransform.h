@@ -6,11 +6,18 @@ class TranslateTransform : public ITransformComponent
 {
 private:
     glm::vec3 position;
+    unsigned int version;
+
+    TransformStore* store;
+    int record;
 
 public:
     TranslateTransform(const glm::vec3& pos);
     ~TranslateTransform();
     glm::mat4 getMatrix() const override;
+    bool toRecord(TransformRecord& record) const override;
+    void bindRecord(TransformStore* store, int record) override;
+    unsigned int getVersion() const override { return version; }
     void setPosition(const glm::vec3& pos);
     glm::vec3 getPosition() const { return position; }
 };
\ No newline at end of file
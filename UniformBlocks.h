@@ -0,0 +1,83 @@
+#pragma once
+#include <GL/glew.h>
+#include <glm/vec3.hpp>
+#include <glm/mat4x4.hpp>
+
+// CPU mirrors of the std140 uniform blocks shared by all shader programs.
+// Field order and padding must match the block declarations in shaders/.
+// Point lights are not part of a block: they are read from a texture buffer
+// as three RGBA32F texels per LightData.
+
+enum UniformBlockBinding : GLuint
+{
+    LIGHT_BLOCK_BINDING = 0,
+    FRAME_BLOCK_BINDING = 1
+};
+
+// Texture units of the buffers holding the light lists. Unit 0 is the
+// object's texture.
+enum LightTextureUnit : GLuint
+{
+    LIGHT_DATA_TEXTURE_UNIT = 1,
+    LIGHT_CLUSTER_TEXTURE_UNIT = 2,
+    LIGHT_INDEX_TEXTURE_UNIT = 3,
+    OBJECT_LIGHT_INDEX_TEXTURE_UNIT = 4
+};
+
+// Light count of an instance that is shaded with the clustered lists
+// instead of a list of its own.
+static const GLuint CLUSTERED_LIGHTS = 0xFFFFFFFFu;
+
+struct FrameBlock
+{
+    glm::mat4 viewMatrix;
+    glm::mat4 projectionMatrix;
+    glm::mat4 viewProjectionMatrix;
+    glm::vec3 cameraPosition;
+    float time;
+};
+
+struct LightData
+{
+    glm::vec3 position;
+    float intensity;
+    glm::vec3 color;
+    float constant;
+    float linear;
+    float quadratic;
+    // Distance at which the light stops contributing; shaders fade it out
+    // towards it.
+    float radius;
+    float padding;
+};
+
+struct SpotLightData
+{
+    glm::vec3 position;
+    float intensity;
+    glm::vec3 direction;
+    float cutOff;
+    glm::vec3 color;
+    float outerCutOff;
+    float constant;
+    float linear;
+    float quadratic;
+    int enabled;
+};
+
+struct LightBlock
+{
+    SpotLightData spotlight;
+    // Froxel grid the point lights are binned into; a fragment at view
+    // depth d lies in slice log(d) * clusterDepthScale + clusterDepthBias.
+    glm::ivec3 clusterCount;
+    int numLights;
+    float clusterDepthScale;
+    float clusterDepthBias;
+    float padding[2];
+};
+
+static_assert(sizeof(FrameBlock) == 208, "FrameBlock must follow std140 layout");
+static_assert(sizeof(LightData) == 48, "LightData must follow std140 layout");
+static_assert(sizeof(SpotLightData) == 64, "SpotLightData must follow std140 layout");
+static_assert(sizeof(LightBlock) == 96, "LightBlock must follow std140 layout");
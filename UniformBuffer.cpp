@@ -0,0 +1,41 @@
+#include "UniformBuffer.h"
+#include <iostream>
+
+UniformBuffer::UniformBuffer(GLuint bindingPoint, GLsizeiptr size)
+    : bufferID(0)
+    , bindingPoint(bindingPoint)
+    , size(size)
+{
+    glGenBuffers(1, &bufferID);
+    glBindBuffer(GL_UNIFORM_BUFFER, bufferID);
+    glBufferData(GL_UNIFORM_BUFFER, size, nullptr, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+UniformBuffer::~UniformBuffer()
+{
+    if (bufferID != 0)
+    {
+        glDeleteBuffers(1, &bufferID);
+        bufferID = 0;
+    }
+}
+
+void UniformBuffer::update(const void* data, GLsizeiptr dataSize, GLintptr offset)
+{
+    if (offset + dataSize > size)
+    {
+        std::cerr << "ERROR: UniformBuffer::update() - write of " << dataSize
+            << " bytes at offset " << offset << " exceeds buffer size " << size << "\n";
+        return;
+    }
+
+    glBindBuffer(GL_UNIFORM_BUFFER, bufferID);
+    glBufferSubData(GL_UNIFORM_BUFFER, offset, dataSize, data);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+void UniformBuffer::bind() const
+{
+    glBindBufferBase(GL_UNIFORM_BUFFER, bindingPoint, bufferID);
+}
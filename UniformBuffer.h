@@ -0,0 +1,24 @@
+#pragma once
+#include <GL/glew.h>
+
+class UniformBuffer
+{
+private:
+    GLuint bufferID;
+    GLuint bindingPoint;
+    GLsizeiptr size;
+
+public:
+    UniformBuffer(GLuint bindingPoint, GLsizeiptr size);
+    ~UniformBuffer();
+
+    void update(const void* data, GLsizeiptr dataSize, GLintptr offset = 0);
+    void bind() const;
+
+    GLuint getID() const { return bufferID; }
+    GLuint getBindingPoint() const { return bindingPoint; }
+    GLsizeiptr getSize() const { return size; }
+
+    UniformBuffer(const UniformBuffer&) = delete;
+    UniformBuffer& operator=(const UniformBuffer&) = delete;
+};
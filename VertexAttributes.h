@@ -0,0 +1,16 @@
+#pragma once
+#include <GL/glew.h>
+
+// Attribute locations bound into every shader program before linking, so a
+// single VAO per mesh works with all programs.
+enum VertexAttribute : GLuint
+{
+    ATTRIB_POSITION = 0,
+    ATTRIB_NORMAL = 1,
+    ATTRIB_TEXCOORD = 2,
+    ATTRIB_INSTANCE_MODEL = 3,      // mat4, occupies 3..6
+    ATTRIB_INSTANCE_NORMAL = 7,     // mat3, occupies 7..9
+    ATTRIB_INSTANCE_COLOR = 10,
+    ATTRIB_INSTANCE_SHININESS = 11,
+    ATTRIB_INSTANCE_LIGHTS = 12     // uvec3
+};
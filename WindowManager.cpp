@@ -133,8 +133,8 @@ void WindowManager::windowSizeCallback(GLFWwindow* window, int width, int height
     WindowManager* wm = s_instance;
     if (!wm || !wm->app) return;
 
-    glViewport(0, 0, width, height);
     wm->updateSize(width, height);
+    wm->app->getRenderer().setViewport(width, height);
 
     Scene* currentScene = wm->app->getSceneManager().getCurrentScene();
     if (currentScene)
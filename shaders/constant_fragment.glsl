@@ -1,17 +1,18 @@
 #version 330 core
 
+#include "include/features.glsl"
+
 in vec2 uv;
 
-uniform vec3 objectColor;
+flat in vec3 objectColor;
 uniform sampler2D textureUnitID;
-uniform int useTexture;
 
 out vec4 out_Color;
 
 void main() {
-    if (useTexture == 1) {
+    if (USE_TEXTURE) {
         out_Color = texture(textureUnitID, uv);
     } else {
         out_Color = vec4(objectColor, 1.0);
     }
-}
\ No newline at end of file
+}
@@ -1,15 +1,18 @@
 #version 330 core
 
+#include "include/frame_block.glsl"
+
 in vec3 vp;
 in vec2 vt;
 
-uniform mat4 modelMatrix;
-uniform mat4 viewMatrix;
-uniform mat4 projectionMatrix;
+in mat4 instanceModelMatrix;
+in vec3 instanceColor;
 
 out vec2 uv;
+flat out vec3 objectColor;
 
 void main() {
     uv = vt;
-    gl_Position = projectionMatrix * viewMatrix * modelMatrix * vec4(vp, 1.0);
-}
\ No newline at end of file
+    objectColor = instanceColor;
+    gl_Position = viewProjectionMatrix * instanceModelMatrix * vec4(vp, 1.0);
+}
@@ -0,0 +1,21 @@
+// Variants are compiled with VARIANT defined and the features they are for
+// (TEXTURED, SPOTLIGHT), so these tests are constants and the code behind
+// them compiles away. The generic program of a shader, drawn while a
+// variant is compiling, has no VARIANT and tests them per draw instead.
+#ifdef VARIANT
+    #ifdef TEXTURED
+        #define USE_TEXTURE true
+    #else
+        #define USE_TEXTURE false
+    #endif
+    #ifdef SPOTLIGHT
+        #define USE_SPOTLIGHT true
+    #else
+        #define USE_SPOTLIGHT false
+    #endif
+#else
+    uniform int useTexture;
+    #define USE_TEXTURE (useTexture == 1)
+    // Only for shaders declaring the LightBlock and objectLights.
+    #define USE_SPOTLIGHT (spotlight.enabled == 1 && objectLights.z == 1u)
+#endif
@@ -0,0 +1,7 @@
+layout(std140) uniform FrameBlock {
+    mat4 viewMatrix;
+    mat4 projectionMatrix;
+    mat4 viewProjectionMatrix;
+    vec3 cameraPosition;
+    float time;
+};
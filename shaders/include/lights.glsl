@@ -0,0 +1,72 @@
+#include "frame_block.glsl"
+
+// Light count of objects shaded with the clustered lists.
+#define CLUSTERED_LIGHTS 0xFFFFFFFFu
+
+struct Light {
+    vec3 position;
+    float intensity;
+    vec3 color;
+    float constant;
+    float linear;
+    float quadratic;
+    float radius;
+};
+
+struct SpotLight {
+    vec3 position;
+    float intensity;
+    vec3 direction;
+    float cutOff;
+    vec3 color;
+    float outerCutOff;
+    
+    float constant;
+    float linear;
+    float quadratic;
+    
+    int enabled;
+};
+
+layout(std140) uniform LightBlock {
+    SpotLight spotlight;
+    ivec3 clusterCount;
+    int numLights;
+    float clusterDepthScale;
+    float clusterDepthBias;
+};
+
+// Three texels per light, then the first index and count of every
+// cluster's lights, then the light indices themselves, then the lights of
+// objects with a list of their own.
+uniform samplerBuffer lightTexels;
+uniform usamplerBuffer lightClusterTexels;
+uniform usamplerBuffer lightIndexTexels;
+uniform usamplerBuffer objectLightIndexTexels;
+
+Light fetchLight(uint index) {
+    int texel = int(index) * 3;
+    vec4 positionIntensity = texelFetch(lightTexels, texel);
+    vec4 colorConstant = texelFetch(lightTexels, texel + 1);
+    vec4 attenuation = texelFetch(lightTexels, texel + 2);
+    return Light(positionIntensity.xyz, positionIntensity.w, colorConstant.rgb, colorConstant.a,
+                 attenuation.x, attenuation.y, attenuation.z);
+}
+
+// Range of lightIndexTexels holding the lights that reach this fragment.
+uvec2 fetchCluster(vec3 position) {
+    vec4 clip = viewProjectionMatrix * vec4(position, 1.0);
+    vec2 ndc = clip.xy / clip.w;
+    ivec2 tile = clamp(ivec2((ndc * 0.5 + 0.5) * vec2(clusterCount.xy)), ivec2(0), clusterCount.xy - 1);
+    // clip.w is the view depth.
+    int slice = clamp(int(floor(log(clip.w) * clusterDepthScale + clusterDepthBias)), 0, clusterCount.z - 1);
+    return texelFetch(lightClusterTexels, tile.x + clusterCount.x * (tile.y + clusterCount.y * slice)).xy;
+}
+
+// Fades lights out towards their radius, so cutting them off there is invisible.
+float getRadiusFalloff(float distance, float radius) {
+    float ratio = distance / radius;
+    ratio *= ratio;
+    float falloff = clamp(1.0 - ratio * ratio, 0.0, 1.0);
+    return falloff * falloff;
+}
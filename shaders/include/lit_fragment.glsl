@@ -0,0 +1,112 @@
+// Fragment shader of the lit models. The including file picks the model
+// by defining LIGHTING_LAMBERT, LIGHTING_PHONG or LIGHTING_BLINN.
+#include "lights.glsl"
+#include "features.glsl"
+
+in vec4 worldPosition;
+in vec3 worldNormal;
+in vec2 TexCoord;
+
+flat in vec3 objectColor;
+// First index and count in objectLightIndexTexels, and whether the
+// spotlight's cone reaches the object.
+flat in uvec3 objectLights;
+flat in float shininess;
+
+uniform sampler2D textureUnitID;
+
+out vec4 out_Color;
+
+vec3 normal;
+vec3 viewDir;
+vec3 baseColor;
+vec3 totalDiffuse = vec3(0.0);
+vec3 totalSpecular = vec3(0.0);
+
+// radiance is the light's color scaled by its intensity and attenuation.
+void addLight(vec3 lightDir, vec3 radiance) {
+    float diff = max(dot(normal, lightDir), 0.0);
+    totalDiffuse += diff * radiance * baseColor;
+
+#if defined(LIGHTING_PHONG)
+    vec3 reflectDir = reflect(-lightDir, normal);
+    float spec = pow(max(dot(viewDir, reflectDir), 0.0), shininess);
+    totalSpecular += spec * radiance;
+#elif defined(LIGHTING_BLINN)
+    vec3 halfwayDir = normalize(lightDir + viewDir);
+    float spec = pow(max(dot(normal, halfwayDir), 0.0), shininess);
+    totalSpecular += spec * radiance;
+#endif
+}
+
+void addPointLight(uint index) {
+    Light light = fetchLight(index);
+    
+    vec3 lightDir = normalize(light.position - worldPosition.xyz);
+    float distance = length(light.position - worldPosition.xyz);
+    
+    float attenuation = getRadiusFalloff(distance, light.radius) / (light.constant + 
+                               light.linear * distance + 
+                               light.quadratic * distance * distance);
+    
+    addLight(lightDir, attenuation * light.color * light.intensity);
+}
+
+void addSpotLight() {
+    vec3 lightDir = normalize(spotlight.position - worldPosition.xyz);
+    float distance = length(spotlight.position - worldPosition.xyz);
+    
+    float theta = dot(lightDir, normalize(-spotlight.direction));
+    
+    if(theta > spotlight.outerCutOff) {
+        float epsilon = spotlight.cutOff - spotlight.outerCutOff;
+        float intensity = clamp((theta - spotlight.outerCutOff) / epsilon, 0.0, 1.0);
+        
+        float attenuation = 1.0 / (spotlight.constant + 
+                                   spotlight.linear * distance + 
+                                   spotlight.quadratic * distance * distance);
+        
+        addLight(lightDir, attenuation * intensity * spotlight.color * spotlight.intensity);
+    }
+}
+
+void main() {
+    normal = normalize(worldNormal);
+    viewDir = normalize(cameraPosition - worldPosition.xyz);
+    
+    if (USE_TEXTURE) {
+        baseColor = texture(textureUnitID, TexCoord).rgb;
+    } else {
+        baseColor = objectColor;
+    }
+    
+#if defined(VARIANT) && defined(CLUSTERED_LIGHT_LISTS)
+    uvec2 range = fetchCluster(worldPosition.xyz);
+    for(uint i = 0u; i < range.y; i++) {
+        addPointLight(texelFetch(lightIndexTexels, int(range.x + i)).x);
+    }
+#elif defined(VARIANT)
+    // A constant bound lets short lists unroll; with LIGHT_LIST_SIZE 0 the
+    // loop is gone altogether.
+    for(uint i = 0u; i < uint(LIGHT_LIST_SIZE); i++) {
+        if (i == objectLights.y) {
+            break;
+        }
+        addPointLight(texelFetch(objectLightIndexTexels, int(objectLights.x + i)).x);
+    }
+#else
+    bool clustered = objectLights.y == CLUSTERED_LIGHTS;
+    uvec2 range = clustered ? fetchCluster(worldPosition.xyz) : objectLights.xy;
+    for(uint i = 0u; i < range.y; i++) {
+        int texel = int(range.x + i);
+        addPointLight(clustered ? texelFetch(lightIndexTexels, texel).x : texelFetch(objectLightIndexTexels, texel).x);
+    }
+#endif
+    
+    if (USE_SPOTLIGHT) {
+        addSpotLight();
+    }
+    
+    vec3 ambient = 0.1 * baseColor;
+    out_Color = vec4(ambient + totalDiffuse + totalSpecular, 1.0);
+}
@@ -0,0 +1,29 @@
+#include "frame_block.glsl"
+
+in vec3 vp;
+in vec3 vn;
+in vec2 vt;
+
+in mat4 instanceModelMatrix;
+in mat3 instanceNormalMatrix;
+in vec3 instanceColor;
+in float instanceShininess;
+in uvec3 instanceLights;
+
+out vec4 worldPosition;
+out vec3 worldNormal;
+out vec2 TexCoord;
+flat out vec3 objectColor;
+flat out float shininess;
+flat out uvec3 objectLights;
+
+void main() {
+    worldPosition = instanceModelMatrix * vec4(vp, 1.0);
+    worldNormal = normalize(instanceNormalMatrix * vn);
+    TexCoord = vt;
+    objectColor = instanceColor;
+    shininess = instanceShininess;
+    objectLights = instanceLights;
+    
+    gl_Position = viewProjectionMatrix * worldPosition;
+}
@@ -0,0 +1,109 @@
+// Offline converter from the text mesh sources (.h arrays, .txt, .obj) to
+// cooked .mesh files. ModelCache maps the cooked file instead of parsing the
+// source whenever it finds one next to it.
+//
+// Build together with ModelLoader.cpp, FloatParser.cpp, ModelCache.cpp, MeshOptimizer.cpp,
+// MeshFile.cpp, MappedFile.cpp and tiny_obj_loader.cc.
+//
+// Usage: MeshConverter <source> [arrayName] [output]
+//   arrayName is required for .h sources and defaults to the file name.
+//   output defaults to MeshFile::getCookedPath(source, arrayName).
+
+#include "../ModelLoader.h"
+#include "../ModelCache.h"
+#include "../MeshFile.h"
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace
+{
+    std::string getExtension(const std::string& path)
+    {
+        size_t dot = path.find_last_of('.');
+        size_t slash = path.find_last_of("/\\");
+        if (dot == std::string::npos || (slash != std::string::npos && dot < slash))
+        {
+            return "";
+        }
+        return path.substr(dot);
+    }
+
+    std::string getStem(const std::string& path)
+    {
+        size_t slash = path.find_last_of("/\\");
+        std::string name = slash == std::string::npos ? path : path.substr(slash + 1);
+        return name.substr(0, name.find_last_of('.'));
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        std::cerr << "Usage: MeshConverter <source.h|source.txt|source.obj> [arrayName] [output]" << std::endl;
+        return 1;
+    }
+
+    const std::string sourcePath = argv[1];
+    const std::string extension = getExtension(sourcePath);
+
+    ModelLoader loader;
+    std::vector<float> vertices;
+    std::string arrayName;
+    unsigned int stride = 0;
+
+    auto start = std::chrono::steady_clock::now();
+
+    if (extension == ".h")
+    {
+        arrayName = argc >= 3 ? argv[2] : getStem(sourcePath);
+        vertices = loader.loadFromHeader(sourcePath, arrayName);
+        stride = 6;
+    }
+    else if (extension == ".txt")
+    {
+        vertices = loader.loadFromText(sourcePath);
+        stride = 8;
+    }
+    else if (extension == ".obj")
+    {
+        vertices = loader.loadFromOBJ(sourcePath);
+        stride = 8;
+    }
+    else
+    {
+        std::cerr << "ERROR: Unsupported source format: " << sourcePath << std::endl;
+        return 1;
+    }
+
+    if (vertices.size() < static_cast<size_t>(stride) * 3)
+    {
+        std::cerr << "ERROR: No triangles loaded from " << sourcePath << std::endl;
+        return 1;
+    }
+
+    double parseTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    std::string outputPath = argc >= 4 ? argv[3] : MeshFile::getCookedPath(sourcePath, arrayName);
+
+    std::shared_ptr<ModelData> modelData = ModelCache::createModelData(sourcePath, vertices, stride);
+    if (!MeshFile::write(outputPath, *modelData))
+    {
+        return 1;
+    }
+
+    std::cout << sourcePath << " -> " << outputPath << ": " << modelData->vertexCount << " vertices, "
+        << modelData->getIndexCount() << " indices, " << modelData->getBytes() / 1024 << " KB"
+        << " (source parsed in " << parseTime << " ms)" << std::endl;
+
+    // Read it back to catch anything the loader would reject.
+    if (!MeshFile::load(outputPath, stride))
+    {
+        std::cerr << "ERROR: Written file does not load: " << outputPath << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,158 @@
+// Offline converter from images (.png, .jpg, anything stb_image reads) to
+// cooked .tex files holding the full mip chain, optionally BC1/BC3
+// compressed. TextureCache maps the cooked file instead of decoding the
+// source whenever it finds one next to it.
+//
+// Build together with Texture .cpp, TextureFile.cpp, TextureCompressor.cpp,
+// MappedFile.cpp and JobSystem.cpp, linked against GLEW and OpenGL (the
+// converter itself makes no GL calls).
+//
+// Usage: TextureConverter <source> [auto|bc1|bc3|none] [output]
+//   auto (default) picks BC1 for opaque images and BC3 otherwise; none
+//   keeps the source channels uncompressed.
+//   output defaults to TextureFile::getCookedPath(source).
+
+#include "../Texture.h"
+#include "../TextureFile.h"
+#include "../TextureCompressor.h"
+#include "../JobSystem.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace
+{
+    const char* getFormatName(TextureFormat format)
+    {
+        switch (format)
+        {
+        case TEXTURE_BC1:
+            return "BC1";
+        case TEXTURE_BC3:
+            return "BC3";
+        default:
+            return "uncompressed";
+        }
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        std::cerr << "Usage: TextureConverter <source> [auto|bc1|bc3|none] [output]" << std::endl;
+        return 1;
+    }
+
+    const std::string sourcePath = argv[1];
+    const std::string mode = argc >= 3 ? argv[2] : "auto";
+
+    auto start = std::chrono::steady_clock::now();
+
+    std::unique_ptr<TextureImage> source = Texture::decode(sourcePath);
+    if (!source)
+    {
+        return 1;
+    }
+
+    double decodeTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    TextureFormat format;
+    if (mode == "auto")
+    {
+        format = TextureCompressor::hasAlpha(source->pixels.get(), source->width, source->height, source->channels)
+            ? TEXTURE_BC3
+            : TEXTURE_BC1;
+    }
+    else if (mode == "bc1")
+    {
+        format = TEXTURE_BC1;
+    }
+    else if (mode == "bc3")
+    {
+        format = TEXTURE_BC3;
+    }
+    else if (mode == "none")
+    {
+        format = TEXTURE_UNCOMPRESSED;
+    }
+    else
+    {
+        std::cerr << "ERROR: Unknown format: " << mode << std::endl;
+        return 1;
+    }
+
+    start = std::chrono::steady_clock::now();
+
+    // Uncompressed levels of the chain, largest first.
+    std::vector<std::vector<unsigned char>> chain;
+    chain.emplace_back(source->pixels.get(), source->pixels.get() + source->levels[0].size);
+
+    std::vector<std::pair<int, int>> sizes;
+    sizes.emplace_back(source->width, source->height);
+
+    while (sizes.back().first > 1 || sizes.back().second > 1)
+    {
+        int width = sizes.back().first;
+        int height = sizes.back().second;
+        chain.push_back(TextureCompressor::downsample(chain.back().data(), width, height, source->channels));
+        sizes.emplace_back(std::max(width / 2, 1), std::max(height / 2, 1));
+    }
+
+    std::vector<std::vector<unsigned char>> encoded;
+    if (format != TEXTURE_UNCOMPRESSED)
+    {
+        for (size_t i = 0; i < chain.size(); i++)
+        {
+            encoded.push_back(TextureCompressor::compress(chain[i].data(), sizes[i].first, sizes[i].second,
+                source->channels, format));
+        }
+    }
+    const std::vector<std::vector<unsigned char>>& levels = format != TEXTURE_UNCOMPRESSED ? encoded : chain;
+
+    double cookTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    TextureImage cooked;
+    cooked.path = sourcePath;
+    cooked.width = source->width;
+    cooked.height = source->height;
+    cooked.channels = source->channels;
+    cooked.format = format;
+
+    for (size_t i = 0; i < levels.size(); i++)
+    {
+        TextureLevel level;
+        level.width = sizes[i].first;
+        level.height = sizes[i].second;
+        level.data = levels[i].data();
+        level.size = levels[i].size();
+        cooked.levels.push_back(level);
+    }
+
+    std::string outputPath = argc >= 4 ? argv[3] : TextureFile::getCookedPath(sourcePath);
+    if (!TextureFile::write(outputPath, cooked))
+    {
+        return 1;
+    }
+
+    // What loading the source used to put on the GPU: RGBA8 plus mips.
+    size_t sourceBytes = static_cast<size_t>(source->width) * source->height * 4 * 4 / 3;
+
+    std::cout << sourcePath << " -> " << outputPath << ": " << source->width << "x" << source->height
+        << ", " << source->channels << " channels, " << cooked.levels.size() << " levels, "
+        << getFormatName(format) << ", " << sourceBytes / 1024 << " KB -> " << cooked.getBytes() / 1024 << " KB"
+        << " (decoded in " << decodeTime << " ms, cooked in " << cookTime << " ms on "
+        << JobSystem::getInstance().getThreadCount() << " threads)" << std::endl;
+
+    // Read it back to catch anything the loader would reject.
+    if (!TextureFile::load(outputPath))
+    {
+        std::cerr << "ERROR: Written file does not load: " << outputPath << std::endl;
+        return 1;
+    }
+
+    JobSystem::destroy();
+    return 0;
+}